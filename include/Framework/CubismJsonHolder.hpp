@@ -48,10 +48,11 @@ namespace Live2D { namespace Cubism { namespace Framework {
          *
          * @param buffer Buffer into which JSON is loaded
          * @param size Number of bytes in buffer
+         * @param useArena Parse into a single arena whose strings point into buffer; buffer must then outlive the holder
          */
-        void CreateCubismJson(const csmByte* buffer, csmSizeInt size)
+        void CreateCubismJson(const csmByte* buffer, csmSizeInt size, csmBool useArena = false)
         {
-            _json = Utils::CubismJson::Create(buffer, size);
+            _json = Utils::CubismJson::Create(buffer, size, useArena);
 
             if (!IsValid())
             {
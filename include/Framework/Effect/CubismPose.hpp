@@ -89,6 +89,27 @@ public:
      */
     static void         Delete(CubismPose* pose);
 
+    /**
+     * @brief スナップショットの判定
+     *
+     * バッファがWriteBinaryで書き出したスナップショットのシグネチャで始まっているかを判定する。
+     *
+     * @param[in]   buffer  判定するバッファ
+     * @param[in]   size    バッファのサイズ
+     * @return  true    スナップショット
+     * @return  false   それ以外
+     */
+    static csmBool      IsBinary(const csmByte* buffer, csmSizeInt size);
+
+    /**
+     * @brief スナップショットの書き出し
+     *
+     * パーツグループの設定をバイナリ形式で書き出す。Createに渡せばpose3.jsonの代わりに読み込める。
+     *
+     * @param[out]  buffer  書き出し先。既存の内容は破棄される
+     */
+    void                WriteBinary(csmVector<csmByte>& buffer) const;
+
     /**
      * @brief モデルのパラメータの更新
      *
@@ -125,6 +146,18 @@ private:
     */
     virtual ~CubismPose();
 
+    /**
+     * @brief スナップショットの読み込み
+     *
+     * WriteBinaryで書き出したスナップショットをパーツグループに展開する。
+     *
+     * @param[in]   poseBinary  スナップショットが読み込まれているバッファ
+     * @param[in]   size        バッファのサイズ
+     * @retval  true    展開できた
+     * @retval  false   不正なデータだった
+     */
+    csmBool             ParseBinary(const csmByte* poseBinary, csmSizeInt size);
+
     /**
      * @brief パーツの不透明度をコピー
      *
@@ -29,6 +29,14 @@ struct CubismId
      */
     const csmString& GetString() const;
 
+    /**
+     * @brief IDの通し番号を取得
+     *
+     * CubismIdManagerに登録された順に0から振られる番号を取得する。<br>
+     * IDごとの値を配列で引くときの添字に使える。
+     */
+    csmInt32 GetIndex() const;
+
     CubismId& operator=(const CubismId& c);
 
     csmBool operator==(const CubismId& c) const;
@@ -48,8 +56,9 @@ private:
      * コンストラクタ。
      *
      * @param[in] id ID名
+     * @param[in] index IDの通し番号
      */
-    CubismId(const csmChar* id);
+    CubismId(const csmChar* id, csmInt32 index);
 
     /**
      * @brief デストラクタ
@@ -61,6 +70,7 @@ private:
     CubismId(const CubismId& c);
 
     csmString _id;      ///< ID名
+    csmInt32 _index;    ///< IDの通し番号
 };
 
 typedef const CubismId* CubismIdHandle;
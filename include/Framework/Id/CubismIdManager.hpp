@@ -10,6 +10,8 @@
 #include "Framework/Type/CubismBasicType.hpp"
 #include "Framework/Type/csmString.hpp"
 #include "Framework/Type/csmVector.hpp"
+#include <atomic>
+#include <mutex>
 
 namespace Live2D { namespace Cubism { namespace Framework {
 
@@ -18,7 +20,9 @@ struct CubismId;
 /**
  * @brief ID名の管理
  *
- * ID名を管理する。
+ * ID名を管理する。<br>
+ * 登録済みのIDはハッシュテーブルからロックを取らずに検索でき、<br>
+ * 新規登録の時だけロックを取る。
  */
 class CubismIdManager
 {
@@ -122,17 +126,58 @@ private:
     CubismIdManager(const CubismIdManager&);
     CubismIdManager& operator=(const CubismIdManager&);
 
+    /**
+     * @brief IDのハッシュテーブル
+     *
+     * 要素は登録順にスロットへ書き込まれ、削除されることはない。<br>
+     * 拡張時は新しいテーブルを作って差し替え、古いテーブルは読み手が残っている可能性があるため<br>
+     * マネージャの破棄まで保持する。
+     */
+    struct IdTable
+    {
+        struct Slot
+        {
+            std::atomic<CubismId*> Id;  ///< 登録されたID。空きスロットはNULL
+            csmUint32 Hash;             ///< IDのハッシュ値。Idを公開する前に書き込む
+        };
+
+        csmUint32 Mask;                 ///< スロット数 - 1
+        Slot* Slots;                    ///< スロットの配列
+        IdTable* Previous;              ///< 拡張前のテーブル
+    };
+
     /**
      * @brief ID名からIDを検索
      *
-     * ID名からIDを検索する。
+     * ID名からIDを検索する。ロックは取らない。
      *
-     * @param[in]   id  ID名
+     * @param[in]   id      ID名
+     * @param[in]   hash    ID名のハッシュ値
      * @return  登録されているID。なければNULL。
      */
-    CubismId* FindId(const csmChar* id) const;
+    CubismId* FindId(const csmChar* id, csmUint32 hash) const;
+
+    /**
+     * @brief テーブルにIDを追加する
+     *
+     * ロックを取った状態で呼ぶ。必要ならテーブルを拡張する。
+     *
+     * @param[in]   id      追加するID
+     * @param[in]   hash    ID名のハッシュ値
+     */
+    void InsertId(CubismId* id, csmUint32 hash);
+
+    /**
+     * @brief ハッシュテーブルの作成
+     *
+     * @param[in]   slotCount   スロット数(2の累乗)
+     * @return  作成したテーブル
+     */
+    static IdTable* CreateTable(csmUint32 slotCount);
 
     csmVector<CubismId*> _ids;      ///< 登録されているIDのリスト
+    std::atomic<IdTable*> _table;   ///< ID名で検索するためのハッシュテーブル
+    mutable std::mutex _mutex;      ///< ワーカースレッドからのID登録を直列化するロック
 };
 
 }}}
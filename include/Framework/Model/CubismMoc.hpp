@@ -22,6 +22,16 @@ class CubismMoc
 {
     friend class CubismModel;
 public:
+    /**
+     * @brief Mocデータのバッファ解放用コールバック関数定義
+     *
+     * 呼び出し側が用意したバッファをMocが手放すときに呼ばれる。
+     *
+     * @param[in]   mocBytes    Mocファイルのバッファ
+     * @param[in]   context     Create時に渡された任意のデータ
+     */
+    typedef void (*MocBufferReleaser)(void* mocBytes, void* context);
+
     /**
      * @brief バッファからMocデータの作成
      *
@@ -33,6 +43,21 @@ public:
      */
     static CubismMoc* Create(const csmByte* mocBytes, csmSizeInt size, csmBool shouldCheckMocConsistency = false);
 
+    /**
+     * @brief バッファからコピーせずにMocデータの作成
+     *
+     * 書き込み可能なバッファ上でMocファイルを直接復元し、Mocデータを作成する。
+     * バッファの所有権はMocデータに移り、Mocデータの削除時または作成失敗時に releaser で解放される。
+     * バッファが csmAlignofMoc に整列していない場合はコピーして作成し、その場で releaser を呼ぶ。
+     *
+     * @param[in]   mocBytes    Mocファイルのバッファ(書き込み可能であること)
+     * @param[in]   size        バッファのサイズ
+     * @param[in]   releaser    バッファ解放用のコールバック関数
+     * @param[in]   context     releaser に渡す任意のデータ
+     * @param[in]   shouldCheckMocConsistency MOCの整合性チェックフラグ(初期値 : false)
+     */
+    static CubismMoc* Create(csmByte* mocBytes, csmSizeInt size, MocBufferReleaser releaser, void* context, csmBool shouldCheckMocConsistency = false);
+
     /**
      * @brief Mocデータを削除
      *
@@ -114,6 +139,8 @@ private:
     Core::csmMoc*     _moc;             ///< Mocデータ
     csmInt32          _modelCount;      ///< Mocデータから作られたモデルの個数
     csmUint32         _mocVersion;      ///< 読み込んだモデルの.moc3 Version
+    MocBufferReleaser _releaser;        ///< 呼び出し側が用意したバッファの解放関数(NULLなら自前で確保したバッファ)
+    void*             _releaserContext; ///< 解放関数に渡す任意のデータ
 };
 
 }}}
@@ -9,6 +9,7 @@
 
 #include "Framework/CubismFramework.hpp"
 #include "Framework/Type/csmMap.hpp"
+#include "Framework/Type/csmHashMap.hpp"
 #include "Framework/Type/csmVector.hpp"
 #include "Framework/Rendering/CubismRenderer.hpp"
 #include "Framework/Id/CubismId.hpp"
@@ -895,6 +896,16 @@ public:
 
     Core::csmModel*     GetModel() const;
 
+    /**
+     * @brief モデルの通し番号を取得する
+     *
+     * 作成されたモデルごとに異なる番号を返す。<br>
+     * 破棄されたモデルと同じアドレスに作られたモデルとを区別するのに使う。
+     *
+     * @return モデルの通し番号
+     */
+    csmUint32 GetInstanceNo() const;
+
 private:
     /**
      * @brief コンストラクタ
@@ -941,11 +952,11 @@ private:
         csmVector<CubismModel::PartColorData>& partColors,
         csmVector <CubismModel::DrawableColorData>& drawableColors);
 
-    csmMap<csmInt32, csmFloat32>        _notExistPartOpacities;             ///< 存在していないパーツの不透明度のリスト
-    csmMap<CubismIdHandle, csmInt32>   _notExistPartId;                    ///< 存在していないパーツIDのリスト
+    csmHashMap<csmInt32, csmFloat32>    _notExistPartOpacities;             ///< 存在していないパーツの不透明度のリスト
+    csmHashMap<CubismIdHandle, csmInt32> _notExistPartId;                   ///< 存在していないパーツIDのリスト
 
-    csmMap<csmInt32, csmFloat32>        _notExistParameterValues;           ///< 存在していないパラメータの値のリスト
-    csmMap<CubismIdHandle, csmInt32>   _notExistParameterId;               ///< 存在していないパラメータIDのリスト
+    csmHashMap<csmInt32, csmFloat32>    _notExistParameterValues;           ///< 存在していないパラメータの値のリスト
+    csmHashMap<CubismIdHandle, csmInt32> _notExistParameterId;              ///< 存在していないパラメータIDのリスト
 
     csmVector<csmFloat32>   _savedParameters;                   ///< 保存されたパラメータ
 
@@ -958,9 +969,12 @@ private:
     csmFloat32*         _partOpacities;                         ///< パーツの不透明度のリスト
 
     csmFloat32 _modelOpacity;                         ///< モデルの不透明度
+    csmUint32 _instanceNo;                            ///< モデルの通し番号
 
     csmVector<CubismIdHandle> _parameterIds;
     csmVector<CubismIdHandle> _partIds;
+    csmVector<csmInt32> _parameterIndexTable;   ///< IDの通し番号からパラメータのインデックスを引くテーブル。未登録は-1
+    csmVector<csmInt32> _partIndexTable;        ///< IDの通し番号からパーツのインデックスを引くテーブル。未登録は-1
     csmVector<CubismIdHandle> _drawableIds;
     csmVector<DrawableColorData> _userScreenColors; ///< Drawable 乗算色の配列
     csmVector<DrawableColorData> _userMultiplyColors; ///< Drawable スクリーン色の配列
@@ -142,6 +142,20 @@ public:
      */
     virtual void            LoadModel(const csmByte* buffer, csmSizeInt size, csmBool shouldCheckMocConsistency = false);
 
+    /**
+     * @brief モデルデータをコピーせずに読み込み
+     *
+     * 書き込み可能なバッファ上でmoc3ファイルを直接復元してモデルデータを読み込む。
+     * バッファは読み込み後にMocデータが所有し、不要になった時点で releaser により解放される。
+     *
+     * @param[in]   buffer      moc3ファイルが読み込まれている書き込み可能なバッファ
+     * @param[in]   size        バッファのサイズ
+     * @param[in]   releaser    バッファ解放用のコールバック関数
+     * @param[in]   context     releaser に渡す任意のデータ
+     * @param[in]   shouldCheckMocConsistency MOCの整合性チェックフラグ(初期値 : false)
+     */
+    virtual void            LoadModel(csmByte* buffer, csmSizeInt size, CubismMoc::MocBufferReleaser releaser, void* context, csmBool shouldCheckMocConsistency = false);
+
     /**
      * @brief モーションデータの読み込み
      *
@@ -266,6 +280,14 @@ public:
     */
     static void   CubismDefaultMotionEventCallback(const CubismMotionQueueManager* caller, const csmString& eventValue, void* customData);
 protected:
+    /**
+     * @brief 作成済みのMocデータからモデルを生成
+     *
+     * _moc に設定されたMocデータからモデルとモデル行列を生成する。
+     * 他のインスタンスと共有するMocデータを設定した場合に直接呼び出すことができる。
+     */
+    void SetupModelFromMoc();
+
     CubismMoc*              _moc;                       ///< Mocデータ
     CubismModel*            _model;                     ///< Modelインスタンス
 
@@ -295,7 +295,7 @@ protected:
     csmFloat32    _weight;               ///< モーションの重み
     csmFloat32    _offsetSeconds;        ///< モーション再生の開始時刻[秒]
 
-    csmVector<const csmString*>    _firedEventValues;
+    csmSmallVector<const csmString*, 8>    _firedEventValues;   ///< 発火したイベント。毎フレーム作り直すので内部バッファに収める
 
     FinishedMotionCallback _onFinishedMotion; ///< モーション再生終了コールバック関数ポインタ
     void* _onFinishedMotionCustomData;        ///< モーション再生終了コールバックに戻されるデータ
@@ -52,10 +52,31 @@ public:
      *
      * @param[in]   buf     expファイルが読み込まれているバッファ
      * @param[in]   size    バッファのサイズ
-     * @return  作成されたインスタンス
+     * @return  作成されたインスタンス。スナップショットが壊れているか、バージョンが古くて読み込めなければNULL。
      */
     static CubismExpressionMotion* Create(const csmByte* buf, csmSizeInt size);
 
+    /**
+     * @brief スナップショットの判定
+     *
+     * バッファがWriteBinaryで書き出したスナップショットのシグネチャで始まっているかを判定する。
+     *
+     * @param[in]   buffer  判定するバッファ
+     * @param[in]   size    バッファのサイズ
+     * @return  true    スナップショット
+     * @return  false   それ以外
+     */
+    static csmBool IsBinary(const csmByte* buffer, csmSizeInt size);
+
+    /**
+     * @brief スナップショットの書き出し
+     *
+     * パース済みの表情パラメータをバイナリ形式で書き出す。Createに渡せばexp3.jsonの代わりに読み込める。
+     *
+     * @param[out]  buffer  書き出し先。既存の内容は破棄される
+     */
+    void WriteBinary(csmVector<csmByte>& buffer) const;
+
     /**
     * @brief モデルのパラメータの更新の実行
     *
@@ -87,7 +108,7 @@ public:
      *
      * 表情が参照しているパラメータを取得する。
      */
-    csmVector<ExpressionParameter> GetExpressionParameters();
+    const csmVector<ExpressionParameter>& GetExpressionParameters() const;
 
     /**
      * @brief 表情のフェードの値を取得
@@ -131,6 +152,18 @@ protected:
      */
     void Parse(const csmByte* exp3Json, csmSizeInt size);
 
+    /**
+     * @brief スナップショットの読み込み
+     *
+     * WriteBinaryで書き出したスナップショットを表情パラメータに展開する。
+     *
+     * @param[in]   expressionBinary    スナップショットが読み込まれているバッファ
+     * @param[in]   size                バッファのサイズ
+     * @return  true    展開できた
+     * @return  false   シグネチャやバージョンが違う、または壊れている
+     */
+    csmBool ParseBinary(const csmByte* expressionBinary, csmSizeInt size);
+
     csmVector<ExpressionParameter> _parameters;     ///< 表情が参照しているパラメータ一覧
 
 private:
@@ -112,7 +112,7 @@ private:
     csmVector<ExpressionParameterValue>* _expressionParameterValues;
 
     // 再生中の表情のウェイト
-    csmVector<csmFloat32> _fadeWeights;
+    csmSmallVector<csmFloat32, 4> _fadeWeights;
 
     csmInt32 _currentPriority;                  ///<  現在再生中のモーションの優先度
     csmInt32 _reservePriority;                  ///<  再生予定のモーションの優先度。再生中は0になる。モーションファイルを別スレッドで読み込むときの機能。
@@ -16,6 +16,7 @@ namespace Live2D { namespace Cubism { namespace Framework {
 
 class CubismMotionQueueEntry;
 struct CubismMotionData;
+struct CubismMotionCurveBatch;
 
 /**
  * @brief モーションクラス
@@ -30,13 +31,49 @@ public:
      *
      * インスタンスを作成する。
      *
-     * @param[in]   buffer                      motion3.jsonが読み込まれているバッファ
+     * バッファが motion3.bin であればバイナリとして、そうでなければ motion3.json として読み込む。
+     *
+     * @param[in]   buffer                      motion3.json または motion3.bin が読み込まれているバッファ
      * @param[in]   size                        バッファのサイズ
      * @param[in]   onFinishedMotionHandler     モーション再生終了時に呼び出されるコールバック関数。NULLの場合、呼び出されない。
-     * @return  作成されたインスタンス
+     * @return  作成されたインスタンス。motion3.bin が壊れているか、バージョンが古くて読み込めなければNULL。
      */
     static CubismMotion* Create(const csmByte* buffer, csmSizeInt size, FinishedMotionCallback onFinishedMotionHandler = NULL);
 
+    /**
+     * @brief モーションデータを共有するインスタンスの生成
+     *
+     * source のパース済みモーションデータを複製せずに参照するインスタンスを作成する。
+     * source は作成したインスタンスより長く生存させること。
+     * フェード時間を書き換える場合のみ、そのインスタンス用にモーションデータを複製する。
+     *
+     * @param[in]   source                      モーションデータの共有元
+     * @param[in]   onFinishedMotionHandler     モーション再生終了時に呼び出されるコールバック関数。NULLの場合、呼び出されない。
+     * @return  作成されたインスタンス
+     */
+    static CubismMotion* Create(const CubismMotion* source, FinishedMotionCallback onFinishedMotionHandler = NULL);
+
+    /**
+     * @brief motion3.bin の判定
+     *
+     * バッファが motion3.bin のシグネチャで始まっているかを判定する。
+     *
+     * @param[in]   buffer  判定するバッファ
+     * @param[in]   size    バッファのサイズ
+     * @return  true    motion3.bin
+     * @return  false   それ以外
+     */
+    static csmBool IsBinary(const csmByte* buffer, csmSizeInt size);
+
+    /**
+     * @brief motion3.bin の書き出し
+     *
+     * パース済みのモーションデータを motion3.bin の形式で書き出す。
+     *
+     * @param[out]  buffer  書き出し先。既存の内容は破棄される
+     */
+    void WriteBinary(csmVector<csmByte>& buffer) const;
+
     /**
     * @brief モデルのパラメータの更新の実行
     *
@@ -105,6 +142,52 @@ public:
      */
     virtual csmFloat32  GetLoopDuration();
 
+    /**
+     * @brief モーションデータのメモリ使用量の取得
+     *
+     * パース済みのモーションデータが使用しているメモリ量を取得する。
+     *
+     * @return  モーションデータのメモリ使用量[byte]
+     */
+    csmSizeType         GetMotionDataSize() const;
+
+    /**
+     * @brief カーブの数の取得
+     *
+     * @return  カーブの数
+     */
+    csmInt32            GetCurveCount() const;
+
+    /**
+     * @brief 全カーブの評価
+     *
+     * モデルに適用せずに、時間timeでの全カーブの値を求める。一括評価とカーブごとの評価の比較と計測に使う。
+     *
+     * @param[in]       time            時間[秒]
+     * @param[in]       batched         true セグメントの種類ごとにまとめて評価する / false カーブを1本ずつ評価する
+     * @param[in,out]   segmentCursors  カーブごとの前回評価したセグメントのインデックス。初回は-1で埋めておく
+     * @param[out]      values          カーブごとの値
+     */
+    void                EvaluateAllCurves(csmFloat32 time, csmBool batched, csmInt32* segmentCursors, csmFloat32* values);
+
+    /**
+     * @brief カーブの一括評価の設定
+     *
+     * trueにすると、更新時にカーブをセグメントの種類ごとにまとめてSIMDで評価する。結果はカーブごとの評価と同じ。
+     * 計測では代表的なモーションで速くならなかったため、初期値はfalse（カーブを1本ずつ評価する）。
+     * Create(const CubismMotion*, ...)で作ったインスタンスは元のモーションの設定を引き継ぐ。
+     *
+     * @param[in]   batched     true まとめて評価する / false カーブを1本ずつ評価する
+     */
+    void                SetBatchedCurveEvaluation(csmBool batched);
+
+    /**
+     * @brief カーブの一括評価の設定の取得
+     *
+     * @return  true まとめて評価する / false カーブを1本ずつ評価する
+     */
+    csmBool             IsBatchedCurveEvaluation() const;
+
     /**
      * @brief パラメータに対するフェードインの時間の設定
      *
@@ -204,6 +287,30 @@ protected:
     csmFloat32 GetModelOpacityValue() const;
 
 private:
+    /**
+     * @brief カーブとモデルのパラメータの対応
+     */
+    struct CurveBinding
+    {
+        csmInt32 ParameterIndex;    ///< カーブが操作するパラメータのインデックス。モデルのカーブは-1
+        csmUint64 EyeBlinkFlag;     ///< _eyeBlinkParameterIds内の位置を示すビット。まばたきの対象でなければ0
+        csmUint64 LipSyncFlag;      ///< _lipSyncParameterIds内の位置を示すビット。リップシンクの対象でなければ0
+    };
+
+    /**
+     * @brief モーションとモデルの対応付け
+     *
+     * モデルごとに一度だけ求めればよいパラメータのインデックスを保持する。
+     */
+    struct ModelBinding
+    {
+        const CubismModel* Model;                       ///< 対応付けたモデル
+        csmUint32 ModelInstanceNo;                      ///< 対応付けたモデルの通し番号
+        csmVector<CurveBinding> Curves;                 ///< カーブごとの対応
+        csmVector<csmInt32> EyeBlinkParameterIndices;   ///< _eyeBlinkParameterIdsのパラメータのインデックス
+        csmVector<csmInt32> LipSyncParameterIndices;    ///< _lipSyncParameterIdsのパラメータのインデックス
+    };
+
     /**
      * @brief コンストラクタ
      *
@@ -232,6 +339,53 @@ private:
      */
     void Parse(const csmByte* motionJson, const csmSizeInt size);
 
+    /**
+     * @brief motion3.binの読み込み
+     *
+     * motion3.binをモーションデータに展開する。
+     *
+     * @param[in]   motionBinary    motion3.binが読み込まれているバッファ
+     * @param[in]   size            バッファのサイズ
+     * @return  true    展開できた
+     * @return  false   シグネチャやバージョンが違う、または壊れている
+     */
+    csmBool ParseBinary(const csmByte* motionBinary, const csmSizeInt size);
+
+    /**
+     * @brief 共有しているモーションデータの複製
+     *
+     * 共有しているモーションデータをこのインスタンス専用に複製する。共有していなければ何もしない。
+     */
+    void DetachMotionData();
+
+    /**
+     * @brief モデルとの対応付けの取得
+     *
+     * 初めて更新するモデルであれば、カーブをモデルのパラメータに対応付けて保持する。
+     *
+     * @param[in]   model   対象のモデル
+     * @return  モデルとの対応付け
+     */
+    const ModelBinding* BindModel(CubismModel* model);
+
+    /**
+     * @brief モデルとの対応付けの破棄
+     *
+     * まばたき・リップシンクの対象が変わった時など、対応付けをやり直す必要がある時に呼ぶ。
+     */
+    void ClearModelBindings();
+
+    /**
+     * @brief カーブの一括評価
+     *
+     * 更新に使うカーブをセグメントの種類ごとにまとめて評価し、結果を_curveBatch->CurveValuesに格納する。
+     *
+     * @param[in]       binding         モデルとの対応付け。NULLなら全カーブを評価する
+     * @param[in]       time            時間[秒]
+     * @param[in,out]   segmentCursors  カーブごとの前回評価したセグメントのインデックス
+     */
+    void EvaluateCurves(const ModelBinding* binding, csmFloat32 time, csmInt32* segmentCursors);
+
     csmFloat32      _sourceFrameRate;                   ///< ロードしたファイルのFPS。記述が無ければデフォルト値15fpsとなる
     csmFloat32      _loopDurationSeconds;               ///< mtnファイルで定義される一連のモーションの長さ
     csmBool         _isLoop;                            ///< ループするか?
@@ -239,6 +393,7 @@ private:
     csmFloat32      _lastWeight;                        ///< 最後に設定された重み
 
     CubismMotionData*    _motionData;                   ///< 実際のモーションデータ本体
+    csmBool              _isMotionDataShared;           ///< モーションデータが他のインスタンスの所有物か
 
     csmVector<CubismIdHandle>  _eyeBlinkParameterIds;   ///< 自動まばたきを適用するパラメータIDハンドルのリスト。  モデル（モデルセッティング）とパラメータを対応付ける。
     csmVector<CubismIdHandle>  _lipSyncParameterIds;    ///< リップシンクを適用するパラメータIDハンドルのリスト。  モデル（モデルセッティング）とパラメータを対応付ける。
@@ -248,6 +403,10 @@ private:
     CubismIdHandle _modelCurveIdOpacity;                ///< モデルが持つ不透明度用パラメータIDのハンドル。  モデルとモーションを対応付ける。
 
     csmFloat32 _modelOpacity; ///< モーションから取得した不透明度
+
+    csmVector<ModelBinding*> _modelBindings;    ///< 更新したモデルごとの対応付け
+    csmBool _batchedCurveEvaluation;            ///< カーブをまとめて評価するか
+    CubismMotionCurveBatch* _curveBatch;        ///< カーブの一括評価に使う作業領域。まとめて評価するまでNULL
 };
 
 }}}
@@ -151,4 +151,109 @@ struct CubismMotionData
     csmVector<CubismMotionEvent> Events;          ///< イベントのリスト
 };
 
+/**
+ * @brief 同じ種類のセグメントをまとめて評価するためのバッファ
+ *
+ * セグメントのポイントを成分ごとの配列に並べ、SIMDで数個ずつ評価する。
+ * 配列の長さはSIMDの幅の倍数に切り上げておく。
+ */
+struct CubismMotionSegmentBatch
+{
+    CubismMotionSegmentBatch()
+        : Count(0)
+    { }
+
+    csmInt32 Count;                         ///< 集めたセグメントの個数
+    csmVector<csmInt32> CurveIndices;       ///< セグメントを含むカーブのインデックス
+    csmVector<csmFloat32> Times[4];         ///< ポイントごとの時間
+    csmVector<csmFloat32> Values[4];        ///< ポイントごとの値
+    csmVector<csmFloat32> Results;          ///< 評価結果
+};
+
+/**
+ * @brief カーブの一括評価に使う作業領域
+ */
+struct CubismMotionCurveBatch
+{
+    CubismMotionSegmentBatch LinearSegments;    ///< 線形のセグメント
+    CubismMotionSegmentBatch BezierSegments;    ///< ハンドルが制限されたベジェのセグメント
+    CubismMotionSegmentBatch CardanoSegments;   ///< カルダノの公式で解くベジェのセグメント
+    csmVector<csmFloat32> CurveValues;          ///< カーブごとの評価結果
+};
+
+/**
+ * @brief motion3.bin のシグネチャ（"MT3B"）
+ */
+const csmUint32 CubismMotionBinaryMagic = 0x4233544D;
+
+/**
+ * @brief motion3.bin のフォーマットバージョン
+ */
+const csmUint32 CubismMotionBinaryVersion = 1;
+
+/**
+ * @brief motion3.bin のフラグ
+ */
+enum CubismMotionBinaryFlag
+{
+    CubismMotionBinaryFlag_AreBeziersRestricted = 1 << 0   ///< ベジェのハンドルが制限されている
+};
+
+/**
+ * @brief motion3.bin のヘッダ
+ *
+ * motion3.bin はリトルエンディアンで、以下の順に隙間なく並ぶ。
+ * ヘッダ、カーブ[CurveCount]、セグメント[SegmentCount]、制御点[PointCount]、イベント[EventCount]、文字列プール[StringPoolSize]
+ * 制御点は CubismMotionPoint と同じレイアウトで、そのまま CubismMotionData::Points に複写できる。
+ * 文字列プールには ID とイベントの値が終端文字付きで格納される。
+ */
+struct CubismMotionBinaryHeader
+{
+    csmUint32 Magic;                            ///< CubismMotionBinaryMagic
+    csmUint32 Version;                          ///< CubismMotionBinaryVersion
+    csmFloat32 Duration;                        ///< モーションの長さ[秒]
+    csmFloat32 Fps;                             ///< フレームレート
+    csmFloat32 FadeInTime;                      ///< モーション全体のフェードイン時間[秒]
+    csmFloat32 FadeOutTime;                     ///< モーション全体のフェードアウト時間[秒]
+    csmInt32 Loop;                              ///< ループするかどうか
+    csmUint32 Flags;                            ///< CubismMotionBinaryFlag の組み合わせ
+    csmInt32 CurveCount;                        ///< カーブの個数
+    csmInt32 SegmentCount;                      ///< セグメントの総数
+    csmInt32 PointCount;                        ///< 制御点の総数
+    csmInt32 EventCount;                        ///< イベントの個数
+    csmUint32 StringPoolSize;                   ///< 文字列プールのバイト数
+    csmUint32 Reserved;                         ///< 予約領域（0）
+};
+
+/**
+ * @brief motion3.bin のカーブ
+ */
+struct CubismMotionBinaryCurve
+{
+    csmInt32 Type;                              ///< CubismMotionCurveTarget
+    csmUint32 IdOffset;                         ///< 文字列プール内の ID の位置
+    csmInt32 SegmentCount;                      ///< セグメントの個数
+    csmInt32 BaseSegmentIndex;                  ///< 最初のセグメントのインデックス
+    csmFloat32 FadeInTime;                      ///< フェードイン時間[秒]。未指定なら -1
+    csmFloat32 FadeOutTime;                     ///< フェードアウト時間[秒]。未指定なら -1
+};
+
+/**
+ * @brief motion3.bin のセグメント
+ */
+struct CubismMotionBinarySegment
+{
+    csmInt32 SegmentType;                       ///< CubismMotionSegmentType
+    csmInt32 BasePointIndex;                    ///< 最初の制御点のインデックス
+};
+
+/**
+ * @brief motion3.bin のイベント
+ */
+struct CubismMotionBinaryEvent
+{
+    csmFloat32 FireTime;                        ///< 発火時間[秒]
+    csmUint32 ValueOffset;                      ///< 文字列プール内の値の位置
+};
+
 }}}
@@ -36,7 +36,7 @@ public:
      * コンストラクタ。
      *
      * @param[in]   buffer  motion3.jsonが読み込まれているバッファ
-     * @param[in]   size    バッファのサイズ
+     * @param[in]   size    バッファのサイズ。バッファはインスタンスを破棄するまで保持すること
      */
     CubismMotionJson(const csmByte* buffer, csmSizeInt size);
 
@@ -254,6 +254,8 @@ private:
     csmBool         _IsTriggeredFadeOut;
 
     CubismMotionQueueEntryHandle  _motionQueueEntryHandle;        ///< インスタンスごとに一意の値を持つ識別番号
+
+    csmVector<csmInt32> _segmentCursors;            ///< カーブごとに前回評価したセグメントのインデックス。CubismMotionが使う
 };
 
 }}}
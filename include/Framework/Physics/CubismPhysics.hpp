@@ -23,6 +23,15 @@ struct CubismPhysicsRig;
 class CubismPhysics
 {
 public:
+    /**
+     * @brief 物理点の計算方法
+     */
+    enum SolverType
+    {
+        SolverType_Reference = 0,   ///< 振り子ごとに物理点を1つずつ計算する
+        SolverType_Simd = 1         ///< 依存しない振り子をSIMDのレーンに並べてまとめて計算する。演算の順序は参照実装と同じ
+    };
+
     /**
      * @brief オプション
      *
@@ -32,6 +41,12 @@ public:
     {
         CubismVector2 Gravity; ///< 重力方向
         CubismVector2 Wind; ///< 風の方向
+        SolverType Solver; ///< 物理点の計算方法
+        csmInt32 MaxSubSteps; ///< 1回の計算で進める最大ステップ数。0以下なら制限しない。超えた分の時間は捨て、長いフレームでもリセットしない
+        csmFloat32 FpsScale; ///< 物理演算のフレームレートに掛ける倍率。1より小さくすると1ステップが長くなり、ステップ数が減る。0以下と1以上は1として扱う
+        csmInt32 SkipFrames; ///< 続けて計算を省くフレーム数。1ステップをその分だけ長くし、省いたフレームは直前の結果を補間し直す
+        csmFloat32 SleepVelocityThreshold; ///< 入力が変わらず、物理点の速度がこれを下回った設定は休止する。0以下なら休止しない
+        csmFloat32 WakeInputEpsilon; ///< 休止した設定は、正規化した入力がこれより動くまで前回の出力を使い続ける
     };
 
     /**
@@ -55,6 +70,17 @@ public:
      */
     static CubismPhysics* Create(const csmByte* buffer, csmSizeInt size);
 
+    /**
+     * @brief 設定を複製したインスタンスの作成
+     *
+     * source のパース済みの物理演算設定を複製し、初期状態のインスタンスを作成する。
+     * physics3.jsonを再度パースする必要がない。
+     *
+     * @param[in]   source      複製元のインスタンス
+     * @return  作成されたインスタンス
+     */
+    static CubismPhysics* Create(const CubismPhysics* source);
+
     /**
      * @brief インスタンスの破棄
      *
@@ -64,6 +90,27 @@ public:
      */
     static void Delete(CubismPhysics* physics);
 
+    /**
+     * @brief スナップショットの判定
+     *
+     * バッファがWriteBinaryで書き出したスナップショットのシグネチャで始まっているかを判定する。
+     *
+     * @param[in]   buffer  判定するバッファ
+     * @param[in]   size    バッファのサイズ
+     * @return  true    スナップショット
+     * @return  false   それ以外
+     */
+    static csmBool IsBinary(const csmByte* buffer, csmSizeInt size);
+
+    /**
+     * @brief スナップショットの書き出し
+     *
+     * パース済みの物理演算の設定をバイナリ形式で書き出す。Createに渡せばphysics3.jsonの代わりに読み込める。
+     *
+     * @param[out]  buffer  書き出し先。既存の内容は破棄される
+     */
+    void WriteBinary(csmVector<csmByte>& buffer) const;
+
     /**
      * @brief パラメータのリセット
      *
@@ -87,6 +134,26 @@ public:
      */
     void Evaluate(CubismModel* model, csmFloat32 deltaTimeSeconds);
 
+    /**
+     * @brief 物理演算の計算
+     *
+     * Evaluateのうち、モデルのパラメータに結果を書き込む前までを行う。結果はApplyOutputsで書き込む。
+     * モデルのパラメータは読み込むだけなので、モデルごとのインスタンスであれば別のスレッドで並行して呼び出せる。
+     *
+     * @param[in]   model               物理演算の結果を適用するモデル
+     * @param[in]   deltaTimeSeconds    デルタ時間[秒]
+     */
+    void Simulate(CubismModel* model, csmFloat32 deltaTimeSeconds);
+
+    /**
+     * @brief 物理演算の結果の適用
+     *
+     * 直前のSimulateの結果をモデルのパラメータに書き込む。書き込む結果がなければ何もしない。
+     *
+     * @param[in]   model               物理演算の結果を適用するモデル
+     */
+    void ApplyOutputs(CubismModel* model);
+
     /**
      * @brief オプションの設定
      *
@@ -134,6 +201,16 @@ private:
      */
     void Parse(const csmByte* physicsJson, csmSizeInt size);
 
+    /**
+     * @brief スナップショットの読み込み
+     *
+     * WriteBinaryで書き出したスナップショットを物理演算の設定に展開する。
+     *
+     * @param[in]   physicsBinary   スナップショットが読み込まれているバッファ
+     * @param[in]   size            バッファのサイズ
+     */
+    void ParseBinary(const csmByte* physicsBinary, csmSizeInt size);
+
     /**
      * @brief 初期化
      *
@@ -151,6 +228,103 @@ private:
      */
     void Interpolate(CubismModel* model, csmFloat32 weight);
 
+    /**
+     * @brief 物理演算の入力の計算
+     *
+     * 設定の入力パラメータを_parameterCachesから読み込み、振り子の根元の位置と角度を求める。
+     *
+     * @param[in]   model               物理演算の結果を適用するモデル
+     * @param[in]   settingIndex        設定のインデックス
+     * @param[out]  totalTranslation    振り子の根元の位置
+     * @param[out]  totalAngle          振り子の角度
+     */
+    void LoadInputs(CubismModel* model, csmInt32 settingIndex, CubismVector2* totalTranslation, csmFloat32* totalAngle);
+
+    /**
+     * @brief 物理演算の出力の計算
+     *
+     * 設定の物理点の位置から出力を求め、_currentRigOutputsと_parameterCachesに書き込む。
+     *
+     * @param[in]   model               物理演算の結果を適用するモデル
+     * @param[in]   settingIndex        設定のインデックス
+     */
+    void UpdateOutputs(CubismModel* model, csmInt32 settingIndex);
+
+    /**
+     * @brief モデルとの結び付け
+     *
+     * 入出力のパラメータのインデックスを解決し、参照するパラメータだけを詰めたキャッシュの並びを作る。
+     * モデルのパラメータの配列も保持しておく。同じモデルで呼ばれた時は何もしない。
+     *
+     * @param[in]   model               物理演算の結果を適用するモデル
+     */
+    void Bind(CubismModel* model);
+
+    /**
+     * @brief 休止している設定の入力の確認
+     *
+     * 正規化した入力を前回の値と比べ、WakeInputEpsilonより動いていれば休止を解く。
+     *
+     * @param[in]   settingIndex        設定のインデックス
+     * @param[in]   totalTranslation    正規化した入力の移動
+     * @param[in]   totalAngle          正規化した入力の角度
+     * @return  休止したままならtrue
+     */
+    csmBool CheckRestInputs(csmInt32 settingIndex, const CubismVector2& totalTranslation, csmFloat32 totalAngle);
+
+    /**
+     * @brief 設定の静止状態の更新
+     *
+     * 物理点を計算した後に呼び、入力が動いておらず速度が十分小さければ設定を休止させる。
+     *
+     * @param[in]   settingIndex        設定のインデックス
+     * @param[in]   maxVelocity         設定の物理点の速度の成分の絶対値の最大
+     */
+    void UpdateRestState(csmInt32 settingIndex, csmFloat32 maxVelocity);
+
+    /**
+     * @brief 前回の出力の再利用
+     *
+     * 休止している設定の_currentRigOutputsを_parameterCachesに書き込み、後の設定に伝える。
+     *
+     * @param[in]   model               物理演算の結果を適用するモデル
+     * @param[in]   settingIndex        設定のインデックス
+     */
+    void ReuseOutputs(CubismModel* model, csmInt32 settingIndex);
+
+    /**
+     * @brief 振り子をまとめて計算するための並びの作成
+     *
+     * 入出力のパラメータから設定の依存関係を調べ、同時に計算できる設定の振り子をSIMDのレーンに割り当てる。
+     *
+     * @param[in]   model   物理演算の結果を適用するモデル
+     */
+    void BuildStrandState(CubismModel* model);
+
+    /**
+     * @brief 振り子の状態の読み込み
+     *
+     * CubismPhysicsParticleの位置と速度を_strandStateに読み込む。
+     */
+    void LoadStrandState();
+
+    /**
+     * @brief 振り子の状態の書き戻し
+     *
+     * _strandStateにしかない速度と重力をCubismPhysicsParticleに書き戻す。
+     */
+    void StoreStrandState();
+
+    /**
+     * @brief 振り子をまとめた物理演算の更新
+     *
+     * SolverType_Simdの時に、1回分の物理演算を行う。
+     *
+     * @param[in]   model               物理演算の結果を適用するモデル
+     * @param[in]   deltaTimeSeconds    物理演算のデルタ時間[秒]
+     */
+    void UpdateStrands(CubismModel* model, csmFloat32 deltaTimeSeconds);
+
     CubismPhysicsRig* _physicsRig; ///< 物理演算のデータ
     Options _options; ///< オプション
 
@@ -158,11 +332,24 @@ private:
     csmVector<PhysicsOutput> _previousRigOutputs; ///< 一つ前の振り子計算の結果
 
     csmFloat32 _currentRemainTime; ///< 物理演算が処理していない時間
+    csmFloat32 _outputWeight; ///< ApplyOutputsで適用する最新結果の重み
+    csmBool _isOutputPending; ///< ApplyOutputsで適用する結果があるか
+    csmInt32 _skippedFrameCount; ///< 続けて計算を省いたフレーム数
 
-    csmVector<csmFloat32> _parameterCaches;      ///< Evaluateで利用するパラメータのキャッシュ
+    csmVector<csmFloat32> _parameterCaches;      ///< Evaluateで利用するパラメータのキャッシュ。_boundParameterIndicesの順に並ぶ
     csmVector<csmFloat32> _parameterInputCaches; ///< UpdateParticlesが動くときの入力をキャッシュ
+    csmVector<csmInt32> _boundParameterIndices;  ///< キャッシュの要素ごとのモデルのパラメータのインデックス
+
+    CubismModel* _boundModel; ///< Bindで結び付けたモデル
+    csmFloat32* _parameterValues; ///< 結び付けたモデルのパラメータの値
+    const csmFloat32* _parameterMaximumValues; ///< 結び付けたモデルのパラメータの最大値
+    const csmFloat32* _parameterMinimumValues; ///< 結び付けたモデルのパラメータの最小値
+    const csmFloat32* _parameterDefaultValues; ///< 結び付けたモデルのパラメータのデフォルト値
 
     csmBool _isJsonValid; ///< 正しくJsonデータが取得出来たか
+
+    CubismPhysicsStrandState _strandState; ///< SolverType_Simdで使う振り子の状態
+    csmVector<CubismPhysicsRestState> _restStates; ///< 設定ごとの静止状態
 };
 
 }}}
@@ -173,7 +173,8 @@ typedef csmFloat32 (*PhysicsScaleGetter)(CubismVector2 translationScale, csmFloa
 struct CubismPhysicsInput
 {
     CubismPhysicsParameter Source;                  ///< 入力元のパラメータ
-    csmInt32 SourceParameterIndex;                  ///< 入力元のパラメータのインデックス
+    csmInt32 SourceParameterIndex;                  ///< 入力元のパラメータのインデックス。モデルにない時は-1
+    csmInt32 SourceCacheIndex;                      ///< 入力元のパラメータのキャッシュでの位置。モデルにない時は-1
     csmFloat32 Weight;                              ///< 重み
     csmInt16 Type;                                  ///< 入力の種類
     csmInt16 Reflect;                               ///< 値が反転されているかどうか
@@ -188,7 +189,8 @@ struct CubismPhysicsInput
 struct CubismPhysicsOutput
 {
     CubismPhysicsParameter Destination;         ///< 出力先のパラメータ
-    csmInt32 DestinationParameterIndex;         ///< 出力先のパラメータのインデックス
+    csmInt32 DestinationParameterIndex;         ///< 出力先のパラメータのインデックス。モデルにない時は-1
+    csmInt32 DestinationCacheIndex;             ///< 出力先のパラメータのキャッシュでの位置。モデルにない時は-1
     csmInt32 VertexIndex;                       ///< 振り子のインデックス
     CubismVector2 TranslationScale;             ///< 移動値のスケール
     csmFloat32 AngleScale;                      ///< 角度のスケール
@@ -201,6 +203,92 @@ struct CubismPhysicsOutput
     PhysicsScaleGetter GetScale;                ///< 物理演算のスケール値の取得関数
 };
 
+/**
+ * @brief 物理演算の設定ごとの静止状態
+ *
+ * 入力が変わらず物理点がほぼ止まった設定は休止し、入力が動くまで前回の出力を使い続ける。
+ */
+struct CubismPhysicsRestState
+{
+    CubismPhysicsRestState()
+        : IsSleeping(false)
+        , IsInputSteady(false)
+        , RestTickCount(0)
+        , Angle(0.0f)
+    { }
+
+    csmBool IsSleeping;                 ///< 休止しているか
+    csmBool IsInputSteady;              ///< 最新の入力が前回から動いていないか
+    csmInt32 RestTickCount;             ///< 静止の条件を続けて満たした回数
+    CubismVector2 Translation;          ///< 比較に使う入力の移動。休止中は休止した時の値
+    csmFloat32 Angle;                   ///< 比較に使う入力の角度。休止中は休止した時の値
+};
+
+/**
+ * @brief 同時に計算する振り子の束
+ *
+ * SIMDのレーンの数だけ振り子を束ね、物理点の成分を[物理点の段][レーン]の順に並べる。
+ */
+struct CubismPhysicsStrandBlock
+{
+    csmInt32 BaseParticleIndex;     ///< 物理点の成分の配列での先頭
+    csmInt32 ParticleCount;         ///< 束ねた中で最も長い振り子の物理点の個数
+    csmBool IsSleeping;             ///< 束ねた設定がすべて休止しているか
+};
+
+/**
+ * @brief 互いに依存しない物理演算の設定のまとまり
+ *
+ * 先の設定の出力を入力に使う設定は、後のまとまりに置かれる。
+ */
+struct CubismPhysicsStrandWave
+{
+    csmInt32 BaseSettingIndex;      ///< CubismPhysicsStrandState::SettingOrderでの先頭
+    csmInt32 SettingCount;          ///< 設定の個数
+    csmInt32 BaseBlockIndex;        ///< 最初の振り子の束のインデックス
+    csmInt32 BlockCount;            ///< 振り子の束の個数
+};
+
+/**
+ * @brief 振り子を並べて計算するための物理点の状態
+ *
+ * 物理点の位置と速度を成分ごとの配列で保持する。IsLoadedの間はこちらが最新で、
+ * CubismPhysicsParticleには出力に使う位置だけを書き戻す。
+ */
+struct CubismPhysicsStrandState
+{
+    CubismPhysicsStrandState()
+        : IsBuilt(false)
+        , IsLoaded(false)
+    { }
+
+    csmBool IsBuilt;                                    ///< 並びを作成済みか
+    csmBool IsLoaded;                                   ///< CubismPhysicsParticleから状態を読み込み済みか
+    csmVector<CubismPhysicsStrandWave> Waves;           ///< 設定のまとまりのリスト
+    csmVector<CubismPhysicsStrandBlock> Blocks;         ///< 振り子の束のリスト
+    csmVector<csmInt32> SettingOrder;                   ///< まとまりの順に並べた設定のインデックス
+    csmVector<csmInt32> SettingLanes;                   ///< 設定ごとのレーンの通し番号
+
+    csmVector<csmFloat32> PositionX;                    ///< 物理点の位置
+    csmVector<csmFloat32> PositionY;
+    csmVector<csmFloat32> VelocityX;                    ///< 物理点の速度
+    csmVector<csmFloat32> VelocityY;
+    csmVector<csmFloat32> Acceleration;                 ///< 物理点の加速度
+    csmVector<csmFloat32> Delay;                        ///< 物理点の遅れ
+    csmVector<csmFloat32> Radius;                       ///< 物理点の距離
+    csmVector<csmFloat32> Mobility;                     ///< 物理点の動きやすさ
+
+    csmVector<csmFloat32> RootX;                        ///< レーンごとの振り子の根元の位置
+    csmVector<csmFloat32> RootY;
+    csmVector<csmFloat32> GravityX;                     ///< レーンごとの今回の重力
+    csmVector<csmFloat32> GravityY;
+    csmVector<csmFloat32> LastGravityX;                 ///< レーンごとの前回の重力
+    csmVector<csmFloat32> LastGravityY;
+    csmVector<csmFloat32> RotationCos;                  ///< レーンごとの重力の変化による回転
+    csmVector<csmFloat32> RotationSin;
+    csmVector<csmFloat32> Threshold;                    ///< レーンごとの動きの閾値
+};
+
 /**
  * @brief 物理演算のデータ
  *
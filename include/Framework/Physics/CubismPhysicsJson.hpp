@@ -28,7 +28,7 @@ public:
      * コンストラクタ。
      *
      * @param[in]   buffer  physics3.jsonが読み込まれているバッファ
-     * @param[in]   size    バッファのサイズ
+     * @param[in]   size    バッファのサイズ。バッファはインスタンスを破棄するまで保持すること
      */
     CubismPhysicsJson(const csmByte* buffer, csmSizeInt size);
 
@@ -135,9 +135,9 @@ public:
 
 protected:
     T_OffscreenSurface* _currentMaskBuffer; /// オフスクリーンサーフェイスのアドレス
-    csmVector<csmBool> _clearedMaskBufferFlags; /// マスクのクリアフラグの配列
+    csmSmallVector<csmBool, 8> _clearedMaskBufferFlags; /// マスクのクリアフラグの配列
 
-    csmVector<CubismRenderer::CubismTextureColor*> _channelColors;
+    csmSmallVector<CubismRenderer::CubismTextureColor*, 4> _channelColors;
     csmVector<T_ClippingContext*> _clippingContextListForMask;   ///< マスク用クリッピングコンテキストのリスト
     csmVector<T_ClippingContext*> _clippingContextListForDraw;   ///< 描画用クリッピングコンテキストのリスト
     CubismVector2 _clippingMaskBufferSize;       ///< クリッピングマスクのバッファサイズ（初期値:256）
@@ -205,7 +205,6 @@ CubismClippingManager<T_ClippingContext, T_OffscreenSurface>::~CubismClippingMan
     if (_clearedMaskBufferFlags.GetSize() != 0)
     {
         _clearedMaskBufferFlags.Clear();
-        _clearedMaskBufferFlags = NULL;
     }
 }
 
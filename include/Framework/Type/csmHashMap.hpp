@@ -0,0 +1,519 @@
+﻿/**
+ * Copyright(c) Live2D Inc. All rights reserved.
+ *
+ * Use of this source code is governed by the Live2D Open Software license
+ * that can be found at https://www.live2d.com/eula/live2d-open-software-license-agreement_en.html.
+ */
+
+#pragma once
+
+#include "Framework/CubismFramework.hpp"
+#include "csmMap.hpp"
+#include "csmString.hpp"
+
+#ifndef NULL
+#   define  NULL 0
+#endif
+
+//--------- LIVE2D NAMESPACE ------------
+namespace Live2D { namespace Cubism { namespace Framework {
+
+/**
+ * @brief   csmHashMapのキーからハッシュ値を求める
+ *
+ * csmString、32ビット整数、ポインタ（CubismIdHandleなど）に対応する。<br>
+ * 値はcsmHashMap側でかき混ぜるので、ここではキーの違いが値に現れればよい。
+ */
+template<class _KeyT>
+struct csmHash;
+
+template<>
+struct csmHash<csmString>
+{
+    static csmUint32 Get(const csmString& key) { return static_cast<csmUint32>(key.GetHashcode()); }
+};
+
+template<>
+struct csmHash<csmInt32>
+{
+    static csmUint32 Get(csmInt32 key) { return static_cast<csmUint32>(key); }
+};
+
+template<class T>
+struct csmHash<T*>
+{
+    static csmUint32 Get(T* key)
+    {
+        const csmUint64 address = static_cast<csmUint64>(reinterpret_cast<csmSizeType>(key));
+        return static_cast<csmUint32>(address) ^ static_cast<csmUint32>(address >> 32);
+    }
+};
+
+/**
+ * @brief   オープンアドレス法のハッシュマップ<br>
+ *           csmMapと同じ操作とイテレータを持ち、キーの検索が要素数によらず一定の時間で済む。
+ *
+ * 要素はcsmMapと同じく追加した順に連続した配列に並び、イテレータはその順に巡回する。<br>
+ * 配列の位置は別のハッシュ表（線形探索、負荷率1/2以下）で引く。
+ */
+template<class _KeyT, class _ValT>
+class csmHashMap
+{
+public:
+
+    /**
+     * @brief    コンストラクタ
+     */
+    csmHashMap();
+
+    /**
+     * @brief   デストラクタ
+     *
+     */
+    virtual ~csmHashMap();
+
+    /**
+     * @brief   キーを追加する
+     *
+     * @param[in]   key ->  新たに追加するキー
+     */
+    void AppendKey(const _KeyT& key)
+    {
+        PrepareCapacity(_size + 1, false); //１つ以上入る隙間を作る
+
+        void* addr = &_keyValues[_size];
+        CSM_PLACEMENT_NEW(addr) csmPair<_KeyT, _ValT>(key); //placement new
+
+        _size += 1;
+        Link(_size - 1);
+    }
+
+    /**
+     * @brief   添字演算子[key]のオーバーロード
+     *
+     * @return  添字から特定されるValue値。キーがなければ追加する
+     */
+    _ValT& operator[](const _KeyT& key)
+    {
+        const csmInt32 found = FindIndex(key);
+        if (found >= 0)
+        {
+            return _keyValues[found].Second;
+        }
+
+        AppendKey(key); // 新規キーを追加
+        return _keyValues[_size - 1].Second;
+    }
+
+    /**
+     * @brief   添字演算子[key]のオーバーロード(const)
+     *
+     * @return  添字から特定されるValue値
+     */
+    const _ValT& operator[](const _KeyT& key) const
+    {
+        const csmInt32 found = FindIndex(key);
+        if (found >= 0)
+        {
+            return _keyValues[found].Second;
+        }
+
+        if (!_dummyValuePtr) _dummyValuePtr = CSM_NEW _ValT();
+        return *_dummyValuePtr;
+    }
+
+    /**
+     * @brief   引数で渡したKeyを持つ要素が存在するか
+     *
+     * @retval  true    ->  引数で渡したKeyを持つ要素が存在する
+     * @retval  false   ->  引数で渡したKeyを持つ要素が存在しない
+     */
+    csmBool IsExist(const _KeyT& key) const
+    {
+        return FindIndex(key) >= 0;
+    }
+
+    /**
+     * @brief   Key-Valueのポインタを全て解放する
+     */
+    void Clear();
+
+    /**
+     * @brief   コンテナのサイズを取得する
+     *
+     * @return  コンテナのサイズ
+     */
+    csmInt32 GetSize() const { return _size; }
+
+    /**
+     * @brief   コンテナのキャパシティを確保する
+     *
+     * @param[in]   newSize     -> 新たなキャパシティ。引数の値が現在のサイズ未満の場合は何もしない。
+     * @param[in]   fitToSize   ->  trueなら指定したサイズに合わせる。falseならサイズを2倍確保しておく。
+     */
+    void PrepareCapacity(csmInt32 newSize, csmBool fitToSize);
+
+    /**
+     * @brief   csmHashMap<T>のイテレータ
+     */
+    class iterator
+    {
+        friend class csmHashMap;
+
+    public:
+        iterator() : _index(0)
+                   , _map(NULL) {}
+
+        iterator(csmHashMap<_KeyT, _ValT>* v, csmInt32 idx = 0) : _index(idx)
+                                                                , _map(v) {}
+
+        iterator& operator++()
+        {
+            ++this->_index;
+            return *this;
+        }
+
+        iterator& operator--()
+        {
+            --this->_index;
+            return *this;
+        }
+
+        iterator operator++(csmInt32)
+        {
+            iterator iteold(this->_map, this->_index++); // 古い値を保存
+            return iteold;
+        }
+
+        iterator operator--(csmInt32)
+        {
+            iterator iteold(this->_map, this->_index--); // 古い値を保存
+            return iteold;
+        }
+
+        csmPair<_KeyT, _ValT>* operator->() const
+        {
+            return &this->_map->_keyValues[this->_index];
+        }
+
+        csmPair<_KeyT, _ValT>& operator*() const
+        {
+            return this->_map->_keyValues[this->_index];
+        }
+
+        csmBool operator!=(const iterator& ite) const
+        {
+            return (this->_index != ite._index) || (this->_map != ite._map);
+        }
+
+    private:
+        csmInt32 _index;                    ///< コンテナのインデックス値
+        csmHashMap<_KeyT, _ValT>* _map;     ///< コンテナのポインタ
+    };
+
+    /**
+     * @brief   csmHashMap<T>のイテレータ(const)
+     */
+    class const_iterator
+    {
+        friend class csmHashMap;
+
+    public:
+        const_iterator() : _index(0)
+                         , _map(NULL) {}
+
+        const_iterator(const csmHashMap<_KeyT, _ValT>* v, csmInt32 idx = 0) : _index(idx)
+                                                                            , _map(v) {}
+
+        const_iterator& operator++()
+        {
+            ++this->_index;
+            return *this;
+        }
+
+        const_iterator& operator--()
+        {
+            --this->_index;
+            return *this;
+        }
+
+        const_iterator operator++(csmInt32)
+        {
+            const_iterator iteold(this->_map, this->_index++); // 古い値を保存
+            return iteold;
+        }
+
+        const_iterator operator--(csmInt32)
+        {
+            const_iterator iteold(this->_map, this->_index--); // 古い値を保存
+            return iteold;
+        }
+
+        csmPair<_KeyT, _ValT>* operator->() const
+        {
+            return &this->_map->_keyValues[this->_index];
+        }
+
+        csmPair<_KeyT, _ValT>& operator*() const
+        {
+            return this->_map->_keyValues[this->_index];
+        }
+
+        csmBool operator!=(const const_iterator& ite) const
+        {
+            return (this->_index != ite._index) || (this->_map != ite._map);
+        }
+
+        csmBool operator==(const const_iterator& ite) const
+        {
+            return !(*this != ite);
+        }
+
+    private:
+        csmInt32 _index;                        ///< コンテナのインデックス値
+        const csmHashMap<_KeyT, _ValT>* _map;   ///< コンテナのポインタ(const)
+    };
+
+    /**
+     * @brief   コンテナの先頭要素を返す
+     *
+     */
+    const const_iterator Begin() const
+    {
+        return const_iterator(this, 0);
+    }
+
+    /**
+     * @bief    コンテナの終端要素を返す
+     *
+     */
+    const const_iterator End() const
+    {
+        return const_iterator(this, _size); // 終了
+    }
+
+    /**
+     * @brief   キーを持つ要素を探す
+     *
+     * csmMapと異なり、見つからなくても要素を追加しない。
+     *
+     * @param[in]   key ->  探すキー
+     * @return  見つかった要素。見つからなければEnd()
+     */
+    const const_iterator Find(const _KeyT& key) const
+    {
+        const csmInt32 found = FindIndex(key);
+        return const_iterator(this, found >= 0 ? found : _size);
+    }
+
+    /**
+     * @brief   コンテナから要素を削除する
+     *
+     * 後ろの要素を詰めるので、ハッシュ表は作り直す。
+     *
+     * @param[in]   ite ->  削除する要素
+     *
+     */
+    const iterator Erase(const iterator& ite)
+    {
+        EraseAt(ite._index);
+        return iterator(this, ite._index);
+    }
+
+    /**
+     * @brief   コンテナから要素を削除する
+     *
+     * @param[in]   ite ->  削除する要素
+     *
+     */
+    const const_iterator Erase(const const_iterator& ite)
+    {
+        EraseAt(ite._index);
+        return const_iterator(this, ite._index);
+    }
+
+private:
+    static const csmInt32 DefaultSize = 10;  ///< コンテナ初期化のデフォルトサイズ
+    static const csmInt32 MinimumSlotCount = 16;    ///< ハッシュ表の最小の大きさ
+
+    // 要素を直接保持するのでコピーはできない
+    csmHashMap(const csmHashMap&);
+    csmHashMap& operator=(const csmHashMap&);
+
+    /**
+     * @brief   ハッシュ値の下位ビットに上位ビットの違いを行き渡らせる
+     */
+    static csmUint32 Mix(csmUint32 hash)
+    {
+        hash ^= hash >> 16;
+        hash *= 0x85EBCA6Bu;
+        hash ^= hash >> 13;
+        hash *= 0xC2B2AE35u;
+        hash ^= hash >> 16;
+        return hash;
+    }
+
+    /**
+     * @brief   キーを持つ要素のインデックスを返す。なければ-1
+     */
+    csmInt32 FindIndex(const _KeyT& key) const
+    {
+        if (_slotCount == 0)
+        {
+            return -1;
+        }
+
+        const csmUint32 mask = static_cast<csmUint32>(_slotCount - 1);
+        for (csmUint32 slot = Mix(csmHash<_KeyT>::Get(key)) & mask; ; slot = (slot + 1) & mask)
+        {
+            const csmInt32 entry = _slots[slot];
+            if (entry == 0)
+            {
+                return -1;
+            }
+            if (_keyValues[entry - 1].First == key)
+            {
+                return entry - 1;
+            }
+        }
+    }
+
+    /**
+     * @brief   要素をハッシュ表に登録する
+     */
+    void Link(csmInt32 index)
+    {
+        if (_size * 2 > _slotCount)
+        {
+            Rehash(_slotCount == 0 ? MinimumSlotCount : _slotCount * 2);
+            return; // 作り直しで登録される
+        }
+
+        const csmUint32 mask = static_cast<csmUint32>(_slotCount - 1);
+        csmUint32 slot = Mix(csmHash<_KeyT>::Get(_keyValues[index].First)) & mask;
+        while (_slots[slot] != 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+        _slots[slot] = index + 1;
+    }
+
+    /**
+     * @brief   ハッシュ表を指定の大きさで作り直し、全要素を登録する
+     */
+    void Rehash(csmInt32 slotCount)
+    {
+        if (slotCount != _slotCount)
+        {
+            CSM_FREE(_slots);
+            _slots = static_cast<csmInt32*>(CSM_MALLOC(sizeof(csmInt32) * slotCount));
+            CSM_ASSERT(_slots != NULL);
+            _slotCount = slotCount;
+        }
+        memset(_slots, 0, sizeof(csmInt32) * _slotCount);
+
+        const csmUint32 mask = static_cast<csmUint32>(_slotCount - 1);
+        for (csmInt32 i = 0; i < _size; ++i)
+        {
+            csmUint32 slot = Mix(csmHash<_KeyT>::Get(_keyValues[i].First)) & mask;
+            while (_slots[slot] != 0)
+            {
+                slot = (slot + 1) & mask;
+            }
+            _slots[slot] = i + 1;
+        }
+    }
+
+    void EraseAt(csmInt32 index)
+    {
+        if (index < 0 || _size <= index) return; // 削除範囲外
+
+        _keyValues[index].~csmPair<_KeyT, _ValT>();
+
+        // 削除(メモリをシフトする)、最後の一つを削除する場合はmove不要
+        if (index < _size - 1)
+            memmove(static_cast<void*>(&_keyValues[index]), static_cast<void*>(&_keyValues[index + 1]), sizeof(csmPair<_KeyT, _ValT>) * (_size - index - 1));
+        --_size;
+
+        Rehash(_slotCount);
+    }
+
+    csmPair<_KeyT, _ValT>* _keyValues;      ///< Key-Valueペアの配列
+    mutable _ValT* _dummyValuePtr;          ///< 空の値を返すためのダミー
+    csmInt32 _size;                         ///< コンテナの要素数（サイズ）
+    csmInt32 _capacity;                     ///< コンテナのキャパシティ
+    csmInt32* _slots;                       ///< ハッシュ表。要素のインデックス+1を持ち、0は空き
+    csmInt32 _slotCount;                    ///< ハッシュ表の大きさ（2の累乗）
+};
+
+
+//========================テンプレートの定義==============================
+
+template<class _KeyT, class _ValT>
+csmHashMap<_KeyT, _ValT>::csmHashMap()
+    : _keyValues(NULL)
+    , _dummyValuePtr(NULL)
+    , _size(0)
+    , _capacity(0)
+    , _slots(NULL)
+    , _slotCount(0)
+{ }
+
+template<class _KeyT, class _ValT>
+csmHashMap<_KeyT, _ValT>::~csmHashMap()
+{
+    Clear();
+}
+
+template<class _KeyT, class _ValT>
+void csmHashMap<_KeyT, _ValT>::PrepareCapacity(csmInt32 newSize, csmBool fitToSize)
+{
+    if (newSize <= _capacity)
+    {
+        return;
+    }
+
+    if (!fitToSize)
+    {
+        const csmInt32 grown = _capacity == 0 ? DefaultSize : _capacity * 2; // 指定サイズに合わせる必要がない場合は、２倍に広げる
+        if (newSize < grown) newSize = grown;
+    }
+
+    csmPair<_KeyT, _ValT>* tmp = static_cast<csmPair<_KeyT, _ValT> *>(CSM_MALLOC(sizeof(csmPair<_KeyT, _ValT>) * newSize));
+
+    CSM_ASSERT(tmp != NULL);
+
+    if (_keyValues)
+    {
+        memcpy(static_cast<void*>(tmp), static_cast<void*>(_keyValues), sizeof(csmPair<_KeyT, _ValT>) * _size);
+        CSM_FREE(_keyValues);
+    }
+
+    _keyValues = tmp;
+    _capacity = newSize;
+}
+
+template<class _KeyT, class _ValT>
+void csmHashMap<_KeyT, _ValT>::Clear()
+{
+    if (_dummyValuePtr) CSM_DELETE(_dummyValuePtr);
+    _dummyValuePtr = NULL;
+
+    for (csmInt32 i = 0; i < _size; i++)
+    {
+        _keyValues[i].~csmPair<_KeyT, _ValT>();
+    }
+
+    CSM_FREE(_keyValues);
+    CSM_FREE(_slots);
+
+    _keyValues = NULL;
+    _slots = NULL;
+
+    _size = 0;
+    _capacity = 0;
+    _slotCount = 0;
+}
+}}}
+
+//------------------------- LIVE2D NAMESPACE ------------
@@ -166,7 +166,7 @@ public:
      *
      * @return  ハッシュコード
      */
-    csmInt32 GetHashcode();
+    csmInt32 GetHashcode() const;
 
 
 protected:
@@ -94,6 +94,25 @@ public:
      */
     void PushBack(const T& value, csmBool callPlacementNew = true);
 
+    /**
+     * @brief   コンテナの末尾に、引数から直接要素を生成する。
+     *
+     * @param[in]   args    ->  要素のコンストラクタに渡す引数
+     * @return  追加した要素
+     */
+    template<class... Args>
+    T& EmplaceBack(Args&&... args)
+    {
+        if (_size >= _capacity)
+        {
+            PrepareCapacity(_capacity == 0 ? s_defaultSize : _capacity * 2);
+        }
+
+        T* element = CSM_PLACEMENT_NEW(&_ptr[_size]) T(static_cast<Args&&>(args)...);
+        ++_size;
+        return *element;
+    }
+
     /**
      * @brief   コンテナの全要素を解放する
      *
@@ -494,10 +513,27 @@ public:
      * @param[in]   c   ->  csmVector<T>のインスタンス
      */
     csmVector(const csmVector& c)
+        : _inlinePtr(NULL)
+        , _inlineCapacity(0)
     {
         Copy(c);
     }
 
+    /**
+     * @brief   ムーブコンストラクタ
+     *
+     * @param[in]   c   ->  csmVector<T>のインスタンス。空になる
+     */
+    csmVector(csmVector&& c)
+        : _ptr(NULL)
+        , _size(0)
+        , _capacity(0)
+        , _inlinePtr(NULL)
+        , _inlineCapacity(0)
+    {
+        Move(c);
+    }
+
     /**
      * @brief   コピーコンストラクタ
      *
@@ -514,9 +550,50 @@ public:
         return *this;
     }
 
+    /**
+     * @brief   ムーブ代入演算子
+     *
+     * @param[in]   c   ->  csmVector<T>のインスタンス。空になる
+     */
+    csmVector& operator=(csmVector&& c)
+    {
+        if (this != &c)
+        {
+            Clear();
+            Move(c);
+        }
+
+        return *this;
+    }
+
+protected:
+    /**
+     * @brief   内部バッファ付きのコンストラクタ
+     *
+     * 要素数がinlineCapacity以下の間はinlineBufferを使い、ヒープを確保しない。
+     *
+     * @param[in]   inlineBuffer    ->  派生クラスが持つ要素inlineCapacity個分の領域
+     * @param[in]   inlineCapacity  ->  inlineBufferに入る要素数
+     */
+    csmVector(T* inlineBuffer, csmInt32 inlineCapacity)
+        : _ptr(inlineBuffer)
+        , _size(0)
+        , _capacity(inlineCapacity)
+        , _inlinePtr(inlineBuffer)
+        , _inlineCapacity(inlineCapacity)
+    { }
+
 private:
     static const csmInt32 s_defaultSize = 10;   ///< コンテナ初期化のデフォルトサイズ
 
+    /**
+     * @brief   領域がヒープから確保したものかどうか
+     */
+    csmBool IsHeapBuffer(const T* ptr) const
+    {
+        return ptr != NULL && ptr != _inlinePtr;
+    }
+
     /**
      * @brief   csmVector<T>のコピー関数
      *
@@ -525,15 +602,23 @@ private:
     void Copy(const csmVector& c)
     {
         _size = c._size;
-        _capacity = c._capacity;
 
-        if (c._capacity == 0)
+        if (_inlinePtr != NULL && c._size <= _inlineCapacity)
+        {
+            _ptr = _inlinePtr;
+            _capacity = _inlineCapacity;
+        }
+        else if (c._capacity == 0)
         {
             _ptr = NULL;
+            _capacity = 0;
             return;
         }
-
-        _ptr = (T*)CSM_MALLOC(_capacity * sizeof(T));
+        else
+        {
+            _capacity = c._capacity;
+            _ptr = (T*)CSM_MALLOC(_capacity * sizeof(T));
+        }
 
         for (csmInt32 i = 0; i < _size; ++i)
         {
@@ -541,9 +626,114 @@ private:
         }
     }
 
+    /**
+     * @brief   csmVector<T>のムーブ関数
+     *
+     * 空の状態で呼ぶ。ヒープの領域はそのまま引き継ぎ、内部バッファの要素は1つずつムーブする。
+     *
+     * @param[in]   c   ->  csmVector<T>のインスタンス
+     */
+    void Move(csmVector& c)
+    {
+        if (!c.IsHeapBuffer(c._ptr))
+        {
+            PrepareCapacity(c._size);
+
+            for (csmInt32 i = 0; i < c._size; ++i)
+            {
+                CSM_PLACEMENT_NEW(&_ptr[i]) T(static_cast<T&&>(c._ptr[i]));
+            }
+            _size = c._size;
+
+            c.Clear();
+            return;
+        }
+
+        if (IsHeapBuffer(_ptr))
+        {
+            CSM_FREE(_ptr);
+        }
+
+        _ptr = c._ptr;
+        _size = c._size;
+        _capacity = c._capacity;
+
+        c._ptr = c._inlinePtr;
+        c._size = 0;
+        c._capacity = c._inlineCapacity;
+    }
+
     T* _ptr;                ///< コンテナの先頭アドレス（ポインタ）
     csmInt32 _size;         ///< コンテナの要素数（サイズ）
     csmInt32 _capacity;     ///< コンテナのキャパシティ
+    T* _inlinePtr;          ///< 派生クラスが持つ内部バッファ。なければNULL
+    csmInt32 _inlineCapacity;   ///< 内部バッファに入る要素数
+};
+
+/**
+ * @brief   要素数N個までヒープを確保しないベクター型
+ *
+ * 毎フレーム作り直すような小さな配列に使う。N個を超えるとcsmVectorと同じくヒープに移る。
+ */
+template<class T, csmInt32 N>
+class csmSmallVector : public csmVector<T>
+{
+public:
+    /**
+     * @brief   コンストラクタ
+     */
+    csmSmallVector()
+        : csmVector<T>(reinterpret_cast<T*>(_inlineBuffer), N)
+    { }
+
+    /**
+     * @brief   コピーコンストラクタ
+     */
+    csmSmallVector(const csmSmallVector& c)
+        : csmVector<T>(reinterpret_cast<T*>(_inlineBuffer), N)
+    {
+        csmVector<T>::operator=(c);
+    }
+
+    /**
+     * @brief   ムーブコンストラクタ
+     */
+    csmSmallVector(csmSmallVector&& c)
+        : csmVector<T>(reinterpret_cast<T*>(_inlineBuffer), N)
+    {
+        csmVector<T>::operator=(static_cast<csmVector<T>&&>(c));
+    }
+
+    /**
+     * @brief   デストラクタ
+     *
+     * 内部バッファはこのクラスのメンバなので、基底クラスより先に要素を破棄する
+     */
+    virtual ~csmSmallVector()
+    {
+        this->Clear();
+    }
+
+    /**
+     * @brief   代入演算子
+     */
+    csmSmallVector& operator=(const csmSmallVector& c)
+    {
+        csmVector<T>::operator=(c);
+        return *this;
+    }
+
+    /**
+     * @brief   ムーブ代入演算子
+     */
+    csmSmallVector& operator=(csmSmallVector&& c)
+    {
+        csmVector<T>::operator=(static_cast<csmVector<T>&&>(c));
+        return *this;
+    }
+
+private:
+    alignas(T) csmByte _inlineBuffer[sizeof(T) * N];   ///< 要素N個分の内部バッファ
 };
 
 //========================テンプレートの定義==============================
@@ -553,10 +743,14 @@ csmVector<T>::csmVector()
     : _ptr(NULL)
     , _size(0)
     , _capacity(0)
+    , _inlinePtr(NULL)
+    , _inlineCapacity(0)
 { }
 
 template<class T>
 csmVector<T>::csmVector(csmInt32 initialCapacity, csmBool zeroClear)
+    : _inlinePtr(NULL)
+    , _inlineCapacity(0)
 {
     if (initialCapacity < 1)
     {
@@ -622,19 +816,23 @@ void csmVector<T>::PrepareCapacity(csmInt32 newSize)
         {
             csmInt32 tmp_capacity = newSize;
             T* tmp = static_cast<T *>(CSM_MALLOC(sizeof(T) * tmp_capacity));
-            csmInt32 tmp_size = _size;
 
             CSM_ASSERT(tmp != NULL);
 
+            // 要素はコピーせずムーブして移し替える
             for (csmInt32 i = 0; i < _size; i++)
             {
-                CSM_PLACEMENT_NEW(&tmp[i]) T(_ptr[i]);
+                CSM_PLACEMENT_NEW(&tmp[i]) T(static_cast<T&&>(_ptr[i]));
+                _ptr[i].~T();
+            }
+
+            if (IsHeapBuffer(_ptr))
+            {
+                CSM_FREE(_ptr);
             }
-            Clear();
 
             _ptr = tmp;
             _capacity = newSize;
-            _size = tmp_size;
         }
     }
 }
@@ -649,12 +847,16 @@ void csmVector<T>::Clear()
             _ptr[i].~T();
         }
 
-        CSM_FREE(_ptr);
+        if (IsHeapBuffer(_ptr))
+        {
+            CSM_FREE(_ptr);
+        }
     }
 
-    _ptr = NULL;
+    // 内部バッファがあればそこに戻る
+    _ptr = _inlinePtr;
     _size = 0;
-    _capacity = 0;
+    _capacity = _inlineCapacity;
 }
 
 template<class T>
@@ -0,0 +1,147 @@
+﻿/**
+ * Copyright(c) Live2D Inc. All rights reserved.
+ *
+ * Use of this source code is governed by the Live2D Open Software license
+ * that can be found at https://www.live2d.com/eula/live2d-open-software-license-agreement_en.html.
+ */
+
+#pragma once
+
+#include "Framework/Type/csmString.hpp"
+#include "Framework/Type/csmVector.hpp"
+
+//--------- LIVE2D NAMESPACE ------------
+namespace Live2D { namespace Cubism { namespace Framework { namespace Utils {
+
+/**
+ * @brief   バイナリスナップショットの書き込みクラス
+ *
+ * 値をリトルエンディアンのまま順にバッファ末尾へ追記する。
+ */
+class CubismBinaryWriter
+{
+public:
+    /**
+     * @brief   コンストラクタ
+     *
+     * @param[out]  buffer  ->  追記先のバッファ
+     */
+    CubismBinaryWriter(csmVector<csmByte>& buffer);
+
+    /**
+     * @brief   符号なし32bit整数を書き込む
+     *
+     * @param[in]   value   ->  書き込む値
+     */
+    void WriteUint32(csmUint32 value);
+
+    /**
+     * @brief   符号付き32bit整数を書き込む
+     *
+     * @param[in]   value   ->  書き込む値
+     */
+    void WriteInt32(csmInt32 value);
+
+    /**
+     * @brief   浮動小数点数を書き込む
+     *
+     * @param[in]   value   ->  書き込む値
+     */
+    void WriteFloat32(csmFloat32 value);
+
+    /**
+     * @brief   文字列を長さ付きで書き込む
+     *
+     * @param[in]   value   ->  書き込む文字列
+     */
+    void WriteString(const csmString& value);
+
+private:
+    void WriteBytes(const void* bytes, csmSizeType size);
+
+    csmVector<csmByte>& _buffer;  ///< 追記先のバッファ
+};
+
+/**
+ * @brief   バイナリスナップショットの読み込みクラス
+ *
+ * CubismBinaryWriterで書き込んだ順に値を読み出す。
+ * 範囲外を読もうとした時点で無効となり、以降は既定値を返す。
+ */
+class CubismBinaryReader
+{
+public:
+    /**
+     * @brief   コンストラクタ
+     *
+     * @param[in]   data    ->  読み込むバッファ
+     * @param[in]   size    ->  バッファのサイズ
+     */
+    CubismBinaryReader(const csmByte* data, csmSizeInt size);
+
+    /**
+     * @brief   符号なし32bit整数を読み込む
+     *
+     * @return  読み込んだ値。範囲外の場合は0
+     */
+    csmUint32 ReadUint32();
+
+    /**
+     * @brief   符号付き32bit整数を読み込む
+     *
+     * @return  読み込んだ値。範囲外の場合は0
+     */
+    csmInt32 ReadInt32();
+
+    /**
+     * @brief   浮動小数点数を読み込む
+     *
+     * @return  読み込んだ値。範囲外の場合は0
+     */
+    csmFloat32 ReadFloat32();
+
+    /**
+     * @brief   長さ付きの文字列を読み込む
+     *
+     * @return  読み込んだ文字列。範囲外の場合は空文字列
+     */
+    csmString ReadString();
+
+    /**
+     * @brief   要素数を読み込む
+     *
+     * 残りのバイト数で要素を収めきれない値は不正として扱う。
+     *
+     * @param[in]   elementSize ->  1要素が最低限占めるバイト数
+     * @return  読み込んだ要素数。不正な場合は0
+     */
+    csmInt32 ReadCount(csmSizeInt elementSize);
+
+    /**
+     * @brief   ここまでの読み込みがすべて範囲内だったかを返す
+     *
+     * @retval  true    ->  有効
+     * @retval  false   ->  範囲外の読み込みがあった
+     */
+    csmBool IsValid() const;
+
+    /**
+     * @brief   バッファを過不足なく読み終えたかを返す
+     *
+     * @retval  true    ->  有効かつ末尾まで読み終えた
+     * @retval  false   ->  無効、または未読のバイトが残っている
+     */
+    csmBool IsFinished() const;
+
+private:
+    csmBool ReadBytes(void* bytes, csmSizeInt size);
+
+    const csmByte* _data;   ///< 読み込むバッファ
+    csmSizeInt _size;       ///< バッファのサイズ
+    csmSizeInt _position;   ///< 次に読み込む位置
+    csmBool _isValid;       ///< 範囲外の読み込みがなかったか
+};
+
+}}}}
+
+//--------- LIVE2D NAMESPACE ------------
@@ -10,13 +10,18 @@
 #include "Framework/CubismFramework.hpp"
 #include "Framework/Type/csmVector.hpp"
 #include "Framework/Type/csmMap.hpp"
+#include "Framework/Type/csmHashMap.hpp"
 #include "Framework/Type/csmString.hpp"
+#ifdef CSM_JSON_BENCHMARK
+#include <atomic>
+#endif
 
 //------------ LIVE2D NAMESPACE ------------
 namespace Live2D { namespace Cubism { namespace Framework { namespace Utils {
 class Value;
 class Error;
 class NullValue;
+class CubismJsonArena;
 
 #define CSM_JSON_ERROR_TYPE_MISMATCH            "Error:type mismatch"
 #define CSM_JSON_ERROR_INDEX_OUT_OF_BOUNDS      "Error:index out of bounds"
@@ -251,9 +256,12 @@ public:
      *
      * @param   buffer  ->  バイトデータのバッファ
      * @param   size    ->  バッファサイズ
+     * @param   useArena    ->  trueの場合、すべての要素を1つのアリーナに確保し、文字列はbufferを直接参照する。<br>
+     *                          要素は個別に確保されずインスタンスの破棄時にまとめて解放されるが、<br>
+     *                          インスタンスを破棄するまでbufferを保持しておく必要がある
      * @return  CubismJsonクラスのインスタンス。失敗したらNULL。
      */
-    static CubismJson* Create(const csmByte* buffer, csmSizeInt size);
+    static CubismJson* Create(const csmByte* buffer, csmSizeInt size, csmBool useArena = false);
 
     /**
     * @brief   パースしたJSONオブジェクトの解放処理
@@ -263,6 +271,24 @@ public:
     */
     static void Delete(CubismJson* instance);
 
+#ifdef CSM_JSON_BENCHMARK
+    /**
+     * @brief   高速な走査と数値変換を使うかを設定する（ベンチマーク専用）
+     *
+     * falseにすると、空白と文字列を1バイトずつ走査し、数値をすべて strtof で変換する。
+     * パース結果は変わらないので、両者の比較と計測に使う。
+     * CSM_JSON_BENCHMARK を定義したビルドにだけあり、通常のビルドでは常に高速な処理を使う。
+     *
+     * @param[in]   enabled     true 使う（初期値） / false 使わない
+     */
+    static void SetFastPathEnabled(csmBool enabled) { s_fastPathEnabled.store(enabled, std::memory_order_relaxed); }
+
+    /**
+     * @brief   高速な走査と数値変換を使うかを返す（ベンチマーク専用）
+     */
+    static csmBool IsFastPathEnabled() { return s_fastPathEnabled.load(std::memory_order_relaxed); }
+#endif
+
     /**
      * @brief   パースしたJSONのルート要素のポインタを返す
      *
@@ -303,6 +329,20 @@ protected:
      */
     csmString ParseString(const csmChar* string, csmInt32 length, csmInt32 begin, csmInt32* outEndPos);
 
+    /**
+     * @brief   次の「"」までの文字列をアリーナモードでパースする<br>
+     *           エスケープを含まない文字列は元のバッファを指し、含む場合のみアリーナに展開する。
+     *
+     * @param[in]   string  ->  パース対象の文字列
+     * @param[in]   length  ->  パースする長さ
+     * @param[in]   begin   ->  パースを開始する位置
+     * @param[out]  outEndPos   ->  パース終了時の位置
+     * @param[out]  outView     ->  文字列の先頭。NUL終端されているとは限らない
+     * @param[out]  outViewLength   ->  文字列の長さ
+     * @return      パースに成功したらtrue
+     */
+    csmBool ParseStringView(const csmChar* string, csmInt32 length, csmInt32 begin, csmInt32* outEndPos, const csmChar** outView, csmInt32* outViewLength);
+
 
     /**
      * @brief   JSONのオブジェクトエレメントをパースしてValueオブジェクトを返す
@@ -361,6 +401,11 @@ private:
     const csmChar*  _error;         ///< パース時のエラー
     csmInt32        _lineCount;     ///< エラー報告に用いる行数カウント
     Value*          _root;          ///< パースされたルート要素
+    CubismJsonArena* _arena;        ///< アリーナモードで要素を確保するアリーナ。通常モードではNULL
+
+#ifdef CSM_JSON_BENCHMARK
+    static std::atomic<csmBool> s_fastPathEnabled;  ///< 高速な走査と数値変換を使うか（ベンチマーク専用）
+#endif
 };
 
 
@@ -778,6 +823,7 @@ public:
      * @brief    コンストラクタ
      */
     Map() : Value()
+          , _compatibleMap(NULL)
           , _keys(NULL) {}
 
     /**
@@ -795,12 +841,12 @@ public:
      */
     virtual Value& operator[](const csmString& s)
     {
-        Value* ret = _map[s];
-        if (ret == NULL)
+        csmHashMap<csmString, Value*>::const_iterator iter = _map.Find(s);
+        if (iter == _map.End() || iter->Second == NULL)
         {
             return *Value::NullValue;
         }
-        return *ret;
+        return *iter->Second;
     }
 
     /**
@@ -809,19 +855,7 @@ public:
      */
     virtual Value& operator[](const csmChar* s)
     {
-        for (csmMap<csmString, Value*>::const_iterator iter = _map.Begin(); iter != _map.End(); ++iter)
-        {
-            if( strcmp(iter->First.GetRawString(), s) == 0 )
-            {
-                if(iter->Second==NULL)
-                {
-                    return *Value::NullValue;
-                }
-                return *iter->Second;
-            }
-        }
-
-        return *Value::NullValue;
+        return (*this)[csmString(s)];
     }
 
     /**
@@ -835,7 +869,7 @@ public:
     virtual const csmString& GetString(const csmString& defaultValue = "", const csmString& indent = "")
     {
         _stringBuffer = indent + "{\n";
-        csmMap<csmString, Value*>::const_iterator ite = _map.Begin();
+        csmHashMap<csmString, Value*>::const_iterator ite = _map.Begin();
         while (ite != _map.End())
         {
             const csmString& key = (*ite).First;
@@ -850,10 +884,20 @@ public:
 
     /**
      * @brief    要素をMap型で返す
+     *
+     * 検索用のハッシュマップとは別に、呼ばれた時に初めて作る
      */
     virtual csmMap<csmString, Value*>* GetMap(csmMap<csmString, Value*>* defaultValue = NULL)
     {
-        return &_map;
+        if (!_compatibleMap)
+        {
+            _compatibleMap = CSM_NEW csmMap<csmString, Value*>();
+            for (csmHashMap<csmString, Value*>::const_iterator ite = _map.Begin(); ite != _map.End(); ++ite)
+            {
+                (*_compatibleMap)[ite->First] = ite->Second;
+            }
+        }
+        return _compatibleMap;
     }
 
     /**
@@ -872,7 +916,7 @@ public:
         if (!_keys)
         {
             _keys = CSM_NEW csmVector<csmString>();
-            csmMap<csmString, Value*>::const_iterator ite = _map.Begin();
+            csmHashMap<csmString, Value*>::const_iterator ite = _map.Begin();
             while (ite != _map.End())
             {
                 const csmString& key = (*ite).First;
@@ -889,9 +933,53 @@ public:
     virtual csmInt32 GetSize() { return static_cast<csmInt32>(_keys->GetSize()); }
 
 private:
-    csmMap<csmString, Value*> _map;     ///< JSON要素の値
+    csmHashMap<csmString, Value*> _map;     ///< JSON要素の値
+    csmMap<csmString, Value*>* _compatibleMap;  ///< GetMap()用に作ったメンバの複製
     csmVector<csmString>* _keys;        ///< JSON要素の値
 };
+
+/**
+ * @brief   CubismJsonReaderから要素を出現順に受け取るハンドラ
+ *
+ * 各関数がfalseを返すと読み込みを中断する。<br>
+ * キーと文字列はNUL終端されておらず、呼び出し中だけ有効。
+ */
+class CubismJsonHandler
+{
+public:
+    virtual ~CubismJsonHandler() {}
+
+    virtual csmBool OnStartObject() { return true; }
+    virtual csmBool OnEndObject() { return true; }
+    virtual csmBool OnStartArray() { return true; }
+    virtual csmBool OnEndArray() { return true; }
+    virtual csmBool OnKey(const csmChar* key, csmInt32 length) { return true; }
+    virtual csmBool OnString(const csmChar* value, csmInt32 length) { return true; }
+    virtual csmBool OnNumber(csmFloat32 value) { return true; }
+    virtual csmBool OnBoolean(csmBool value) { return true; }
+    virtual csmBool OnNull() { return true; }
+};
+
+/**
+ * @brief   要素の木を作らずにJSONを1回の走査で読むリーダ
+ *
+ * 値は見つかった順にハンドラへ渡されるので、読み込み中のメモリは呼び出し側が作るデータだけで済む。<br>
+ * CubismJsonと異なり、JSONの書式に合わない入力はエラーにする。
+ */
+class CubismJsonReader
+{
+public:
+    /**
+     * @brief   JSONを読んでハンドラに渡す
+     *
+     * @param[in]   buffer  ->  JSONのバイトデータ
+     * @param[in]   size    ->  バッファサイズ
+     * @param[in]   handler ->  要素を受け取るハンドラ
+     * @retval      true    ->  ルート要素を最後まで読んだ
+     * @retval      false   ->  書式の誤りか、ハンドラによる中断
+     */
+    static csmBool Read(const csmByte* buffer, csmSizeInt size, CubismJsonHandler& handler);
+};
 }}}}
 
 //------------ LIVE2D NAMESPACE ------------
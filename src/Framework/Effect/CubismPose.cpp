@@ -7,6 +7,7 @@
 
 #include "Framework/Effect/CubismPose.hpp"
 #include "Framework/Id/CubismIdManager.hpp"
+#include "Framework/Utils/CubismBinaryStream.hpp"
 
 using namespace Live2D::Cubism::Framework;
 
@@ -21,6 +22,10 @@ const csmChar*   FadeIn = "FadeInTime";
 const csmChar*   Link   = "Link";
 const csmChar*   Groups = "Groups";
 const csmChar*   Id     = "Id";
+
+// WriteBinaryで書き出すスナップショットのシグネチャとバージョン
+const csmUint32  PoseBinaryMagic = 0x42334F50; // "PO3B"
+const csmUint32  PoseBinaryVersion = 1;
 }
 
 CubismPose::PartData::PartData()
@@ -70,7 +75,21 @@ CubismPose::~CubismPose()
 
 CubismPose* CubismPose::Create(const csmByte* pose3json, csmSizeInt size)
 {
-    Utils::CubismJson*  json = Utils::CubismJson::Create(pose3json, size);
+    if (IsBinary(pose3json, size))
+    {
+        CubismPose* pose = CSM_NEW CubismPose();
+
+        if (!pose->ParseBinary(pose3json, size))
+        {
+            CubismLogError("Pose snapshot is corrupted.");
+            Delete(pose);
+            return NULL;
+        }
+
+        return pose;
+    }
+
+    Utils::CubismJson*  json = Utils::CubismJson::Create(pose3json, size, true);
     if (!json)
     {
         return NULL;
@@ -143,6 +162,87 @@ void CubismPose::Delete(CubismPose* pose)
     CSM_DELETE_SELF(CubismPose, pose);
 }
 
+csmBool CubismPose::IsBinary(const csmByte* buffer, csmSizeInt size)
+{
+    Utils::CubismBinaryReader reader(buffer, size);
+
+    return reader.ReadUint32() == PoseBinaryMagic && reader.IsValid();
+}
+
+void CubismPose::WriteBinary(csmVector<csmByte>& buffer) const
+{
+    buffer.Clear();
+
+    Utils::CubismBinaryWriter writer(buffer);
+
+    writer.WriteUint32(PoseBinaryMagic);
+    writer.WriteUint32(PoseBinaryVersion);
+    writer.WriteFloat32(_fadeTimeSeconds);
+    writer.WriteInt32(_partGroupCounts.GetSize());
+
+    csmInt32 beginIndex = 0;
+
+    for (csmUint32 i = 0; i < _partGroupCounts.GetSize(); ++i)
+    {
+        writer.WriteInt32(_partGroupCounts[i]);
+
+        for (csmInt32 j = beginIndex; j < beginIndex + _partGroupCounts[i]; ++j)
+        {
+            const PartData& partData = _partGroups[j];
+
+            writer.WriteString(partData.PartId->GetString());
+            writer.WriteInt32(partData.Link.GetSize());
+
+            for (csmUint32 k = 0; k < partData.Link.GetSize(); ++k)
+            {
+                writer.WriteString(partData.Link[k].PartId->GetString());
+            }
+        }
+
+        beginIndex += _partGroupCounts[i];
+    }
+}
+
+csmBool CubismPose::ParseBinary(const csmByte* poseBinary, csmSizeInt size)
+{
+    Utils::CubismBinaryReader reader(poseBinary, size);
+
+    if (reader.ReadUint32() != PoseBinaryMagic || reader.ReadUint32() != PoseBinaryVersion)
+    {
+        return false;
+    }
+
+    _fadeTimeSeconds = reader.ReadFloat32();
+
+    const csmInt32 poseCount = reader.ReadCount(sizeof(csmInt32));
+
+    for (csmInt32 poseIndex = 0; poseIndex < poseCount && reader.IsValid(); ++poseIndex)
+    {
+        const csmInt32 groupCount = reader.ReadCount(sizeof(csmUint32) * 2);
+
+        for (csmInt32 groupIndex = 0; groupIndex < groupCount && reader.IsValid(); ++groupIndex)
+        {
+            PartData partData;
+            partData.PartId = CubismFramework::GetIdManager()->GetId(reader.ReadString());
+
+            const csmInt32 linkCount = reader.ReadCount(sizeof(csmUint32));
+
+            for (csmInt32 linkIndex = 0; linkIndex < linkCount && reader.IsValid(); ++linkIndex)
+            {
+                PartData linkPart;
+                linkPart.PartId = CubismFramework::GetIdManager()->GetId(reader.ReadString());
+                partData.Link.PushBack(linkPart);
+            }
+
+            _partGroups.PushBack(partData);
+        }
+
+        _partGroupCounts.PushBack(groupCount);
+    }
+
+    return reader.IsFinished();
+}
+
 void CubismPose::Reset(CubismModel* model)
 {
     csmInt32 beginIndex = 0;
@@ -11,13 +11,16 @@
 namespace Live2D { namespace Cubism { namespace Framework {
 
 CubismId::CubismId()
+    : _index(-1)
 { }
 
 CubismId::CubismId(const CubismId& c)
                         : _id(c._id)
+                        , _index(c._index)
 { }
 
-CubismId::CubismId(const csmChar* id)
+CubismId::CubismId(const csmChar* id, csmInt32 index)
+    : _index(index)
 {
     _id = id;
 }
@@ -30,6 +33,7 @@ CubismId& CubismId::operator=(const CubismId& c)
     if (this != &c)
     {
         _id = c._id;
+        _index = c._index;
     }
 
     return *this;
@@ -50,4 +54,9 @@ const csmString& CubismId::GetString() const
     return _id;
 }
 
+csmInt32 CubismId::GetIndex() const
+{
+    return _index;
+}
+
 }}}
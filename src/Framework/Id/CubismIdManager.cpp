@@ -7,14 +7,44 @@
 
 #include "Framework/Id/CubismIdManager.hpp"
 #include "Framework/Id/CubismId.hpp"
+#include <string.h>
 
 namespace Live2D { namespace Cubism { namespace Framework {
 
+namespace {
+
+const csmUint32 InitialSlotCount = 256;   ///< テーブルの初期スロット数
+
+/**
+ * @brief ID名のハッシュ値を求める(FNV-1a)
+ */
+csmUint32 HashId(const csmChar* id)
+{
+    csmUint32 hash = 2166136261u;
+    for (const csmChar* c = id; *c != '\0'; ++c)
+    {
+        hash = (hash ^ static_cast<csmUint8>(*c)) * 16777619u;
+    }
+    return hash;
+}
+
+}
+
 CubismIdManager::CubismIdManager()
+    : _table(CreateTable(InitialSlotCount))
 { }
 
 CubismIdManager::~CubismIdManager()
 {
+    IdTable* table = _table.load(std::memory_order_relaxed);
+    while (table != NULL)
+    {
+        IdTable* previous = table->Previous;
+        CSM_FREE(table->Slots);
+        CSM_FREE(table);
+        table = previous;
+    }
+
     for (csmUint32 i = 0; i < _ids.GetSize(); ++i)
     {
         CSM_DELETE_SELF(CubismId, _ids[i]);
@@ -53,20 +83,38 @@ csmBool CubismIdManager::IsExist(const csmString& id) const
 }
 csmBool CubismIdManager::IsExist(const csmChar* id) const
 {
-    return (FindId(id) != NULL);
+    const csmUint32 hash = HashId(id);
+    if (FindId(id, hash) != NULL)
+    {
+        return true;
+    }
+
+    // 拡張前のテーブルを見ていた場合に備え、登録中のスレッドを待ってから探し直す
+    std::lock_guard<std::mutex> lock(_mutex);
+    return (FindId(id, hash) != NULL);
 }
 
 const CubismId* CubismIdManager::RegisterId(const csmChar* id)
 {
+    const csmUint32 hash = HashId(id);
     CubismId* result = NULL;
 
-    if ((result = FindId(id)) != NULL)
+    if ((result = FindId(id, hash)) != NULL)
     {
         return result;
     }
 
-    result = CSM_NEW CubismId(id);
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // ロックを待つ間に他のスレッドが登録しているかもしれない
+    if ((result = FindId(id, hash)) != NULL)
+    {
+        return result;
+    }
+
+    result = CSM_NEW CubismId(id, static_cast<csmInt32>(_ids.GetSize()));
     _ids.PushBack(result);
+    InsertId(result, hash);
 
     return result;
 }
@@ -76,17 +124,81 @@ const CubismId* CubismIdManager::RegisterId(const csmString& id)
     return RegisterId(id.GetRawString());
 }
 
-CubismId* CubismIdManager::FindId(const csmChar* id) const
+CubismId* CubismIdManager::FindId(const csmChar* id, csmUint32 hash) const
 {
-    for (csmUint32 i = 0; i < _ids.GetSize(); ++i)
+    const IdTable* table = _table.load(std::memory_order_acquire);
+
+    for (csmUint32 slot = hash & table->Mask; ; slot = (slot + 1) & table->Mask)
     {
-        if (_ids[i]->GetString() == id)
+        CubismId* found = table->Slots[slot].Id.load(std::memory_order_acquire);
+        if (found == NULL)
         {
-            return _ids[i];
+            return NULL;
         }
+
+        if (table->Slots[slot].Hash == hash && strcmp(found->GetString().GetRawString(), id) == 0)
+        {
+            return found;
+        }
+    }
+}
+
+void CubismIdManager::InsertId(CubismId* id, csmUint32 hash)
+{
+    IdTable* table = _table.load(std::memory_order_relaxed);
+
+    // 負荷率を1/2以下に保つ
+    if (_ids.GetSize() * 2 > table->Mask + 1)
+    {
+        IdTable* grown = CreateTable((table->Mask + 1) * 2);
+        grown->Previous = table;
+
+        for (csmUint32 i = 0; i <= table->Mask; ++i)
+        {
+            CubismId* moved = table->Slots[i].Id.load(std::memory_order_relaxed);
+            if (moved == NULL)
+            {
+                continue;
+            }
+
+            const csmUint32 movedHash = table->Slots[i].Hash;
+            csmUint32 slot = movedHash & grown->Mask;
+            while (grown->Slots[slot].Id.load(std::memory_order_relaxed) != NULL)
+            {
+                slot = (slot + 1) & grown->Mask;
+            }
+            grown->Slots[slot].Hash = movedHash;
+            grown->Slots[slot].Id.store(moved, std::memory_order_relaxed);
+        }
+
+        // 読み手は新しいテーブルを取得した時点で移し替えた要素をすべて見られる
+        _table.store(grown, std::memory_order_release);
+        table = grown;
+    }
+
+    csmUint32 slot = hash & table->Mask;
+    while (table->Slots[slot].Id.load(std::memory_order_relaxed) != NULL)
+    {
+        slot = (slot + 1) & table->Mask;
+    }
+    table->Slots[slot].Hash = hash;
+    table->Slots[slot].Id.store(id, std::memory_order_release);
+}
+
+CubismIdManager::IdTable* CubismIdManager::CreateTable(csmUint32 slotCount)
+{
+    IdTable* table = static_cast<IdTable*>(CSM_MALLOC(sizeof(IdTable)));
+    table->Mask = slotCount - 1;
+    table->Slots = static_cast<IdTable::Slot*>(CSM_MALLOC(sizeof(IdTable::Slot) * slotCount));
+    table->Previous = NULL;
+
+    for (csmUint32 i = 0; i < slotCount; ++i)
+    {
+        CSM_PLACEMENT_NEW(&table->Slots[i].Id) std::atomic<CubismId*>(NULL);
+        table->Slots[i].Hash = 0;
     }
 
-    return NULL;
+    return table;
 }
 
 }}}
@@ -43,6 +43,39 @@ CubismMoc* CubismMoc::Create(const csmByte* mocBytes, csmSizeInt size, csmBool s
     return cubismMoc;
 }
 
+CubismMoc* CubismMoc::Create(csmByte* mocBytes, csmSizeInt size, MocBufferReleaser releaser, void* context, csmBool shouldCheckMocConsistency)
+{
+    if (reinterpret_cast<csmUint64>(mocBytes) % Core::csmAlignofMoc != 0)
+    {
+        // 整列していないバッファは従来通りコピーして復元する
+        CubismMoc* cubismMoc = Create(mocBytes, size, shouldCheckMocConsistency);
+        releaser(mocBytes, context);
+        return cubismMoc;
+    }
+
+    if (shouldCheckMocConsistency && !HasMocConsistency(mocBytes, size))
+    {
+        releaser(mocBytes, context);
+
+        // 整合性が確認できなければ処理しない
+        CubismLogError("Inconsistent MOC3.");
+        return NULL;
+    }
+
+    Core::csmMoc* moc = Core::csmReviveMocInPlace(mocBytes, size);
+    if (!moc)
+    {
+        releaser(mocBytes, context);
+        return NULL;
+    }
+
+    CubismMoc* cubismMoc = CSM_NEW CubismMoc(moc);
+    cubismMoc->_mocVersion = Core::csmGetMocVersion(mocBytes, size);
+    cubismMoc->_releaser = releaser;
+    cubismMoc->_releaserContext = context;
+    return cubismMoc;
+}
+
 void CubismMoc::Delete(CubismMoc* moc)
 {
     CSM_DELETE_SELF(CubismMoc, moc);
@@ -52,13 +85,22 @@ CubismMoc::CubismMoc(Core::csmMoc* moc)
                         : _moc(moc)
                         , _modelCount(0)
                         , _mocVersion(0)
+                        , _releaser(NULL)
+                        , _releaserContext(NULL)
 { }
 
 CubismMoc::~CubismMoc()
 {
     CSM_ASSERT(_modelCount == 0);
 
-    CSM_FREE_ALLIGNED(_moc);
+    if (_releaser)
+    {
+        _releaser(_moc, _releaserContext);
+    }
+    else
+    {
+        CSM_FREE_ALLIGNED(_moc);
+    }
 }
 
 CubismModel* CubismMoc::CreateModel()
@@ -9,14 +9,40 @@
 #include "Framework/Rendering/CubismRenderer.hpp"
 #include "Framework/Id/CubismId.hpp"
 #include "Framework/Id/CubismIdManager.hpp"
+#include <atomic>
 
 namespace Live2D { namespace Cubism { namespace Framework {
 
+static std::atomic<csmUint32> s_totalInstanceNo(0);    ///< 通算のモデルの通し番号。モデルはワーカースレッドでも作られる
+
 static csmInt32 IsBitSet(const csmUint8 byte, const csmUint8 mask)
 {
     return ((byte & mask) == mask);
 }
 
+// IDの通し番号で引くテーブルからインデックスを取得する。未登録なら-1
+static csmInt32 FindIndexInTable(const csmVector<csmInt32>& table, CubismIdHandle id)
+{
+    if (id == NULL || static_cast<csmInt32>(table.GetSize()) <= id->GetIndex())
+    {
+        return -1;
+    }
+    return table[id->GetIndex()];
+}
+
+// IDの通し番号で引くテーブルにインデックスを登録する
+static void SetIndexInTable(csmVector<csmInt32>& table, CubismIdHandle id, csmInt32 index)
+{
+    const csmInt32 size = static_cast<csmInt32>(table.GetSize());
+    if (size <= id->GetIndex())
+    {
+        // IDは通し番号順に登録されることが多いので、確保し直す回数を抑える
+        table.PrepareCapacity(size * 2 > id->GetIndex() + 1 ? size * 2 : id->GetIndex() + 1);
+        table.UpdateSize(id->GetIndex() + 1, -1, false);
+    }
+    table[id->GetIndex()] = index;
+}
+
 CubismModel::CubismModel(Core::csmModel* model)
     : _model(model)
     , _parameterValues(NULL)
@@ -27,6 +53,7 @@ CubismModel::CubismModel(Core::csmModel* model)
     , _isOverwrittenModelScreenColors(false)
     , _isOverwrittenCullings(false)
     , _modelOpacity(1.0f)
+    , _instanceNo(++s_totalInstanceNo)
 { }
 
 CubismModel::~CubismModel()
@@ -93,7 +120,8 @@ void CubismModel::SetPartOpacity(CubismIdHandle partId, csmFloat32 opacity)
 
 void CubismModel::SetPartOpacity(csmInt32 partIndex, csmFloat32 opacity)
 {
-    if (_notExistPartOpacities.IsExist(partIndex))
+    // 存在しないパーツのインデックスはモデルのパーツの後ろに採番されるので、範囲外の時だけ検索する
+    if ((partIndex < 0 || static_cast<csmInt32>(_partIds.GetSize()) <= partIndex) && _notExistPartOpacities.IsExist(partIndex))
     {
         _notExistPartOpacities[partIndex] = opacity;
         return;
@@ -120,7 +148,7 @@ csmFloat32 CubismModel::GetPartOpacity(CubismIdHandle partId)
 
 csmFloat32 CubismModel::GetPartOpacity(csmInt32 partIndex)
 {
-    if (_notExistPartOpacities.IsExist(partIndex))
+    if ((partIndex < 0 || static_cast<csmInt32>(_partIds.GetSize()) <= partIndex) && _notExistPartOpacities.IsExist(partIndex))
     {
         // モデルに存在しないパーツIDの場合、非存在パーツリストから不透明度を返す
         return _notExistPartOpacities[partIndex];
@@ -159,17 +187,10 @@ csmFloat32 CubismModel::GetParameterMinimumValue(csmUint32 parameterIndex) const
 
 csmInt32 CubismModel::GetParameterIndex(CubismIdHandle parameterId)
 {
-    csmInt32            parameterIndex;
-    const csmInt32      idCount = Core::csmGetParameterCount(_model);
-
-
-    for (parameterIndex = 0; parameterIndex < idCount; ++parameterIndex)
+    // モデルのパラメータと、一度引かれた非存在パラメータはテーブルに登録されている
+    csmInt32 parameterIndex = FindIndexInTable(_parameterIndexTable, parameterId);
+    if (parameterIndex >= 0)
     {
-        if (parameterId != _parameterIds[parameterIndex])
-        {
-            continue;
-        }
-
         return parameterIndex;
     }
 
@@ -185,6 +206,11 @@ csmInt32 CubismModel::GetParameterIndex(CubismIdHandle parameterId)
     _notExistParameterId[parameterId] = parameterIndex;
     _notExistParameterValues.AppendKey(parameterIndex);
 
+    if (parameterId != NULL)
+    {
+        SetIndexInTable(_parameterIndexTable, parameterId, parameterIndex);
+    }
+
     return parameterIndex;
 }
 
@@ -196,7 +222,8 @@ CubismIdHandle CubismModel::GetParameterId(csmUint32 parameterIndex)
 
 csmFloat32 CubismModel::GetParameterValue(csmInt32 parameterIndex)
 {
-    if (_notExistParameterValues.IsExist(parameterIndex))
+    // 存在しないパラメータのインデックスはモデルのパラメータの後ろに採番されるので、範囲外の時だけ検索する
+    if ((parameterIndex < 0 || static_cast<csmInt32>(_parameterIds.GetSize()) <= parameterIndex) && _notExistParameterValues.IsExist(parameterIndex))
     {
         return _notExistParameterValues[parameterIndex];
     }
@@ -209,7 +236,7 @@ csmFloat32 CubismModel::GetParameterValue(csmInt32 parameterIndex)
 
 void CubismModel::SetParameterValue(csmInt32 parameterIndex, csmFloat32 value, csmFloat32 weight)
 {
-    if (_notExistParameterValues.IsExist(parameterIndex))
+    if ((parameterIndex < 0 || static_cast<csmInt32>(_parameterIds.GetSize()) <= parameterIndex) && _notExistParameterValues.IsExist(parameterIndex))
     {
         _notExistParameterValues[parameterIndex] = (weight == 1)
                                                          ? value
@@ -337,15 +364,11 @@ const csmFloat32* CubismModel::GetDrawableVertices(csmInt32 drawableIndex) const
 
 csmInt32 CubismModel::GetPartIndex(CubismIdHandle partId)
 {
-    csmInt32            partIndex;
-    const csmInt32      idCount = Core::csmGetPartCount(_model);
-
-    for (partIndex = 0; partIndex < idCount; ++partIndex)
+    // モデルのパーツと、一度引かれた非存在パーツはテーブルに登録されている
+    csmInt32 partIndex = FindIndexInTable(_partIndexTable, partId);
+    if (partIndex >= 0)
     {
-        if (partId == _partIds[partIndex])
-        {
-            return partIndex;
-        }
+        return partIndex;
     }
 
     const csmInt32 partCount = Core::csmGetPartCount(_model);
@@ -362,6 +385,11 @@ csmInt32 CubismModel::GetPartIndex(CubismIdHandle partId)
     _notExistPartId[partId] = partIndex;
     _notExistPartOpacities.AppendKey(partIndex);
 
+    if (partId != NULL)
+    {
+        SetIndexInTable(_partIndexTable, partId, partIndex);
+    }
+
     return partIndex;
 }
 
@@ -382,6 +410,12 @@ void CubismModel::Initialize()
         for (csmInt32 i = 0; i < parameterCount; ++i)
         {
             _parameterIds.PushBack(CubismFramework::GetIdManager()->GetId(parameterIds[i]));
+
+            // 同じIDが複数あれば先に見つかったものを使う
+            if (FindIndexInTable(_parameterIndexTable, _parameterIds[i]) < 0)
+            {
+                SetIndexInTable(_parameterIndexTable, _parameterIds[i], i);
+            }
         }
     }
 
@@ -393,6 +427,11 @@ void CubismModel::Initialize()
         for (csmInt32 i = 0; i < partCount; ++i)
         {
             _partIds.PushBack(CubismFramework::GetIdManager()->GetId(partIds[i]));
+
+            if (FindIndexInTable(_partIndexTable, _partIds[i]) < 0)
+            {
+                SetIndexInTable(_partIndexTable, _partIds[i], i);
+            }
         }
 
         _userPartMultiplyColors.PrepareCapacity(partCount);
@@ -912,6 +951,11 @@ Core::csmModel* CubismModel::GetModel() const
     return _model;
 }
 
+csmUint32 CubismModel::GetInstanceNo() const
+{
+    return _instanceNo;
+}
+
 csmBool CubismModel::IsUsingMasking() const
 {
     for (csmInt32 d = 0; d < Core::csmGetDrawableCount(_model); ++d)
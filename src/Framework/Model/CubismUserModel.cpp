@@ -81,6 +81,18 @@ void CubismUserModel::LoadModel(const csmByte* buffer, csmSizeInt size, csmBool
 {
     _moc = CubismMoc::Create(buffer, size, shouldCheckMocConsistency);
 
+    SetupModelFromMoc();
+}
+
+void CubismUserModel::LoadModel(csmByte* buffer, csmSizeInt size, CubismMoc::MocBufferReleaser releaser, void* context, csmBool shouldCheckMocConsistency)
+{
+    _moc = CubismMoc::Create(buffer, size, releaser, context, shouldCheckMocConsistency);
+
+    SetupModelFromMoc();
+}
+
+void CubismUserModel::SetupModelFromMoc()
+{
     if (_moc == NULL)
     {
         CubismLogError("Failed to CubismMoc::Create().");
@@ -97,7 +109,6 @@ void CubismUserModel::LoadModel(const csmByte* buffer, csmSizeInt size, csmBool
 
     _model->SaveParameters();
     _modelMatrix = CSM_NEW CubismModelMatrix(_model->GetCanvasWidth(), _model->GetCanvasHeight());
-
 }
 
 ACubismMotion* CubismUserModel::LoadExpression(const csmByte* buffer, csmSizeInt size, const csmChar* name)
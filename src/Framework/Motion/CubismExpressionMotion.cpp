@@ -9,6 +9,7 @@
 #include "Framework/Motion/CubismMotionQueueEntry.hpp"
 #include "Framework/Id/CubismIdManager.hpp"
 #include "Framework/Math/CubismMath.hpp"
+#include "Framework/Utils/CubismBinaryStream.hpp"
 
 namespace Live2D { namespace Cubism { namespace Framework {
 
@@ -27,6 +28,10 @@ const csmChar* BlendValueAdd = "Add";
 const csmChar* BlendValueMultiply = "Multiply";
 const csmChar* BlendValueOverwrite = "Overwrite";
 const csmFloat32 DefaultFadeTime = 1.0f;
+
+// WriteBinaryで書き出すスナップショットのシグネチャとバージョン
+const csmUint32 ExpressionBinaryMagic = 0x42335845; // "EX3B"
+const csmUint32 ExpressionBinaryVersion = 1;
 }
 
 
@@ -39,10 +44,50 @@ CubismExpressionMotion::~CubismExpressionMotion()
 CubismExpressionMotion* CubismExpressionMotion::Create(const csmByte* buffer, csmSizeInt size)
 {
     CubismExpressionMotion* expression = CSM_NEW CubismExpressionMotion();
-    expression->Parse(buffer, size);
+
+    if (IsBinary(buffer, size))
+    {
+        if (!expression->ParseBinary(buffer, size))
+        {
+            Delete(expression);
+            return NULL;
+        }
+    }
+    else
+    {
+        expression->Parse(buffer, size);
+    }
+
     return expression;
 }
 
+csmBool CubismExpressionMotion::IsBinary(const csmByte* buffer, csmSizeInt size)
+{
+    Utils::CubismBinaryReader reader(buffer, size);
+
+    return reader.ReadUint32() == ExpressionBinaryMagic && reader.IsValid();
+}
+
+void CubismExpressionMotion::WriteBinary(csmVector<csmByte>& buffer) const
+{
+    buffer.Clear();
+
+    Utils::CubismBinaryWriter writer(buffer);
+
+    writer.WriteUint32(ExpressionBinaryMagic);
+    writer.WriteUint32(ExpressionBinaryVersion);
+    writer.WriteFloat32(_fadeInSeconds);
+    writer.WriteFloat32(_fadeOutSeconds);
+    writer.WriteInt32(_parameters.GetSize());
+
+    for (csmUint32 i = 0; i < _parameters.GetSize(); ++i)
+    {
+        writer.WriteString(_parameters[i].ParameterId->GetString());
+        writer.WriteInt32(_parameters[i].BlendType);
+        writer.WriteFloat32(_parameters[i].Value);
+    }
+}
+
 void CubismExpressionMotion::DoUpdateParameters(CubismModel* model, csmFloat32 userTimeSeconds, csmFloat32 weight, CubismMotionQueueEntry* motionQueueEntry)
 {
     for (csmUint32 i = 0; i < _parameters.GetSize(); ++i)
@@ -100,7 +145,7 @@ void CubismExpressionMotion::CalculateExpressionParameters(CubismModel* model, c
         const csmFloat32 currentParameterValue = expressionParameterValue.OverwriteValue =
             model->GetParameterValue(expressionParameterValue.ParameterId);
 
-        csmVector<ExpressionParameter> expressionParameters = GetExpressionParameters();
+        const csmVector<ExpressionParameter>& expressionParameters = GetExpressionParameters();
         csmInt32 parameterIndex = -1;
         for (csmInt32 j = 0; j < expressionParameters.GetSize(); ++j)
         {
@@ -140,9 +185,9 @@ void CubismExpressionMotion::CalculateExpressionParameters(CubismModel* model, c
         }
 
         // 値を計算
-        csmFloat32 value = expressionParameters.At(parameterIndex).Value;
+        csmFloat32 value = expressionParameters[parameterIndex].Value;
         csmFloat32 newAdditiveValue, newMultiplyValue, newSetValue;
-        switch (expressionParameters.At(parameterIndex).BlendType) {
+        switch (expressionParameters[parameterIndex].BlendType) {
         case Additive:
             newAdditiveValue = value;
             newMultiplyValue = DefaultMultiplyValue;
@@ -175,7 +220,7 @@ void CubismExpressionMotion::CalculateExpressionParameters(CubismModel* model, c
     }
 }
 
-csmVector<CubismExpressionMotion::ExpressionParameter> CubismExpressionMotion::GetExpressionParameters()
+const csmVector<CubismExpressionMotion::ExpressionParameter>& CubismExpressionMotion::GetExpressionParameters() const
 {
     return _parameters;
 }
@@ -191,7 +236,7 @@ csmFloat32 CubismExpressionMotion::GetFadeWeight()
 
 void CubismExpressionMotion::Parse(const csmByte* buffer, csmSizeInt size)
 {
-    Utils::CubismJson* json = Utils::CubismJson::Create(buffer, size);
+    Utils::CubismJson* json = Utils::CubismJson::Create(buffer, size, true);
     if (!json)
     {
         return;
@@ -246,6 +291,49 @@ void CubismExpressionMotion::Parse(const csmByte* buffer, csmSizeInt size)
     Utils::CubismJson::Delete(json);// JSONデータは不要になったら削除する
 }
 
+csmBool CubismExpressionMotion::ParseBinary(const csmByte* expressionBinary, csmSizeInt size)
+{
+    Utils::CubismBinaryReader reader(expressionBinary, size);
+
+    if (reader.ReadUint32() != ExpressionBinaryMagic || reader.ReadUint32() != ExpressionBinaryVersion)
+    {
+        CubismLogError("Unsupported expression snapshot.");
+        return false;
+    }
+
+    SetFadeInTime(reader.ReadFloat32());
+    SetFadeOutTime(reader.ReadFloat32());
+
+    const csmInt32 parameterCount = reader.ReadCount(sizeof(csmUint32) * 3);
+    _parameters.PrepareCapacity(parameterCount);
+
+    for (csmInt32 i = 0; i < parameterCount && reader.IsValid(); ++i)
+    {
+        ExpressionParameter item;
+
+        item.ParameterId = CubismFramework::GetIdManager()->GetId(reader.ReadString());
+        item.BlendType = static_cast<ExpressionBlendType>(reader.ReadInt32());
+        item.Value = reader.ReadFloat32();
+
+        // 仕様にない値は加算モードにすることで復旧する
+        if (item.BlendType != Multiply && item.BlendType != Overwrite)
+        {
+            item.BlendType = Additive;
+        }
+
+        _parameters.PushBack(item);
+    }
+
+    if (!reader.IsFinished())
+    {
+        CubismLogError("Expression snapshot is corrupted.");
+        _parameters.Clear();
+        return false;
+    }
+
+    return true;
+}
+
 csmFloat32 CubismExpressionMotion::CalculateValue(csmFloat32 source, csmFloat32 destination, csmFloat32 fadeWeight)
 {
     return (source * (1.0f - fadeWeight)) + (destination * fadeWeight);
@@ -7,15 +7,28 @@
 
 #include "Framework/Motion/CubismMotion.hpp"
 #include <cfloat>
+#include <cstring>
 #include "Framework/CubismFramework.hpp"
 #include "Framework/Motion/CubismMotionInternal.hpp"
-#include "Framework/Motion/CubismMotionJson.hpp"
+#include "Framework/Utils/CubismJson.hpp"
 #include "Framework/Motion/CubismMotionQueueManager.hpp"
 #include "Framework/Motion/CubismMotionQueueEntry.hpp"
 #include "Framework/Math/CubismMath.hpp"
 #include "Framework/Type/csmVector.hpp"
 #include "Framework/Id/CubismIdManager.hpp"
 
+// カーブの一括評価に使う命令セット。AVXはコンパイラで有効にされている場合だけ使う
+#if defined(__AVX__)
+#define CSM_MOTION_SIMD_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CSM_MOTION_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CSM_MOTION_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
 namespace Live2D { namespace Cubism { namespace Framework {
 
 namespace {
@@ -29,6 +42,9 @@ const csmChar* TargetNamePartOpacity = "PartOpacity";
 // Id
 const csmChar* IdNameOpacity = "Opacity";
 
+//まばたき、リップシンクのうちモーションの適用を検出するためのビット（MaxTargetSize個まで
+const csmInt32 MaxTargetSize = 64;
+
 /**
 * Cubism SDK R2 以前のモーションを再現させるなら true 、アニメータのモーションを正しく再現するなら false 。
 */
@@ -187,42 +203,793 @@ csmFloat32 InverseSteppedEvaluate(const CubismMotionPoint* points, const csmFloa
     return points[1].Value;
 }
 
-csmFloat32 EvaluateCurve(const CubismMotionData* motionData, const csmInt32 index, csmFloat32 time)
+/**
+ * @brief   セグメントの終点（次のセグメントの始点）のインデックスを返す
+ */
+csmInt32 GetSegmentEndPointIndex(const CubismMotionSegment& segment)
 {
-    // Find segment to evaluate.
-    const CubismMotionCurve& curve = motionData->Curves[index];
+    return segment.BasePointIndex + (segment.SegmentType == CubismMotionSegmentType_Bezier ? 3 : 1);
+}
 
-    csmInt32 target = -1;
-    const csmInt32 totalSegmentCount = curve.BaseSegmentIndex + curve.SegmentCount;
-    csmInt32 pointPosition = 0;
-    for (csmInt32 i = curve.BaseSegmentIndex; i < totalSegmentCount; ++i)
+/**
+ * @brief   [begin, end)のうち、終点の時間がtimeより後になる最初のセグメントを二分探索する。なければendを返す
+ */
+csmInt32 FindSegment(const CubismMotionData* motionData, csmInt32 begin, csmInt32 end, csmFloat32 time)
+{
+    while (begin < end)
     {
-        // Get first point of next segment.
-        pointPosition = motionData->Segments[i].BasePointIndex
-            + (motionData->Segments[i].SegmentType == CubismMotionSegmentType_Bezier
-                ? 3
-                : 1);
+        const csmInt32 middle = begin + (end - begin) / 2;
 
+        if (motionData->Points[GetSegmentEndPointIndex(motionData->Segments[middle])].Time > time)
+        {
+            end = middle;
+        }
+        else
+        {
+            begin = middle + 1;
+        }
+    }
+
+    return begin;
+}
 
+/**
+ * @brief   時間timeで評価するセグメントを求める
+ *
+ * segmentCursorには前回評価したセグメントを保持しておく。時間が進む間はそこから数セグメント先までを調べ、
+ * ループやシークで戻った時や大きく飛んだ時は二分探索する。
+ *
+ * @param[in]       motionData      モーションデータ
+ * @param[in]       curve           カーブ。セグメントを1つ以上持つこと
+ * @param[in]       time            時間[秒]
+ * @param[in,out]   segmentCursor   前回評価したセグメントのインデックス。負の値なら先頭から探す
+ * @return  セグメントのインデックス。最後のセグメントより後の時間であればカーブの末尾（BaseSegmentIndex + SegmentCount）
+ */
+csmInt32 FindCurveSegment(const CubismMotionData* motionData, const CubismMotionCurve& curve, csmFloat32 time, csmInt32& segmentCursor)
+{
+    // 前方へ順に調べるセグメント数。超えたら二分探索に切り替える
+    const csmInt32 MaxForwardSteps = 4;
+
+    const csmInt32 baseSegmentIndex = curve.BaseSegmentIndex;
+    const csmInt32 totalSegmentCount = curve.BaseSegmentIndex + curve.SegmentCount;
+
+    csmInt32 target = segmentCursor;
+
+    if (target < baseSegmentIndex || totalSegmentCount < target ||
+        (target > baseSegmentIndex && motionData->Points[GetSegmentEndPointIndex(motionData->Segments[target - 1])].Time > time))
+    {
+        // 初回、または前回より前に戻った
+        target = FindSegment(motionData, baseSegmentIndex, totalSegmentCount, time);
+    }
+    else
+    {
         // Break if time lies within current segment.
-        if (motionData->Points[pointPosition].Time > time)
+        for (csmInt32 step = 0; target < totalSegmentCount; ++step, ++target)
         {
-            target = i;
-            break;
+            if (motionData->Points[GetSegmentEndPointIndex(motionData->Segments[target])].Time > time)
+            {
+                break;
+            }
+
+            if (step >= MaxForwardSteps)
+            {
+                target = FindSegment(motionData, target + 1, totalSegmentCount, time);
+                break;
+            }
         }
     }
 
+    segmentCursor = target;
 
-    if (target == -1)
+    return target;
+}
+
+/**
+ * @brief   カーブを1本評価する
+ *
+ * @param[in]       motionData      モーションデータ
+ * @param[in]       index           カーブのインデックス
+ * @param[in]       time            時間[秒]
+ * @param[in,out]   segmentCursor   前回評価したセグメントのインデックス
+ * @return  カーブの値
+ */
+csmFloat32 EvaluateCurve(const CubismMotionData* motionData, const csmInt32 index, const csmFloat32 time, csmInt32& segmentCursor)
+{
+    const CubismMotionCurve& curve = motionData->Curves[index];
+
+    if (curve.SegmentCount <= 0)
     {
-        return motionData->Points[pointPosition].Value;
+        return motionData->Points[0].Value;
     }
 
+    const csmInt32 target = FindCurveSegment(motionData, curve, time, segmentCursor);
+
+    if (target == curve.BaseSegmentIndex + curve.SegmentCount)
+    {
+        return motionData->Points[GetSegmentEndPointIndex(motionData->Segments[target - 1])].Value;
+    }
 
     const CubismMotionSegment& segment = motionData->Segments[target];
 
-    return segment.Evaluate(&motionData->Points[segment.BasePointIndex], time);
-}
+    return segment.Evaluate(&motionData->Points[segment.BasePointIndex], time);
+}
+
+#if defined(CSM_MOTION_SIMD_AVX)
+typedef __m256 FloatBlock;
+const csmInt32 BlockLanes = 8;
+
+FloatBlock LoadBlock(const csmFloat32* p) { return _mm256_loadu_ps(p); }
+void StoreBlock(csmFloat32* p, FloatBlock a) { _mm256_storeu_ps(p, a); }
+FloatBlock SetBlock(csmFloat32 value) { return _mm256_set1_ps(value); }
+FloatBlock AddBlock(FloatBlock a, FloatBlock b) { return _mm256_add_ps(a, b); }
+FloatBlock SubBlock(FloatBlock a, FloatBlock b) { return _mm256_sub_ps(a, b); }
+FloatBlock MulBlock(FloatBlock a, FloatBlock b) { return _mm256_mul_ps(a, b); }
+FloatBlock DivBlock(FloatBlock a, FloatBlock b) { return _mm256_div_ps(a, b); }
+
+// maxは比較が偽なら第2引数を返すので、スカラー版の if (t < 0.0f) t = 0.0f; と同じ結果になる（-0.0f、NaNも含む）
+FloatBlock ClampNegativeBlock(FloatBlock a) { return _mm256_max_ps(_mm256_setzero_ps(), a); }
+#elif defined(CSM_MOTION_SIMD_SSE2)
+typedef __m128 FloatBlock;
+const csmInt32 BlockLanes = 4;
+
+FloatBlock LoadBlock(const csmFloat32* p) { return _mm_loadu_ps(p); }
+void StoreBlock(csmFloat32* p, FloatBlock a) { _mm_storeu_ps(p, a); }
+FloatBlock SetBlock(csmFloat32 value) { return _mm_set1_ps(value); }
+FloatBlock AddBlock(FloatBlock a, FloatBlock b) { return _mm_add_ps(a, b); }
+FloatBlock SubBlock(FloatBlock a, FloatBlock b) { return _mm_sub_ps(a, b); }
+FloatBlock MulBlock(FloatBlock a, FloatBlock b) { return _mm_mul_ps(a, b); }
+FloatBlock DivBlock(FloatBlock a, FloatBlock b) { return _mm_div_ps(a, b); }
+
+// maxは比較が偽なら第2引数を返すので、スカラー版の if (t < 0.0f) t = 0.0f; と同じ結果になる（-0.0f、NaNも含む）
+FloatBlock ClampNegativeBlock(FloatBlock a) { return _mm_max_ps(_mm_setzero_ps(), a); }
+#elif defined(CSM_MOTION_SIMD_NEON)
+typedef float32x4_t FloatBlock;
+const csmInt32 BlockLanes = 4;
+
+FloatBlock LoadBlock(const csmFloat32* p) { return vld1q_f32(p); }
+void StoreBlock(csmFloat32* p, FloatBlock a) { vst1q_f32(p, a); }
+FloatBlock SetBlock(csmFloat32 value) { return vdupq_n_f32(value); }
+FloatBlock AddBlock(FloatBlock a, FloatBlock b) { return vaddq_f32(a, b); }
+FloatBlock SubBlock(FloatBlock a, FloatBlock b) { return vsubq_f32(a, b); }
+FloatBlock MulBlock(FloatBlock a, FloatBlock b) { return vmulq_f32(a, b); }
+FloatBlock DivBlock(FloatBlock a, FloatBlock b) { return vdivq_f32(a, b); }
+
+// vmaxqは-0.0fと0.0fを区別するため、比較して選ぶ
+FloatBlock ClampNegativeBlock(FloatBlock a)
+{
+    const FloatBlock zero = vdupq_n_f32(0.0f);
+    return vbslq_f32(vcltq_f32(a, zero), zero, a);
+}
+#else
+typedef csmFloat32 FloatBlock;
+const csmInt32 BlockLanes = 1;
+
+FloatBlock LoadBlock(const csmFloat32* p) { return *p; }
+void StoreBlock(csmFloat32* p, FloatBlock a) { *p = a; }
+FloatBlock SetBlock(csmFloat32 value) { return value; }
+FloatBlock AddBlock(FloatBlock a, FloatBlock b) { return a + b; }
+FloatBlock SubBlock(FloatBlock a, FloatBlock b) { return a - b; }
+FloatBlock MulBlock(FloatBlock a, FloatBlock b) { return a * b; }
+FloatBlock DivBlock(FloatBlock a, FloatBlock b) { return a / b; }
+FloatBlock ClampNegativeBlock(FloatBlock a) { return (a < 0.0f) ? 0.0f : a; }
+#endif
+
+/**
+ * @brief   LerpPoints()の値の成分と同じ演算を行う
+ */
+FloatBlock LerpBlock(FloatBlock a, FloatBlock b, FloatBlock t)
+{
+    return AddBlock(a, MulBlock(SubBlock(b, a), t));
+}
+
+/**
+ * @brief   4点のベジェをde Casteljauのアルゴリズムで評価する。BezierEvaluate()の値の成分と同じ演算を行う
+ */
+FloatBlock DeCasteljauBlock(FloatBlock v0, FloatBlock v1, FloatBlock v2, FloatBlock v3, FloatBlock t)
+{
+    const FloatBlock v01 = LerpBlock(v0, v1, t);
+    const FloatBlock v12 = LerpBlock(v1, v2, t);
+    const FloatBlock v23 = LerpBlock(v2, v3, t);
+
+    const FloatBlock v012 = LerpBlock(v01, v12, t);
+    const FloatBlock v123 = LerpBlock(v12, v23, t);
+
+    return LerpBlock(v012, v123, t);
+}
+
+/**
+ * @brief   バッチの配列をcapacity個に揃える
+ */
+void ResizeSegmentBatch(CubismMotionSegmentBatch& batch, csmInt32 capacity)
+{
+    batch.CurveIndices.UpdateSize(capacity, 0, false);
+
+    for (csmInt32 i = 0; i < 4; ++i)
+    {
+        batch.Times[i].UpdateSize(capacity, 0.0f, false);
+        batch.Values[i].UpdateSize(capacity, 0.0f, false);
+    }
+
+    batch.Results.UpdateSize(capacity, 0.0f, false);
+}
+
+/**
+ * @brief   セグメントをバッチに加える
+ */
+void AppendSegment(CubismMotionSegmentBatch& batch, csmInt32 curveIndex, const CubismMotionPoint* points, csmInt32 pointCount)
+{
+    const csmInt32 i = batch.Count++;
+
+    batch.CurveIndices[i] = curveIndex;
+
+    for (csmInt32 p = 0; p < pointCount; ++p)
+    {
+        batch.Times[p][i] = points[p].Time;
+        batch.Values[p][i] = points[p].Value;
+    }
+}
+
+/**
+ * @brief   SIMDの幅に満たない末尾を最後のセグメントの複製で埋め、ブロック数を返す
+ */
+csmInt32 PadSegmentBatch(CubismMotionSegmentBatch& batch)
+{
+    const csmInt32 paddedCount = (batch.Count + BlockLanes - 1) / BlockLanes * BlockLanes;
+
+    for (csmInt32 i = batch.Count; i < paddedCount; ++i)
+    {
+        for (csmInt32 p = 0; p < 4; ++p)
+        {
+            batch.Times[p][i] = batch.Times[p][batch.Count - 1];
+            batch.Values[p][i] = batch.Values[p][batch.Count - 1];
+        }
+    }
+
+    return paddedCount / BlockLanes;
+}
+
+/**
+ * @brief   評価結果をカーブごとの配列に書き戻す
+ */
+void ScatterSegmentBatch(const CubismMotionSegmentBatch& batch, csmFloat32* curveValues)
+{
+    for (csmInt32 i = 0; i < batch.Count; ++i)
+    {
+        curveValues[batch.CurveIndices[i]] = batch.Results[i];
+    }
+}
+
+/**
+ * @brief   線形のセグメントをまとめて評価する。LinearEvaluate()と同じ結果になる
+ */
+void EvaluateLinearSegments(CubismMotionSegmentBatch& batch, csmFloat32 time)
+{
+    const csmInt32 blockCount = PadSegmentBatch(batch);
+    const FloatBlock x = SetBlock(time);
+
+    for (csmInt32 b = 0, i = 0; b < blockCount; ++b, i += BlockLanes)
+    {
+        const FloatBlock t0 = LoadBlock(&batch.Times[0][i]);
+        const FloatBlock t1 = LoadBlock(&batch.Times[1][i]);
+
+        const FloatBlock t = ClampNegativeBlock(DivBlock(SubBlock(x, t0), SubBlock(t1, t0)));
+
+        StoreBlock(&batch.Results[i], LerpBlock(LoadBlock(&batch.Values[0][i]), LoadBlock(&batch.Values[1][i]), t));
+    }
+}
+
+/**
+ * @brief   ハンドルが制限されたベジェのセグメントをまとめて評価する。BezierEvaluate()と同じ結果になる
+ */
+void EvaluateBezierSegments(CubismMotionSegmentBatch& batch, csmFloat32 time)
+{
+    const csmInt32 blockCount = PadSegmentBatch(batch);
+    const FloatBlock x = SetBlock(time);
+
+    for (csmInt32 b = 0, i = 0; b < blockCount; ++b, i += BlockLanes)
+    {
+        const FloatBlock t0 = LoadBlock(&batch.Times[0][i]);
+        const FloatBlock t3 = LoadBlock(&batch.Times[3][i]);
+
+        const FloatBlock t = ClampNegativeBlock(DivBlock(SubBlock(x, t0), SubBlock(t3, t0)));
+
+        StoreBlock(&batch.Results[i], DeCasteljauBlock(LoadBlock(&batch.Values[0][i]), LoadBlock(&batch.Values[1][i]),
+                                                       LoadBlock(&batch.Values[2][i]), LoadBlock(&batch.Values[3][i]), t));
+    }
+}
+
+/**
+ * @brief   カルダノの公式で解くベジェのセグメントをまとめて評価する。BezierEvaluateCardanoInterpretation()と同じ結果になる
+ *
+ * 3次方程式の係数とde Casteljauの評価はSIMDで行い、解の公式は分岐と超越関数が多いためレーンごとにCubismMathで求める。
+ */
+void EvaluateCardanoSegments(CubismMotionSegmentBatch& batch, csmFloat32 time)
+{
+    const csmInt32 blockCount = PadSegmentBatch(batch);
+    const FloatBlock x = SetBlock(time);
+    const FloatBlock three = SetBlock(3.0f);
+    const FloatBlock six = SetBlock(6.0f);
+
+    csmFloat32 a[BlockLanes];
+    csmFloat32 b[BlockLanes];
+    csmFloat32 c[BlockLanes];
+    csmFloat32 d[BlockLanes];
+    csmFloat32 t[BlockLanes];
+
+    for (csmInt32 block = 0, i = 0; block < blockCount; ++block, i += BlockLanes)
+    {
+        const FloatBlock x1 = LoadBlock(&batch.Times[0][i]);
+        const FloatBlock cx1 = LoadBlock(&batch.Times[1][i]);
+        const FloatBlock cx2 = LoadBlock(&batch.Times[2][i]);
+        const FloatBlock x2 = LoadBlock(&batch.Times[3][i]);
+
+        // a = x2 - 3.0f * cx2 + 3.0f * cx1 - x1
+        StoreBlock(a, SubBlock(AddBlock(SubBlock(x2, MulBlock(three, cx2)), MulBlock(three, cx1)), x1));
+        // b = 3.0f * cx2 - 6.0f * cx1 + 3.0f * x1
+        StoreBlock(b, AddBlock(SubBlock(MulBlock(three, cx2), MulBlock(six, cx1)), MulBlock(three, x1)));
+        // c = 3.0f * cx1 - 3.0f * x1
+        StoreBlock(c, SubBlock(MulBlock(three, cx1), MulBlock(three, x1)));
+        // d = x1 - x
+        StoreBlock(d, SubBlock(x1, x));
+
+        for (csmInt32 lane = 0; lane < BlockLanes; ++lane)
+        {
+            t[lane] = CubismMath::CardanoAlgorithmForBezier(a[lane], b[lane], c[lane], d[lane]);
+        }
+
+        StoreBlock(&batch.Results[i], DeCasteljauBlock(LoadBlock(&batch.Values[0][i]), LoadBlock(&batch.Values[1][i]),
+                                                       LoadBlock(&batch.Values[2][i]), LoadBlock(&batch.Values[3][i]), LoadBlock(t)));
+    }
+}
+
+csmUint32 AppendBinaryString(csmVector<csmByte>& pool, const csmChar* value)
+{
+    const csmUint32 offset = static_cast<csmUint32>(pool.GetSize());
+
+    for (; *value != '\0'; ++value)
+    {
+        pool.PushBack(static_cast<csmByte>(*value));
+    }
+
+    pool.PushBack('\0');
+
+    return offset;
+}
+
+void AppendBinaryBytes(csmVector<csmByte>& buffer, const void* bytes, csmSizeType size)
+{
+    const csmInt32 offset = buffer.GetSize();
+
+    buffer.UpdateSize(offset + static_cast<csmInt32>(size), 0, false);
+
+    if (size > 0)
+    {
+        memcpy(buffer.GetPtr() + offset, bytes, size);
+    }
+}
+
+/**
+ * @brief   motion3.jsonの要素を受け取り、CubismMotionDataを直接組み立てるハンドラ
+ *
+ * 要素の木を作らないので、読み込み中に確保されるのは最終的なモーションデータだけになる。<br>
+ * 各配列はMetaの総数で確保しておき、Metaが後に現れたり総数が誤っていても読んだ分だけ伸ばす。
+ */
+class MotionJsonHandler : public Utils::CubismJsonHandler
+{
+public:
+    MotionJsonHandler(CubismMotionData* motionData, csmSizeInt sourceSize)
+        : FadeInSeconds(1.0f)
+        , FadeOutSeconds(1.0f)
+        , AreBeziersRestricted(false)
+        , _motionData(motionData)
+        , _scope(Scope_Document)
+        , _field(Field_None)
+        , _skipDepth(0)
+        , _segmentValueCount(0)
+        , _segmentValueTotal(0)
+        , _error(NULL)
+        , _sourceSize(sourceSize)
+    { }
+
+    /**
+     * @brief   読み込み中に見つかったデータの誤り。なければNULL
+     */
+    const csmChar* GetError() const { return _error; }
+
+    virtual csmBool OnStartObject()
+    {
+        if (_skipDepth > 0 || _field == Field_Skip)
+        {
+            return Skip();
+        }
+
+        switch (_scope)
+        {
+        case Scope_Document:
+            _scope = Scope_Root;
+            return true;
+        case Scope_Root:
+            if (_field != Field_Meta) return Skip();
+            _scope = Scope_Meta;
+            return true;
+        case Scope_Curves: {
+            CubismMotionCurve curve;
+            curve.BaseSegmentIndex = _motionData->Segments.GetSize();
+            curve.FadeInTime = -1.0f;
+            curve.FadeOutTime = -1.0f;
+            _motionData->Curves.PushBack(curve);
+            _scope = Scope_Curve;
+            return true;
+        }
+        case Scope_UserData:
+            _motionData->Events.PushBack(CubismMotionEvent());
+            _scope = Scope_Event;
+            return true;
+        default:
+            return Skip();
+        }
+    }
+
+    virtual csmBool OnEndObject()
+    {
+        if (_skipDepth > 0)
+        {
+            --_skipDepth;
+            return true;
+        }
+
+        switch (_scope)
+        {
+        case Scope_Meta: _scope = Scope_Root; break;
+        case Scope_Curve: _scope = Scope_Curves; break;
+        case Scope_Event: _scope = Scope_UserData; break;
+        default: _scope = Scope_Document; break;
+        }
+        _field = Field_None;
+        return true;
+    }
+
+    virtual csmBool OnStartArray()
+    {
+        if (_skipDepth > 0)
+        {
+            return Skip();
+        }
+
+        if (_scope == Scope_Root && _field == Field_Curves)
+        {
+            _scope = Scope_Curves;
+        }
+        else if (_scope == Scope_Root && _field == Field_UserData)
+        {
+            _scope = Scope_UserData;
+        }
+        else if (_scope == Scope_Curve && _field == Field_Segments)
+        {
+            _scope = Scope_Segments;
+            _segmentValueCount = 0;
+            _segmentValueTotal = 2; // 最初の制御点
+        }
+        else
+        {
+            return Skip();
+        }
+        return true;
+    }
+
+    virtual csmBool OnEndArray()
+    {
+        if (_skipDepth > 0)
+        {
+            --_skipDepth;
+            return true;
+        }
+
+        if (_scope == Scope_Segments)
+        {
+            if (_segmentValueCount != 0)
+            {
+                return Fail("The segments of a curve end in the middle of a segment.");
+            }
+            _scope = Scope_Curve;
+        }
+        else
+        {
+            _scope = Scope_Root;
+        }
+        _field = Field_None;
+        return true;
+    }
+
+    virtual csmBool OnKey(const csmChar* key, csmInt32 length)
+    {
+        if (_skipDepth > 0)
+        {
+            return true;
+        }
+
+        _field = Field_Skip;
+
+        for (csmInt32 i = 0; i < FieldCount; ++i)
+        {
+            if (Fields[i].ParentScope == _scope && Equals(key, length, Fields[i].Key))
+            {
+                _field = Fields[i].KeyField;
+                break;
+            }
+        }
+        return true;
+    }
+
+    virtual csmBool OnString(const csmChar* value, csmInt32 length)
+    {
+        if (_skipDepth > 0)
+        {
+            return true;
+        }
+
+        switch (_field)
+        {
+        case Field_Target: {
+            CubismMotionCurve& curve = _motionData->Curves[_motionData->Curves.GetSize() - 1];
+            if (Equals(value, length, TargetNameModel))
+            {
+                curve.Type = CubismMotionCurveTarget_Model;
+            }
+            else if (Equals(value, length, TargetNameParameter))
+            {
+                curve.Type = CubismMotionCurveTarget_Parameter;
+            }
+            else if (Equals(value, length, TargetNamePartOpacity))
+            {
+                curve.Type = CubismMotionCurveTarget_PartOpacity;
+            }
+            else
+            {
+                CubismLogWarning("Warning : Unable to get segment type from Curve! The number of \"CurveCount\" may be incorrect!");
+            }
+            break;
+        }
+        case Field_Id:
+            _motionData->Curves[_motionData->Curves.GetSize() - 1].Id = CubismFramework::GetIdManager()->GetId(csmString(value, length));
+            break;
+        case Field_Value:
+            _motionData->Events[_motionData->Events.GetSize() - 1].Value = csmString(value, length);
+            break;
+        default:
+            break;
+        }
+        return true;
+    }
+
+    virtual csmBool OnNumber(csmFloat32 value)
+    {
+        if (_skipDepth > 0)
+        {
+            return true;
+        }
+
+        if (_scope == Scope_Segments)
+        {
+            return AddSegmentValue(value);
+        }
+
+        switch (_field)
+        {
+        case Field_Duration: _motionData->Duration = value; break;
+        case Field_Fps: _motionData->Fps = value; break;
+        case Field_MetaFadeInTime: FadeInSeconds = value < 0.0f ? 1.0f : value; break;
+        case Field_MetaFadeOutTime: FadeOutSeconds = value < 0.0f ? 1.0f : value; break;
+        case Field_CurveCount: Reserve(_motionData->Curves, value); break;
+        case Field_TotalSegmentCount: Reserve(_motionData->Segments, value); break;
+        case Field_TotalPointCount: Reserve(_motionData->Points, value); break;
+        case Field_UserDataCount: Reserve(_motionData->Events, value); break;
+        case Field_CurveFadeInTime: _motionData->Curves[_motionData->Curves.GetSize() - 1].FadeInTime = value; break;
+        case Field_CurveFadeOutTime: _motionData->Curves[_motionData->Curves.GetSize() - 1].FadeOutTime = value; break;
+        case Field_Time: _motionData->Events[_motionData->Events.GetSize() - 1].FireTime = value; break;
+        default: break;
+        }
+        return true;
+    }
+
+    virtual csmBool OnBoolean(csmBool value)
+    {
+        if (_skipDepth > 0)
+        {
+            return true;
+        }
+
+        if (_field == Field_Loop)
+        {
+            _motionData->Loop = value;
+        }
+        else if (_field == Field_AreBeziersRestricted)
+        {
+            AreBeziersRestricted = value;
+        }
+        return true;
+    }
+
+    csmFloat32 FadeInSeconds;       ///< モーション全体のフェードイン時間[秒]
+    csmFloat32 FadeOutSeconds;      ///< モーション全体のフェードアウト時間[秒]
+    csmBool AreBeziersRestricted;   ///< ベジェの制御点が区間内に制限されているか
+
+private:
+    enum Scope
+    {
+        Scope_Document,
+        Scope_Root,
+        Scope_Meta,
+        Scope_Curves,
+        Scope_Curve,
+        Scope_Segments,
+        Scope_UserData,
+        Scope_Event
+    };
+
+    enum Field
+    {
+        Field_None,
+        Field_Skip,
+        Field_Meta,
+        Field_Curves,
+        Field_UserData,
+        Field_Duration,
+        Field_Fps,
+        Field_Loop,
+        Field_AreBeziersRestricted,
+        Field_CurveCount,
+        Field_TotalSegmentCount,
+        Field_TotalPointCount,
+        Field_UserDataCount,
+        Field_MetaFadeInTime,
+        Field_MetaFadeOutTime,
+        Field_Target,
+        Field_Id,
+        Field_CurveFadeInTime,
+        Field_CurveFadeOutTime,
+        Field_Segments,
+        Field_Time,
+        Field_Value
+    };
+
+    struct FieldEntry
+    {
+        Scope ParentScope;
+        const csmChar* Key;
+        Field KeyField;
+    };
+
+    static const FieldEntry Fields[];
+    static const csmInt32 FieldCount;
+
+    static csmBool Equals(const csmChar* value, csmInt32 length, const csmChar* name)
+    {
+        return strlen(name) == static_cast<csmSizeType>(length) && memcmp(value, name, length) == 0;
+    }
+
+    /**
+     * @brief   使わない要素の中を読み飛ばす
+     */
+    csmBool Skip()
+    {
+        ++_skipDepth;
+        return true;
+    }
+
+    csmBool Fail(const csmChar* error)
+    {
+        _error = error;
+        return false;
+    }
+
+    /**
+     * @brief   Metaの総数で配列を確保する。壊れた総数で過大に確保しないよう、元のバイト数で抑える
+     */
+    template<class T>
+    void Reserve(csmVector<T>& items, csmFloat32 count)
+    {
+        const csmFloat32 limit = static_cast<csmFloat32>(_sourceSize / 4);
+        if (count > 0.0f)
+        {
+            items.PrepareCapacity(static_cast<csmInt32>(count < limit ? count : limit));
+        }
+    }
+
+    /**
+     * @brief   Segmentsの数値を1つ受け取り、セグメントがそろったら制御点とともに追加する
+     *
+     * Segmentsは最初の制御点（時間、値）に続き、種類と追加の制御点の組が並ぶ。
+     */
+    csmBool AddSegmentValue(csmFloat32 value)
+    {
+        if (_segmentValueCount == 0 && _segmentValueTotal == 0)
+        {
+            // 種類で後に続く数値の個数が決まる
+            switch (static_cast<csmInt32>(value))
+            {
+            case CubismMotionSegmentType_Linear:
+            case CubismMotionSegmentType_Stepped:
+            case CubismMotionSegmentType_InverseStepped:
+                _segmentValueTotal = 3;
+                break;
+            case CubismMotionSegmentType_Bezier:
+                _segmentValueTotal = 7;
+                break;
+            default:
+                return Fail("Unknown segment type.");
+            }
+        }
+
+        _segmentValues[_segmentValueCount++] = value;
+        if (_segmentValueCount < _segmentValueTotal)
+        {
+            return true;
+        }
+
+        CubismMotionCurve& curve = _motionData->Curves[_motionData->Curves.GetSize() - 1];
+        csmVector<CubismMotionPoint>& points = _motionData->Points;
+        csmInt32 valueIndex = 0;
+
+        // 最初の制御点以外はセグメントを伴う
+        if (_segmentValueTotal != 2)
+        {
+            CubismMotionSegment segment;
+            segment.SegmentType = static_cast<csmInt32>(_segmentValues[0]);
+            segment.BasePointIndex = points.GetSize() - 1;
+            _motionData->Segments.PushBack(segment, false);
+            ++curve.SegmentCount;
+            valueIndex = 1;
+        }
+
+        for (; valueIndex < _segmentValueTotal; valueIndex += 2)
+        {
+            CubismMotionPoint point;
+            point.Time = _segmentValues[valueIndex];
+            point.Value = _segmentValues[valueIndex + 1];
+            points.PushBack(point, false);
+        }
+
+        _segmentValueCount = 0;
+        _segmentValueTotal = 0;
+        return true;
+    }
+
+    CubismMotionData* _motionData;          ///< 組み立て中のモーションデータ
+    Scope _scope;                           ///< 現在の要素
+    Field _field;                           ///< 直前のキー
+    csmInt32 _skipDepth;                    ///< 読み飛ばしている要素の深さ
+    csmFloat32 _segmentValues[7];           ///< そろっていないセグメントの数値
+    csmInt32 _segmentValueCount;            ///< _segmentValuesに受け取った数
+    csmInt32 _segmentValueTotal;            ///< セグメントの数値の個数。0なら次は種類
+    const csmChar* _error;                  ///< データの誤り
+    csmSizeInt _sourceSize;                 ///< motion3.jsonのバイト数
+};
+
+const MotionJsonHandler::FieldEntry MotionJsonHandler::Fields[] = {
+    { Scope_Root, "Meta", Field_Meta },
+    { Scope_Root, "Curves", Field_Curves },
+    { Scope_Root, "UserData", Field_UserData },
+    { Scope_Meta, "Duration", Field_Duration },
+    { Scope_Meta, "Fps", Field_Fps },
+    { Scope_Meta, "Loop", Field_Loop },
+    { Scope_Meta, "AreBeziersRestricted", Field_AreBeziersRestricted },
+    { Scope_Meta, "CurveCount", Field_CurveCount },
+    { Scope_Meta, "TotalSegmentCount", Field_TotalSegmentCount },
+    { Scope_Meta, "TotalPointCount", Field_TotalPointCount },
+    { Scope_Meta, "UserDataCount", Field_UserDataCount },
+    { Scope_Meta, "FadeInTime", Field_MetaFadeInTime },
+    { Scope_Meta, "FadeOutTime", Field_MetaFadeOutTime },
+    { Scope_Curve, "Target", Field_Target },
+    { Scope_Curve, "Id", Field_Id },
+    { Scope_Curve, "FadeInTime", Field_CurveFadeInTime },
+    { Scope_Curve, "FadeOutTime", Field_CurveFadeOutTime },
+    { Scope_Curve, "Segments", Field_Segments },
+    { Scope_Event, "Time", Field_Time },
+    { Scope_Event, "Value", Field_Value },
+};
+
+const csmInt32 MotionJsonHandler::FieldCount = sizeof(MotionJsonHandler::Fields) / sizeof(MotionJsonHandler::Fields[0]);
 
 }
 
@@ -233,22 +1000,44 @@ CubismMotion::CubismMotion()
     , _isLoopFadeIn(true)           // ループ時にフェードインが有効かどうかのフラグ
     , _lastWeight(0.0f)
     , _motionData(NULL)
+    , _isMotionDataShared(false)
     , _modelCurveIdEyeBlink(NULL)
     , _modelCurveIdLipSync(NULL)
     , _modelCurveIdOpacity(NULL)
     , _modelOpacity(1.0f)
+    , _batchedCurveEvaluation(false)
+    , _curveBatch(NULL)
 { }
 
 CubismMotion::~CubismMotion()
 {
-    CSM_DELETE(_motionData);
+    ClearModelBindings();
+
+    CSM_DELETE(_curveBatch);
+
+    if (!_isMotionDataShared)
+    {
+        CSM_DELETE(_motionData);
+    }
 }
 
 CubismMotion* CubismMotion::Create(const csmByte* buffer, csmSizeInt size, FinishedMotionCallback onFinishedMotionHandler)
 {
     CubismMotion* ret = CSM_NEW CubismMotion();
 
-    ret->Parse(buffer, size);
+    if (IsBinary(buffer, size))
+    {
+        if (!ret->ParseBinary(buffer, size))
+        {
+            Delete(ret);
+            return NULL;
+        }
+    }
+    else
+    {
+        ret->Parse(buffer, size);
+    }
+
     ret->_sourceFrameRate = ret->_motionData->Fps;
     ret->_loopDurationSeconds = ret->_motionData->Duration;
     ret->_onFinishedMotion = onFinishedMotionHandler;
@@ -259,6 +1048,22 @@ CubismMotion* CubismMotion::Create(const csmByte* buffer, csmSizeInt size, Finis
     return ret;
 }
 
+CubismMotion* CubismMotion::Create(const CubismMotion* source, FinishedMotionCallback onFinishedMotionHandler)
+{
+    CubismMotion* ret = CSM_NEW CubismMotion();
+
+    ret->_motionData = source->_motionData;
+    ret->_isMotionDataShared = true;
+    ret->_sourceFrameRate = source->_sourceFrameRate;
+    ret->_loopDurationSeconds = source->_loopDurationSeconds;
+    ret->_onFinishedMotion = onFinishedMotionHandler;
+    ret->_batchedCurveEvaluation = source->_batchedCurveEvaluation;
+    ret->SetFadeInTime(source->GetFadeInTime());
+    ret->SetFadeOutTime(source->GetFadeOutTime());
+
+    return ret;
+}
+
 csmFloat32 CubismMotion::GetDuration()
 {
     return _isLoop ? -1.0f : _loopDurationSeconds;
@@ -291,8 +1096,6 @@ void CubismMotion::DoUpdateParameters(CubismModel* model, csmFloat32 userTimeSec
     csmFloat32 lipSyncValue = FLT_MAX;
     csmFloat32 eyeBlinkValue = FLT_MAX;
 
-    //まばたき、リップシンクのうちモーションの適用を検出するためのビット（maxFlagCount個まで
-    const csmInt32 MaxTargetSize = 64;
     csmUint64 lipSyncFlags = 0ULL;
     csmUint64 eyeBlinkFlags = 0ULL;
 
@@ -329,12 +1132,28 @@ void CubismMotion::DoUpdateParameters(CubismModel* model, csmFloat32 userTimeSec
     }
 
     csmVector<CubismMotionCurve>& curves = _motionData->Curves;
+    const ModelBinding* binding = BindModel(model);
+
+    // 前回評価したセグメントから探し始める
+    csmVector<csmInt32>& segmentCursors = motionQueueEntry->_segmentCursors;
+    if (static_cast<csmInt32>(segmentCursors.GetSize()) != _motionData->CurveCount)
+    {
+        segmentCursors.UpdateSize(_motionData->CurveCount, -1, false);
+    }
+
+    // まとめて評価する設定なら、更新に使うカーブを先に評価しておく
+    const csmFloat32* curveValues = NULL;
+    if (_batchedCurveEvaluation)
+    {
+        EvaluateCurves(binding, time, segmentCursors.GetPtr());
+        curveValues = _curveBatch->CurveValues.GetPtr();
+    }
 
     // Evaluate model curves.
     for (c = 0; c < _motionData->CurveCount && curves[c].Type == CubismMotionCurveTarget_Model; ++c)
     {
         // Evaluate curve and call handler.
-        value = EvaluateCurve(_motionData, c, time);
+        value = curveValues ? curveValues[c] : EvaluateCurve(_motionData, c, time, segmentCursors[c]);
 
         if (curves[c].Id == _modelCurveIdEyeBlink)
         {
@@ -360,7 +1179,8 @@ void CubismMotion::DoUpdateParameters(CubismModel* model, csmFloat32 userTimeSec
         parameterMotionCurveCount++;
 
         // Find parameter index.
-        parameterIndex = model->GetParameterIndex(curves[c].Id);
+        const CurveBinding& curveBinding = binding->Curves[c];
+        parameterIndex = curveBinding.ParameterIndex;
 
         // Skip curve evaluation if no value in sink.
         if (parameterIndex == -1)
@@ -371,32 +1191,18 @@ void CubismMotion::DoUpdateParameters(CubismModel* model, csmFloat32 userTimeSec
         const csmFloat32 sourceValue = model->GetParameterValue(parameterIndex);
 
         // Evaluate curve and apply value.
-        value = EvaluateCurve(_motionData, c, time);
+        value = curveValues ? curveValues[c] : EvaluateCurve(_motionData, c, time, segmentCursors[c]);
 
-        if (eyeBlinkValue != FLT_MAX)
+        if (eyeBlinkValue != FLT_MAX && curveBinding.EyeBlinkFlag != 0ULL)
         {
-            for (csmUint32 i = 0; i < _eyeBlinkParameterIds.GetSize() && i < MaxTargetSize; ++i)
-            {
-                if (_eyeBlinkParameterIds[i] == curves[c].Id)
-                {
-                    value *= eyeBlinkValue;
-                    eyeBlinkFlags |= 1ULL << i;
-                    break;
-                }
-            }
+            value *= eyeBlinkValue;
+            eyeBlinkFlags |= curveBinding.EyeBlinkFlag;
         }
 
-        if (lipSyncValue != FLT_MAX)
+        if (lipSyncValue != FLT_MAX && curveBinding.LipSyncFlag != 0ULL)
         {
-            for (csmUint32 i = 0; i < _lipSyncParameterIds.GetSize() && i < MaxTargetSize; ++i)
-            {
-                if (_lipSyncParameterIds[i] == curves[c].Id)
-                {
-                    value += lipSyncValue;
-                    lipSyncFlags |= 1ULL << i;
-                    break;
-                }
-            }
+            value += lipSyncValue;
+            lipSyncFlags |= curveBinding.LipSyncFlag;
         }
 
         csmFloat32 v;
@@ -446,9 +1252,9 @@ void CubismMotion::DoUpdateParameters(CubismModel* model, csmFloat32 userTimeSec
     {
         if (eyeBlinkValue != FLT_MAX)
         {
-            for (csmUint32 i = 0; i < _eyeBlinkParameterIds.GetSize() && i < MaxTargetSize; ++i)
+            for (csmUint32 i = 0; i < binding->EyeBlinkParameterIndices.GetSize(); ++i)
             {
-                const csmFloat32 sourceValue = model->GetParameterValue(_eyeBlinkParameterIds[i]);
+                const csmFloat32 sourceValue = model->GetParameterValue(binding->EyeBlinkParameterIndices[i]);
                 //モーションでの上書きがあった時にはまばたきは適用しない
                 if ((eyeBlinkFlags >> i) & 0x01)
                 {
@@ -457,15 +1263,15 @@ void CubismMotion::DoUpdateParameters(CubismModel* model, csmFloat32 userTimeSec
 
                 const csmFloat32 v = sourceValue + (eyeBlinkValue - sourceValue) * fadeWeight;
 
-                model->SetParameterValue(_eyeBlinkParameterIds[i], v);
+                model->SetParameterValue(binding->EyeBlinkParameterIndices[i], v);
             }
         }
 
         if (lipSyncValue != FLT_MAX)
         {
-            for (csmUint32 i = 0; i < _lipSyncParameterIds.GetSize() && i < MaxTargetSize; ++i)
+            for (csmUint32 i = 0; i < binding->LipSyncParameterIndices.GetSize(); ++i)
             {
-                const csmFloat32 sourceValue = model->GetParameterValue(_lipSyncParameterIds[i]);
+                const csmFloat32 sourceValue = model->GetParameterValue(binding->LipSyncParameterIndices[i]);
                 //モーションでの上書きがあった時にはリップシンクは適用しない
                 if ((lipSyncFlags >> i) & 0x01)
                 {
@@ -474,7 +1280,7 @@ void CubismMotion::DoUpdateParameters(CubismModel* model, csmFloat32 userTimeSec
 
                 const csmFloat32 v = sourceValue + (lipSyncValue - sourceValue) * fadeWeight;
 
-                model->SetParameterValue(_lipSyncParameterIds[i], v);
+                model->SetParameterValue(binding->LipSyncParameterIndices[i], v);
             }
         }
     }
@@ -482,7 +1288,7 @@ void CubismMotion::DoUpdateParameters(CubismModel* model, csmFloat32 userTimeSec
     for (; c < _motionData->CurveCount && curves[c].Type == CubismMotionCurveTarget_PartOpacity; ++c)
     {
         // Find parameter index.
-        parameterIndex = model->GetParameterIndex(curves[c].Id);
+        parameterIndex = binding->Curves[c].ParameterIndex;
 
         // Skip curve evaluation if no value in sink.
         if (parameterIndex == -1)
@@ -491,7 +1297,7 @@ void CubismMotion::DoUpdateParameters(CubismModel* model, csmFloat32 userTimeSec
         }
 
         // Evaluate curve and apply value.
-        value = EvaluateCurve(_motionData, c, time);
+        value = curveValues ? curveValues[c] : EvaluateCurve(_motionData, c, time, segmentCursors[c]);
 
         model->SetParameterValue(parameterIndex, value);
     }
@@ -525,190 +1331,298 @@ void CubismMotion::Parse(const csmByte* motionJson, const csmSizeInt size)
 {
     _motionData = CSM_NEW CubismMotionData;
 
-    CubismMotionJson* json = CSM_NEW CubismMotionJson(motionJson, size);
+    // 要素の木を作らず、読んだ順にモーションデータを組み立てる
+    MotionJsonHandler handler(_motionData, size);
 
-    if (!json->IsValid())
+    if (!Utils::CubismJsonReader::Read(motionJson, size, handler))
     {
-        CSM_DELETE(json);
+        if (handler.GetError())
+        {
+            CubismLogError("motion3.json is corrupted. %s", handler.GetError());
+        }
+        CSM_DELETE(_motionData);
+        _motionData = CSM_NEW CubismMotionData;
         return;
     }
 
-    _motionData->Duration = json->GetMotionDuration();
-    _motionData->Loop = json->IsMotionLoop();
-    _motionData->CurveCount = json->GetMotionCurveCount();
-    _motionData->Fps = json->GetMotionFps();
-    _motionData->EventCount = json->GetEventCount();
+    _motionData->CurveCount = static_cast<csmInt16>(_motionData->Curves.GetSize());
+    _motionData->EventCount = _motionData->Events.GetSize();
+
+    _fadeInSeconds = handler.FadeInSeconds;
+    _fadeOutSeconds = handler.FadeOutSeconds;
+
+    // AreBeziersRestrictedはCurvesより後に現れてもよいので、評価関数は読み終えてから決める
+    for (csmUint32 i = 0; i < _motionData->Segments.GetSize(); ++i)
+    {
+        CubismMotionSegment& segment = _motionData->Segments[i];
+
+        switch (segment.SegmentType)
+        {
+        case CubismMotionSegmentType_Linear:
+            segment.Evaluate = LinearEvaluate;
+            break;
+        case CubismMotionSegmentType_Bezier:
+            segment.Evaluate = (handler.AreBeziersRestricted || UseOldBeziersCurveMotion) ? BezierEvaluate : BezierEvaluateCardanoInterpretation;
+            break;
+        case CubismMotionSegmentType_Stepped:
+            segment.Evaluate = SteppedEvaluate;
+            break;
+        case CubismMotionSegmentType_InverseStepped:
+            segment.Evaluate = InverseSteppedEvaluate;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+csmBool CubismMotion::ParseBinary(const csmByte* motionBinary, const csmSizeInt size)
+{
+    _motionData = CSM_NEW CubismMotionData;
 
-    csmBool areBeziersRestricted = json->GetEvaluationOptionFlag( EvaluationOptionFlag_AreBeziersRestricted );
+    CubismMotionBinaryHeader header;
 
-    if (json->IsExistMotionFadeInTime())
+    if (size < sizeof(header))
     {
-        _fadeInSeconds = (json->GetMotionFadeInTime() < 0.0f)
-                             ? 1.0f
-                             : json->GetMotionFadeInTime();
+        CubismLogError("motion3.bin is truncated.");
+        return false;
     }
-    else
+
+    memcpy(&header, motionBinary, sizeof(header));
+
+    if (header.Magic != CubismMotionBinaryMagic || header.Version != CubismMotionBinaryVersion)
     {
-        _fadeInSeconds = 1.0f;
+        CubismLogError("Unsupported motion3.bin version %u.", header.Version);
+        return false;
     }
 
-    if (json->IsExistMotionFadeOutTime())
+    if (header.CurveCount < 0 || header.CurveCount > 0x7FFF || header.SegmentCount < 0 || header.PointCount < 0 || header.EventCount < 0)
     {
-        _fadeOutSeconds = (json->GetMotionFadeOutTime() < 0.0f)
-                              ? 1.0f
-                              : json->GetMotionFadeOutTime();
+        CubismLogError("motion3.bin has invalid counts.");
+        return false;
     }
-    else
+
+    const csmSizeType curveBytes = sizeof(CubismMotionBinaryCurve) * static_cast<csmSizeType>(header.CurveCount);
+    const csmSizeType segmentBytes = sizeof(CubismMotionBinarySegment) * static_cast<csmSizeType>(header.SegmentCount);
+    const csmSizeType pointBytes = sizeof(CubismMotionPoint) * static_cast<csmSizeType>(header.PointCount);
+    const csmSizeType eventBytes = sizeof(CubismMotionBinaryEvent) * static_cast<csmSizeType>(header.EventCount);
+
+    if (sizeof(header) + curveBytes + segmentBytes + pointBytes + eventBytes + header.StringPoolSize != size
+        || (header.StringPoolSize > 0 && motionBinary[size - 1] != '\0'))
     {
-        _fadeOutSeconds = 1.0f;
+        CubismLogError("motion3.bin is truncated.");
+        return false;
     }
 
-    _motionData->Curves.UpdateSize(_motionData->CurveCount, CubismMotionCurve(), true);
-    _motionData->Segments.UpdateSize(json->GetMotionTotalSegmentCount(), CubismMotionSegment(), true);
-    _motionData->Points.UpdateSize(json->GetMotionTotalPointCount(), CubismMotionPoint(), true);
-    _motionData->Events.UpdateSize(_motionData->EventCount, CubismMotionEvent(), true);
+    const csmByte* cursor = motionBinary + sizeof(header);
+    const csmChar* stringPool = reinterpret_cast<const csmChar*>(motionBinary + size - header.StringPoolSize);
+    const csmBool areBeziersRestricted = (header.Flags & CubismMotionBinaryFlag_AreBeziersRestricted) != 0;
+
+    _motionData->Duration = header.Duration;
+    _motionData->Loop = header.Loop != 0;
+    _motionData->CurveCount = static_cast<csmInt16>(header.CurveCount);
+    _motionData->Fps = header.Fps;
+    _motionData->EventCount = header.EventCount;
+
+    _fadeInSeconds = header.FadeInTime;
+    _fadeOutSeconds = header.FadeOutTime;
 
-    csmInt32 totalPointCount = 0;
-    csmInt32 totalSegmentCount = 0;
+    _motionData->Curves.UpdateSize(header.CurveCount, CubismMotionCurve(), true);
+    _motionData->Segments.UpdateSize(header.SegmentCount, CubismMotionSegment(), true);
+    _motionData->Points.UpdateSize(header.PointCount, CubismMotionPoint(), true);
+    _motionData->Events.UpdateSize(header.EventCount, CubismMotionEvent(), true);
+
+    csmBool isValid = true;
 
     // Curves
-    for (csmInt32 curveCount = 0; curveCount < _motionData->CurveCount; ++curveCount)
+    for (csmInt32 i = 0; i < header.CurveCount && isValid; ++i, cursor += sizeof(CubismMotionBinaryCurve))
     {
-        if (strcmp(json->GetMotionCurveTarget(curveCount), TargetNameModel) == 0)
-        {
-            _motionData->Curves[curveCount].Type = CubismMotionCurveTarget_Model;
-        }
-        else if (strcmp(json->GetMotionCurveTarget(curveCount), TargetNameParameter) == 0)
-        {
-            _motionData->Curves[curveCount].Type = CubismMotionCurveTarget_Parameter;
-        }
-        else if (strcmp(json->GetMotionCurveTarget(curveCount), TargetNamePartOpacity) == 0)
-        {
-            _motionData->Curves[curveCount].Type = CubismMotionCurveTarget_PartOpacity;
-        }
-        else
+        CubismMotionBinaryCurve curve;
+        memcpy(&curve, cursor, sizeof(curve));
+
+        isValid = curve.Type >= CubismMotionCurveTarget_Model && curve.Type <= CubismMotionCurveTarget_PartOpacity
+            && curve.IdOffset < header.StringPoolSize
+            && curve.SegmentCount >= 0 && curve.BaseSegmentIndex >= 0
+            && curve.BaseSegmentIndex <= header.SegmentCount - curve.SegmentCount;
+
+        if (!isValid)
         {
-            CubismLogWarning("Warning : Unable to get segment type from Curve! The number of \"CurveCount\" may be incorrect!");
+            break;
         }
 
-        _motionData->Curves[curveCount].Id = json->GetMotionCurveId(curveCount);
+        CubismMotionCurve& target = _motionData->Curves[i];
+        target.Type = static_cast<CubismMotionCurveTarget>(curve.Type);
+        target.Id = CubismFramework::GetIdManager()->GetId(stringPool + curve.IdOffset);
+        target.SegmentCount = curve.SegmentCount;
+        target.BaseSegmentIndex = curve.BaseSegmentIndex;
+        target.FadeInTime = curve.FadeInTime;
+        target.FadeOutTime = curve.FadeOutTime;
+    }
 
-        _motionData->Curves[curveCount].BaseSegmentIndex = totalSegmentCount;
+    // Segments
+    for (csmInt32 i = 0; i < header.SegmentCount && isValid; ++i, cursor += sizeof(CubismMotionBinarySegment))
+    {
+        CubismMotionBinarySegment segment;
+        memcpy(&segment, cursor, sizeof(segment));
 
-        _motionData->Curves[curveCount].FadeInTime =
-                (json->IsExistMotionCurveFadeInTime(curveCount))
-                    ? json->GetMotionCurveFadeInTime(curveCount)
-                    : -1.0f ;
-        _motionData->Curves[curveCount].FadeOutTime =
-                (json->IsExistMotionCurveFadeOutTime(curveCount))
-                    ? json->GetMotionCurveFadeOutTime(curveCount)
-                    : -1.0f;
+        CubismMotionSegment& target = _motionData->Segments[i];
+        csmInt32 pointCount = 2;
 
-        // Segments
-        for (csmInt32 segmentPosition = 0; segmentPosition < json->GetMotionCurveSegmentCount(curveCount);)
+        switch (segment.SegmentType)
         {
-            if (segmentPosition == 0)
-            {
-                _motionData->Segments[totalSegmentCount].BasePointIndex = totalPointCount;
-
-                _motionData->Points[totalPointCount].Time = json->GetMotionCurveSegment(curveCount, segmentPosition);
-                _motionData->Points[totalPointCount].Value = json->GetMotionCurveSegment(curveCount, segmentPosition + 1);
-
-                totalPointCount += 1;
-                segmentPosition += 2;
-            }
-            else
-            {
-                _motionData->Segments[totalSegmentCount].BasePointIndex = totalPointCount - 1;
-            }
-
-            const csmInt32 segment = static_cast<csmInt32>(json->GetMotionCurveSegment(curveCount, segmentPosition));
+        case CubismMotionSegmentType_Linear:
+            target.Evaluate = LinearEvaluate;
+            break;
+        case CubismMotionSegmentType_Bezier:
+            target.Evaluate = (areBeziersRestricted || UseOldBeziersCurveMotion) ? BezierEvaluate : BezierEvaluateCardanoInterpretation;
+            pointCount = 4;
+            break;
+        case CubismMotionSegmentType_Stepped:
+            target.Evaluate = SteppedEvaluate;
+            break;
+        case CubismMotionSegmentType_InverseStepped:
+            target.Evaluate = InverseSteppedEvaluate;
+            break;
+        default:
+            isValid = false;
+            break;
+        }
 
-            switch (segment)
-            {
-            case CubismMotionSegmentType_Linear: {
-                _motionData->Segments[totalSegmentCount].SegmentType = CubismMotionSegmentType_Linear;
-                _motionData->Segments[totalSegmentCount].Evaluate = LinearEvaluate;
+        isValid = isValid && segment.BasePointIndex >= 0 && segment.BasePointIndex <= header.PointCount - pointCount;
 
-                _motionData->Points[totalPointCount].Time = json->GetMotionCurveSegment(curveCount, (segmentPosition + 1));
-                _motionData->Points[totalPointCount].Value = json->GetMotionCurveSegment(curveCount, (segmentPosition + 2));
+        target.SegmentType = segment.SegmentType;
+        target.BasePointIndex = segment.BasePointIndex;
+    }
 
-                totalPointCount += 1;
-                segmentPosition += 3;
+    // Points（CubismMotionPoint と同じレイアウトなのでそのまま複写する）
+    if (isValid && pointBytes > 0)
+    {
+        memcpy(_motionData->Points.GetPtr(), motionBinary + sizeof(header) + curveBytes + segmentBytes, pointBytes);
+    }
 
-                break;
-            }
-            case CubismMotionSegmentType_Bezier: {
-                _motionData->Segments[totalSegmentCount].SegmentType = CubismMotionSegmentType_Bezier;
-                if (areBeziersRestricted || UseOldBeziersCurveMotion) {
-                    _motionData->Segments[totalSegmentCount].Evaluate = BezierEvaluate;
-                }
-                else
-                {
-                    _motionData->Segments[totalSegmentCount].Evaluate = BezierEvaluateCardanoInterpretation;
-                }
+    // Events
+    cursor = motionBinary + sizeof(header) + curveBytes + segmentBytes + pointBytes;
 
-                _motionData->Points[totalPointCount].Time = json->GetMotionCurveSegment(curveCount, (segmentPosition + 1));
-                _motionData->Points[totalPointCount].Value = json->GetMotionCurveSegment(curveCount, (segmentPosition + 2));
+    for (csmInt32 i = 0; i < header.EventCount && isValid; ++i, cursor += sizeof(CubismMotionBinaryEvent))
+    {
+        CubismMotionBinaryEvent event;
+        memcpy(&event, cursor, sizeof(event));
 
-                _motionData->Points[totalPointCount + 1].Time = json->GetMotionCurveSegment(curveCount, (segmentPosition + 3));
-                _motionData->Points[totalPointCount + 1].Value = json->GetMotionCurveSegment(curveCount, (segmentPosition + 4));
+        isValid = event.ValueOffset < header.StringPoolSize;
 
-                _motionData->Points[totalPointCount + 2].Time = json->GetMotionCurveSegment(curveCount, (segmentPosition + 5));
-                _motionData->Points[totalPointCount + 2].Value = json->GetMotionCurveSegment(curveCount, (segmentPosition + 6));
+        if (isValid)
+        {
+            _motionData->Events[i].FireTime = event.FireTime;
+            _motionData->Events[i].Value = stringPool + event.ValueOffset;
+        }
+    }
 
-                totalPointCount += 3;
-                segmentPosition += 7;
+    if (!isValid)
+    {
+        CubismLogError("motion3.bin is corrupted.");
+        return false;
+    }
 
-                break;
-            }
-            case CubismMotionSegmentType_Stepped: {
-                _motionData->Segments[totalSegmentCount].SegmentType = CubismMotionSegmentType_Stepped;
-                _motionData->Segments[totalSegmentCount].Evaluate = SteppedEvaluate;
+    return true;
+}
 
-                _motionData->Points[totalPointCount].Time = json->GetMotionCurveSegment(curveCount, (segmentPosition + 1));
-                _motionData->Points[totalPointCount].Value = json->GetMotionCurveSegment(curveCount, (segmentPosition + 2));
+csmBool CubismMotion::IsBinary(const csmByte* buffer, csmSizeInt size)
+{
+    csmUint32 magic;
 
-                totalPointCount += 1;
-                segmentPosition += 3;
+    if (buffer == NULL || size < sizeof(magic))
+    {
+        return false;
+    }
 
-                break;
-            }
-            case CubismMotionSegmentType_InverseStepped: {
-                _motionData->Segments[totalSegmentCount].SegmentType = CubismMotionSegmentType_InverseStepped;
-                _motionData->Segments[totalSegmentCount].Evaluate = InverseSteppedEvaluate;
+    memcpy(&magic, buffer, sizeof(magic));
 
-                _motionData->Points[totalPointCount].Time = json->GetMotionCurveSegment(curveCount, (segmentPosition + 1));
-                _motionData->Points[totalPointCount].Value = json->GetMotionCurveSegment(curveCount, (segmentPosition + 2));
+    return magic == CubismMotionBinaryMagic;
+}
 
-                totalPointCount += 1;
-                segmentPosition += 3;
+void CubismMotion::WriteBinary(csmVector<csmByte>& buffer) const
+{
+    CubismMotionData* data = _motionData;
+    csmVector<csmByte> stringPool;
+    csmUint32 flags = 0;
 
-                break;
-            }
-            default: {
-                CSM_ASSERT(0);
-                break;
-            }
+    for (csmUint32 i = 0; i < data->Segments.GetSize(); ++i)
+    {
+        if (data->Segments[i].SegmentType == CubismMotionSegmentType_Bezier)
+        {
+            if (data->Segments[i].Evaluate == BezierEvaluate)
+            {
+                flags |= CubismMotionBinaryFlag_AreBeziersRestricted;
             }
 
-            ++_motionData->Curves[curveCount].SegmentCount;
-            ++totalSegmentCount;
+            break;
         }
     }
 
+    CubismMotionBinaryHeader header;
+    header.Magic = CubismMotionBinaryMagic;
+    header.Version = CubismMotionBinaryVersion;
+    header.Duration = data->Duration;
+    header.Fps = data->Fps;
+    header.FadeInTime = _fadeInSeconds;
+    header.FadeOutTime = _fadeOutSeconds;
+    header.Loop = data->Loop;
+    header.Flags = flags;
+    header.CurveCount = data->Curves.GetSize();
+    header.SegmentCount = data->Segments.GetSize();
+    header.PointCount = data->Points.GetSize();
+    header.EventCount = data->Events.GetSize();
+    header.StringPoolSize = 0;
+    header.Reserved = 0;
+
+    csmVector<CubismMotionBinaryCurve> curves(header.CurveCount);
+    csmVector<CubismMotionBinarySegment> segments(header.SegmentCount);
+    csmVector<CubismMotionBinaryEvent> events(header.EventCount);
+
+    for (csmInt32 i = 0; i < header.CurveCount; ++i)
+    {
+        const CubismMotionCurve& source = data->Curves[i];
+        CubismMotionBinaryCurve curve;
+        curve.Type = source.Type;
+        curve.IdOffset = AppendBinaryString(stringPool, source.Id->GetString().GetRawString());
+        curve.SegmentCount = source.SegmentCount;
+        curve.BaseSegmentIndex = source.BaseSegmentIndex;
+        curve.FadeInTime = source.FadeInTime;
+        curve.FadeOutTime = source.FadeOutTime;
+        curves.PushBack(curve);
+    }
+
+    for (csmInt32 i = 0; i < header.SegmentCount; ++i)
+    {
+        CubismMotionBinarySegment segment;
+        segment.SegmentType = data->Segments[i].SegmentType;
+        segment.BasePointIndex = data->Segments[i].BasePointIndex;
+        segments.PushBack(segment);
+    }
 
-    for (csmInt32 userdatacount = 0; userdatacount < json->GetEventCount(); ++userdatacount)
+    for (csmInt32 i = 0; i < header.EventCount; ++i)
     {
-        _motionData->Events[userdatacount].FireTime = json->GetEventTime(userdatacount);
-        _motionData->Events[userdatacount].Value = json->GetEventValue(userdatacount);
+        CubismMotionBinaryEvent event;
+        event.FireTime = data->Events[i].FireTime;
+        event.ValueOffset = AppendBinaryString(stringPool, data->Events[i].Value.GetRawString());
+        events.PushBack(event);
     }
 
-    CSM_DELETE(json);
+    header.StringPoolSize = static_cast<csmUint32>(stringPool.GetSize());
+
+    buffer.Clear();
+    AppendBinaryBytes(buffer, &header, sizeof(header));
+    AppendBinaryBytes(buffer, curves.GetPtr(), sizeof(CubismMotionBinaryCurve) * curves.GetSize());
+    AppendBinaryBytes(buffer, segments.GetPtr(), sizeof(CubismMotionBinarySegment) * segments.GetSize());
+    AppendBinaryBytes(buffer, data->Points.GetPtr(), sizeof(CubismMotionPoint) * data->Points.GetSize());
+    AppendBinaryBytes(buffer, events.GetPtr(), sizeof(CubismMotionBinaryEvent) * events.GetSize());
+    AppendBinaryBytes(buffer, stringPool.GetPtr(), stringPool.GetSize());
 }
 
 void CubismMotion::SetParameterFadeInTime(CubismIdHandle parameterId, csmFloat32 value)
 {
+    DetachMotionData();
+
     csmVector<CubismMotionCurve>& curves = _motionData->Curves;
 
     for (csmInt16 i = 0; i < _motionData->CurveCount; ++i)
@@ -723,6 +1637,8 @@ void CubismMotion::SetParameterFadeInTime(CubismIdHandle parameterId, csmFloat32
 
 void CubismMotion::SetParameterFadeOutTime(CubismIdHandle parameterId, csmFloat32 value)
 {
+    DetachMotionData();
+
     csmVector<CubismMotionCurve>& curves = _motionData->Curves;
 
     for (csmInt16 i = 0; i < _motionData->CurveCount; ++i)
@@ -735,6 +1651,195 @@ void CubismMotion::SetParameterFadeOutTime(CubismIdHandle parameterId, csmFloat3
     }
 }
 
+void CubismMotion::DetachMotionData()
+{
+    if (!_isMotionDataShared)
+    {
+        return;
+    }
+
+    _motionData = CSM_NEW CubismMotionData(*_motionData);
+    _isMotionDataShared = false;
+}
+
+const CubismMotion::ModelBinding* CubismMotion::BindModel(CubismModel* model)
+{
+    // 同じアドレスに作り直されたモデルは通し番号で見分ける
+    for (csmUint32 i = 0; i < _modelBindings.GetSize(); ++i)
+    {
+        ModelBinding* binding = _modelBindings[i];
+        if (binding->Model == model && binding->ModelInstanceNo == model->GetInstanceNo())
+        {
+            return binding;
+        }
+    }
+
+    // 以前同じアドレスにあったモデルの対応付けは使えないので作り直す
+    ModelBinding* binding = NULL;
+    for (csmUint32 i = 0; i < _modelBindings.GetSize(); ++i)
+    {
+        if (_modelBindings[i]->Model == model)
+        {
+            binding = _modelBindings[i];
+            break;
+        }
+    }
+
+    if (binding == NULL)
+    {
+        binding = CSM_NEW ModelBinding();
+        _modelBindings.PushBack(binding, false);
+    }
+
+    binding->Model = model;
+    binding->ModelInstanceNo = model->GetInstanceNo();
+    binding->Curves.UpdateSize(_motionData->CurveCount, CurveBinding(), false);
+    binding->EyeBlinkParameterIndices.UpdateSize(0);
+    binding->LipSyncParameterIndices.UpdateSize(0);
+
+    const csmVector<CubismMotionCurve>& curves = _motionData->Curves;
+    for (csmInt32 c = 0; c < _motionData->CurveCount; ++c)
+    {
+        CurveBinding& curveBinding = binding->Curves[c];
+        curveBinding.ParameterIndex = -1;
+        curveBinding.EyeBlinkFlag = 0ULL;
+        curveBinding.LipSyncFlag = 0ULL;
+
+        if (curves[c].Type == CubismMotionCurveTarget_Model)
+        {
+            continue;
+        }
+
+        curveBinding.ParameterIndex = model->GetParameterIndex(curves[c].Id);
+
+        if (curves[c].Type != CubismMotionCurveTarget_Parameter)
+        {
+            continue;
+        }
+
+        for (csmUint32 i = 0; i < _eyeBlinkParameterIds.GetSize() && i < MaxTargetSize; ++i)
+        {
+            if (_eyeBlinkParameterIds[i] == curves[c].Id)
+            {
+                curveBinding.EyeBlinkFlag = 1ULL << i;
+                break;
+            }
+        }
+
+        for (csmUint32 i = 0; i < _lipSyncParameterIds.GetSize() && i < MaxTargetSize; ++i)
+        {
+            if (_lipSyncParameterIds[i] == curves[c].Id)
+            {
+                curveBinding.LipSyncFlag = 1ULL << i;
+                break;
+            }
+        }
+    }
+
+    for (csmUint32 i = 0; i < _eyeBlinkParameterIds.GetSize() && i < MaxTargetSize; ++i)
+    {
+        binding->EyeBlinkParameterIndices.PushBack(model->GetParameterIndex(_eyeBlinkParameterIds[i]), false);
+    }
+
+    for (csmUint32 i = 0; i < _lipSyncParameterIds.GetSize() && i < MaxTargetSize; ++i)
+    {
+        binding->LipSyncParameterIndices.PushBack(model->GetParameterIndex(_lipSyncParameterIds[i]), false);
+    }
+
+    return binding;
+}
+
+void CubismMotion::EvaluateCurves(const ModelBinding* binding, csmFloat32 time, csmInt32* segmentCursors)
+{
+    const csmInt32 curveCount = _motionData->CurveCount;
+    const csmInt32 capacity = (curveCount + BlockLanes - 1) / BlockLanes * BlockLanes;
+
+    if (_curveBatch == NULL)
+    {
+        _curveBatch = CSM_NEW CubismMotionCurveBatch();
+    }
+
+    CubismMotionCurveBatch& batch = *_curveBatch;
+
+    if (static_cast<csmInt32>(batch.CurveValues.GetSize()) != curveCount)
+    {
+        batch.CurveValues.UpdateSize(curveCount, 0.0f, false);
+        ResizeSegmentBatch(batch.LinearSegments, capacity);
+        ResizeSegmentBatch(batch.BezierSegments, capacity);
+        ResizeSegmentBatch(batch.CardanoSegments, capacity);
+    }
+
+    batch.LinearSegments.Count = 0;
+    batch.BezierSegments.Count = 0;
+    batch.CardanoSegments.Count = 0;
+
+    csmFloat32* curveValues = batch.CurveValues.GetPtr();
+
+    // 評価するセグメントを種類ごとに集める
+    for (csmInt32 c = 0; c < curveCount; ++c)
+    {
+        const CubismMotionCurve& curve = _motionData->Curves[c];
+
+        // 対応するパラメータが無いカーブは評価しない
+        if (binding != NULL && curve.Type != CubismMotionCurveTarget_Model && binding->Curves[c].ParameterIndex == -1)
+        {
+            continue;
+        }
+
+        if (curve.SegmentCount <= 0)
+        {
+            curveValues[c] = _motionData->Points[0].Value;
+            continue;
+        }
+
+        const csmInt32 target = FindCurveSegment(_motionData, curve, time, segmentCursors[c]);
+
+        if (target == curve.BaseSegmentIndex + curve.SegmentCount)
+        {
+            curveValues[c] = _motionData->Points[GetSegmentEndPointIndex(_motionData->Segments[target - 1])].Value;
+            continue;
+        }
+
+        const CubismMotionSegment& segment = _motionData->Segments[target];
+        const CubismMotionPoint* points = &_motionData->Points[segment.BasePointIndex];
+
+        if (segment.Evaluate == LinearEvaluate)
+        {
+            AppendSegment(batch.LinearSegments, c, points, 2);
+        }
+        else if (segment.Evaluate == BezierEvaluate)
+        {
+            AppendSegment(batch.BezierSegments, c, points, 4);
+        }
+        else if (segment.Evaluate == BezierEvaluateCardanoInterpretation)
+        {
+            AppendSegment(batch.CardanoSegments, c, points, 4);
+        }
+        else
+        {
+            curveValues[c] = segment.Evaluate(points, time);
+        }
+    }
+
+    EvaluateLinearSegments(batch.LinearSegments, time);
+    EvaluateBezierSegments(batch.BezierSegments, time);
+    EvaluateCardanoSegments(batch.CardanoSegments, time);
+
+    ScatterSegmentBatch(batch.LinearSegments, curveValues);
+    ScatterSegmentBatch(batch.BezierSegments, curveValues);
+    ScatterSegmentBatch(batch.CardanoSegments, curveValues);
+}
+
+void CubismMotion::ClearModelBindings()
+{
+    for (csmUint32 i = 0; i < _modelBindings.GetSize(); ++i)
+    {
+        CSM_DELETE(_modelBindings[i]);
+    }
+
+    _modelBindings.Clear();
+}
+
 csmFloat32 CubismMotion::GetParameterFadeInTime(CubismIdHandle parameterId) const
 {
     csmVector<CubismMotionCurve>& curves = _motionData->Curves;
@@ -790,10 +1895,52 @@ csmFloat32 CubismMotion::GetLoopDuration()
     return _loopDurationSeconds;
 }
 
+csmSizeType CubismMotion::GetMotionDataSize() const
+{
+    return sizeof(CubismMotionData)
+        + _motionData->Curves.GetSize() * sizeof(CubismMotionCurve)
+        + _motionData->Segments.GetSize() * sizeof(CubismMotionSegment)
+        + _motionData->Points.GetSize() * sizeof(CubismMotionPoint)
+        + _motionData->Events.GetSize() * sizeof(CubismMotionEvent);
+}
+
+csmInt32 CubismMotion::GetCurveCount() const
+{
+    return _motionData->CurveCount;
+}
+
+void CubismMotion::EvaluateAllCurves(csmFloat32 time, csmBool batched, csmInt32* segmentCursors, csmFloat32* values)
+{
+    if (batched)
+    {
+        EvaluateCurves(NULL, time, segmentCursors);
+        memcpy(values, _curveBatch->CurveValues.GetPtr(), sizeof(csmFloat32) * _motionData->CurveCount);
+        return;
+    }
+
+    for (csmInt32 c = 0; c < _motionData->CurveCount; ++c)
+    {
+        values[c] = EvaluateCurve(_motionData, c, time, segmentCursors[c]);
+    }
+}
+
+void CubismMotion::SetBatchedCurveEvaluation(csmBool batched)
+{
+    _batchedCurveEvaluation = batched;
+}
+
+csmBool CubismMotion::IsBatchedCurveEvaluation() const
+{
+    return _batchedCurveEvaluation;
+}
+
 void CubismMotion::SetEffectIds(const csmVector<CubismIdHandle>& eyeBlinkParameterIds, const csmVector<CubismIdHandle>& lipSyncParameterIds)
 {
     _eyeBlinkParameterIds = eyeBlinkParameterIds;
     _lipSyncParameterIds = lipSyncParameterIds;
+
+    // 対象が変わったので対応付けをやり直す
+    ClearModelBindings();
 }
 
 const csmVector<const csmString*>& CubismMotion::GetFiredEvent(csmFloat32 beforeCheckTimeSeconds, csmFloat32 motionTimeSeconds)
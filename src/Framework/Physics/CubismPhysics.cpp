@@ -9,10 +9,24 @@
 #include "Framework/Physics/CubismPhysicsInternal.hpp"
 #include "Framework/Physics/CubismPhysicsJson.hpp"
 #include "Framework/Model/CubismModel.hpp"
+#include "Framework/Id/CubismIdManager.hpp"
 #include "Framework/Utils/CubismString.hpp"
+#include "Framework/Utils/CubismBinaryStream.hpp"
 #include "Framework/Math/CubismMath.hpp"
 #include "Framework/Math/CubismVector2.hpp"
 
+// 振り子をまとめて計算する命令セット。AVXはコンパイラで有効にされている場合だけ使う
+#if defined(__AVX__)
+#define CSM_PHYSICS_SIMD_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CSM_PHYSICS_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CSM_PHYSICS_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
 namespace Live2D { namespace Cubism { namespace Framework {
 
 /// physics constants
@@ -29,12 +43,19 @@ const csmFloat32 AirResistance = 5.0f;
 /// Constant of maximum weight of input and output ratio.
 const csmFloat32 MaximumWeight = 100.0f;
 
+/// Signature and version of the binary snapshot written by WriteBinary.
+const csmUint32 PhysicsBinaryMagic = 0x42334850; // "PH3B"
+const csmUint32 PhysicsBinaryVersion = 1;
+
 /// Constant of threshold of movement.
 const csmFloat32 MovementThreshold = 0.001f;
 
 /// Constant of maximum allowed delta time
 const csmFloat32 MaxDeltaTime = 5.0f;
 
+/// Count of consecutive ticks a setting must be at rest before it sleeps.
+const csmInt32 SleepTickCount = 30;
+
 csmFloat32 GetRangeValue(csmFloat32 min, csmFloat32 max)
 {
     csmFloat32 maxValue = CubismMath::Max(min, max);
@@ -341,6 +362,46 @@ void UpdateParticles(CubismPhysicsParticle* strand, csmInt32 strandCount, Cubism
     }
 }
 
+/// Gets the position of a parameter in the dense parameter caches, adding it if needed.
+///
+/// @param  cacheIndices      Positions in the caches by parameter index, -1 if not added yet.
+/// @param  boundIndices      Parameter indices by position in the caches.
+/// @param  parameterIndex    Target parameter index, -1 if the model does not have it.
+/// @return Position in the caches, or -1 if the model does not have the parameter.
+csmInt32 GetCacheIndex(csmVector<csmInt32>& cacheIndices, csmVector<csmInt32>& boundIndices, csmInt32 parameterIndex)
+{
+    if (parameterIndex == -1)
+    {
+        return -1;
+    }
+
+    if (cacheIndices[parameterIndex] == -1)
+    {
+        cacheIndices[parameterIndex] = boundIndices.GetSize();
+        boundIndices.PushBack(parameterIndex);
+    }
+
+    return cacheIndices[parameterIndex];
+}
+
+/// Gets the largest velocity component of a strand.
+///
+/// @param  strand       Target array of particle.
+/// @param  strandCount  Count of particle.
+/// @return Largest absolute velocity component, excluding the root.
+csmFloat32 GetMaxVelocity(const CubismPhysicsParticle* strand, csmInt32 strandCount)
+{
+    csmFloat32 maxVelocity = 0.0f;
+
+    for (csmInt32 i = 1; i < strandCount; ++i)
+    {
+        maxVelocity = CubismMath::Max(maxVelocity, CubismMath::AbsF(strand[i].Velocity.X));
+        maxVelocity = CubismMath::Max(maxVelocity, CubismMath::AbsF(strand[i].Velocity.Y));
+    }
+
+    return maxVelocity;
+}
+
 /**
  * Updates particles for stabilization.
  *
@@ -438,16 +499,227 @@ void UpdateOutputParameterValue(csmFloat32* parameterValue, csmFloat32 parameter
     }
 }
 
+#if defined(CSM_PHYSICS_SIMD_AVX)
+typedef __m256 FloatBlock;
+const csmInt32 BlockLanes = 8;
+
+FloatBlock LoadBlock(const csmFloat32* p) { return _mm256_loadu_ps(p); }
+void StoreBlock(csmFloat32* p, FloatBlock a) { _mm256_storeu_ps(p, a); }
+FloatBlock SetBlock(csmFloat32 value) { return _mm256_set1_ps(value); }
+FloatBlock AddBlock(FloatBlock a, FloatBlock b) { return _mm256_add_ps(a, b); }
+FloatBlock SubBlock(FloatBlock a, FloatBlock b) { return _mm256_sub_ps(a, b); }
+FloatBlock MulBlock(FloatBlock a, FloatBlock b) { return _mm256_mul_ps(a, b); }
+FloatBlock DivBlock(FloatBlock a, FloatBlock b) { return _mm256_div_ps(a, b); }
+
+/// |value| < threshold のレーンを0にする。
+FloatBlock ZeroBelowThresholdBlock(FloatBlock value, FloatBlock threshold)
+{
+    const FloatBlock absValue = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value);
+    return _mm256_andnot_ps(_mm256_cmp_ps(absValue, threshold, _CMP_LT_OQ), value);
+}
+
+/// condition != 0 のレーンはa、それ以外はbを選ぶ。
+FloatBlock SelectNonZeroBlock(FloatBlock condition, FloatBlock a, FloatBlock b)
+{
+    return _mm256_blendv_ps(b, a, _mm256_cmp_ps(condition, _mm256_setzero_ps(), _CMP_NEQ_UQ));
+}
+#elif defined(CSM_PHYSICS_SIMD_SSE2)
+typedef __m128 FloatBlock;
+const csmInt32 BlockLanes = 4;
+
+FloatBlock LoadBlock(const csmFloat32* p) { return _mm_loadu_ps(p); }
+void StoreBlock(csmFloat32* p, FloatBlock a) { _mm_storeu_ps(p, a); }
+FloatBlock SetBlock(csmFloat32 value) { return _mm_set1_ps(value); }
+FloatBlock AddBlock(FloatBlock a, FloatBlock b) { return _mm_add_ps(a, b); }
+FloatBlock SubBlock(FloatBlock a, FloatBlock b) { return _mm_sub_ps(a, b); }
+FloatBlock MulBlock(FloatBlock a, FloatBlock b) { return _mm_mul_ps(a, b); }
+FloatBlock DivBlock(FloatBlock a, FloatBlock b) { return _mm_div_ps(a, b); }
+
+/// |value| < threshold のレーンを0にする。
+FloatBlock ZeroBelowThresholdBlock(FloatBlock value, FloatBlock threshold)
+{
+    const FloatBlock absValue = _mm_andnot_ps(_mm_set1_ps(-0.0f), value);
+    return _mm_andnot_ps(_mm_cmplt_ps(absValue, threshold), value);
+}
+
+/// condition != 0 のレーンはa、それ以外はbを選ぶ。
+FloatBlock SelectNonZeroBlock(FloatBlock condition, FloatBlock a, FloatBlock b)
+{
+    const FloatBlock mask = _mm_cmpneq_ps(condition, _mm_setzero_ps());
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+#elif defined(CSM_PHYSICS_SIMD_NEON)
+typedef float32x4_t FloatBlock;
+const csmInt32 BlockLanes = 4;
+
+FloatBlock LoadBlock(const csmFloat32* p) { return vld1q_f32(p); }
+void StoreBlock(csmFloat32* p, FloatBlock a) { vst1q_f32(p, a); }
+FloatBlock SetBlock(csmFloat32 value) { return vdupq_n_f32(value); }
+FloatBlock AddBlock(FloatBlock a, FloatBlock b) { return vaddq_f32(a, b); }
+FloatBlock SubBlock(FloatBlock a, FloatBlock b) { return vsubq_f32(a, b); }
+FloatBlock MulBlock(FloatBlock a, FloatBlock b) { return vmulq_f32(a, b); }
+FloatBlock DivBlock(FloatBlock a, FloatBlock b) { return vdivq_f32(a, b); }
+
+/// |value| < threshold のレーンを0にする。
+FloatBlock ZeroBelowThresholdBlock(FloatBlock value, FloatBlock threshold)
+{
+    return vbslq_f32(vcltq_f32(vabsq_f32(value), threshold), vdupq_n_f32(0.0f), value);
+}
+
+/// condition != 0 のレーンはa、それ以外はbを選ぶ。
+FloatBlock SelectNonZeroBlock(FloatBlock condition, FloatBlock a, FloatBlock b)
+{
+    return vbslq_f32(vceqq_f32(condition, vdupq_n_f32(0.0f)), b, a);
+}
+#else
+typedef csmFloat32 FloatBlock;
+const csmInt32 BlockLanes = 1;
+
+FloatBlock LoadBlock(const csmFloat32* p) { return *p; }
+void StoreBlock(csmFloat32* p, FloatBlock a) { *p = a; }
+FloatBlock SetBlock(csmFloat32 value) { return value; }
+FloatBlock AddBlock(FloatBlock a, FloatBlock b) { return a + b; }
+FloatBlock SubBlock(FloatBlock a, FloatBlock b) { return a - b; }
+FloatBlock MulBlock(FloatBlock a, FloatBlock b) { return a * b; }
+FloatBlock DivBlock(FloatBlock a, FloatBlock b) { return a / b; }
+FloatBlock ZeroBelowThresholdBlock(FloatBlock value, FloatBlock threshold) { return (CubismMath::AbsF(value) < threshold) ? 0.0f : value; }
+FloatBlock SelectNonZeroBlock(FloatBlock condition, FloatBlock a, FloatBlock b) { return (condition != 0.0f) ? a : b; }
+#endif
+
+/// Gets the length in the same way as CubismVector2::Normalize.
+///
+/// powf is called per lane, since a vector square root rounds differently and the difference grows over the frames.
+FloatBlock LengthBlock(FloatBlock squaredLength)
+{
+    csmFloat32 lanes[BlockLanes];
+
+    StoreBlock(lanes, squaredLength);
+
+    for (csmInt32 i = 0; i < BlockLanes; ++i)
+    {
+        lanes[i] = powf(lanes[i], 0.5f);
+    }
+
+    return LoadBlock(lanes);
+}
+
+/// Updates a block of strands.
+///
+/// Performs the same operations as UpdateParticles on BlockLanes strands at once.
+/// The rotation by the change of gravity is computed per strand beforehand,
+/// since all particles of a strand share the same last gravity.
+///
+/// @param  state             Strand state.
+/// @param  block             Target block.
+/// @param  baseLane          Index of the first lane of the block.
+/// @param  windDirection     Direction of wind.
+/// @param  deltaTimeSeconds  Delta time.
+void UpdateStrandBlock(CubismPhysicsStrandState& state, const CubismPhysicsStrandBlock& block, csmInt32 baseLane,
+    CubismVector2 windDirection, csmFloat32 deltaTimeSeconds)
+{
+    csmFloat32* positionX = &state.PositionX[block.BaseParticleIndex];
+    csmFloat32* positionY = &state.PositionY[block.BaseParticleIndex];
+    csmFloat32* velocityX = &state.VelocityX[block.BaseParticleIndex];
+    csmFloat32* velocityY = &state.VelocityY[block.BaseParticleIndex];
+    const csmFloat32* acceleration = &state.Acceleration[block.BaseParticleIndex];
+    const csmFloat32* delays = &state.Delay[block.BaseParticleIndex];
+    const csmFloat32* radius = &state.Radius[block.BaseParticleIndex];
+    const csmFloat32* mobility = &state.Mobility[block.BaseParticleIndex];
+
+    const FloatBlock gravityX = LoadBlock(&state.GravityX[baseLane]);
+    const FloatBlock gravityY = LoadBlock(&state.GravityY[baseLane]);
+    const FloatBlock rotationCos = LoadBlock(&state.RotationCos[baseLane]);
+    const FloatBlock rotationSin = LoadBlock(&state.RotationSin[baseLane]);
+    const FloatBlock threshold = LoadBlock(&state.Threshold[baseLane]);
+    const FloatBlock windX = SetBlock(windDirection.X);
+    const FloatBlock windY = SetBlock(windDirection.Y);
+    const FloatBlock deltaTime = SetBlock(deltaTimeSeconds);
+    const FloatBlock frameRate = SetBlock(30.0f);
+
+    FloatBlock previousX = LoadBlock(&state.RootX[baseLane]);
+    FloatBlock previousY = LoadBlock(&state.RootY[baseLane]);
+
+    StoreBlock(positionX, previousX);
+    StoreBlock(positionY, previousY);
+
+    for (csmInt32 i = 1, offset = BlockLanes; i < block.ParticleCount; ++i, offset += BlockLanes)
+    {
+        const FloatBlock lastX = LoadBlock(positionX + offset);
+        const FloatBlock lastY = LoadBlock(positionY + offset);
+        const FloatBlock particleAcceleration = LoadBlock(acceleration + offset);
+
+        const FloatBlock forceX = AddBlock(MulBlock(gravityX, particleAcceleration), windX);
+        const FloatBlock forceY = AddBlock(MulBlock(gravityY, particleAcceleration), windY);
+
+        const FloatBlock delay = MulBlock(MulBlock(LoadBlock(delays + offset), deltaTime), frameRate);
+
+        FloatBlock directionX = SubBlock(lastX, previousX);
+        FloatBlock directionY = SubBlock(lastY, previousY);
+
+        directionX = SubBlock(MulBlock(rotationCos, directionX), MulBlock(directionY, rotationSin));
+        directionY = AddBlock(MulBlock(rotationSin, directionX), MulBlock(directionY, rotationCos));
+
+        FloatBlock x = AddBlock(previousX, directionX);
+        FloatBlock y = AddBlock(previousY, directionY);
+
+        const FloatBlock oldVelocityX = LoadBlock(velocityX + offset);
+        const FloatBlock oldVelocityY = LoadBlock(velocityY + offset);
+
+        x = AddBlock(AddBlock(x, MulBlock(oldVelocityX, delay)), MulBlock(MulBlock(forceX, delay), delay));
+        y = AddBlock(AddBlock(y, MulBlock(oldVelocityY, delay)), MulBlock(MulBlock(forceY, delay), delay));
+
+        FloatBlock newDirectionX = SubBlock(x, previousX);
+        FloatBlock newDirectionY = SubBlock(y, previousY);
+
+        const FloatBlock length = LengthBlock(AddBlock(MulBlock(newDirectionX, newDirectionX), MulBlock(newDirectionY, newDirectionY)));
+        newDirectionX = DivBlock(newDirectionX, length);
+        newDirectionY = DivBlock(newDirectionY, length);
+
+        const FloatBlock particleRadius = LoadBlock(radius + offset);
+        x = ZeroBelowThresholdBlock(AddBlock(previousX, MulBlock(newDirectionX, particleRadius)), threshold);
+        y = AddBlock(previousY, MulBlock(newDirectionY, particleRadius));
+
+        const FloatBlock particleMobility = LoadBlock(mobility + offset);
+        const FloatBlock newVelocityX = MulBlock(DivBlock(SubBlock(x, lastX), delay), particleMobility);
+        const FloatBlock newVelocityY = MulBlock(DivBlock(SubBlock(y, lastY), delay), particleMobility);
+
+        StoreBlock(velocityX + offset, SelectNonZeroBlock(delay, newVelocityX, oldVelocityX));
+        StoreBlock(velocityY + offset, SelectNonZeroBlock(delay, newVelocityY, oldVelocityY));
+        StoreBlock(positionX + offset, x);
+        StoreBlock(positionY + offset, y);
+
+        previousX = x;
+        previousY = y;
+    }
+
+    StoreBlock(&state.LastGravityX[baseLane], gravityX);
+    StoreBlock(&state.LastGravityY[baseLane], gravityY);
+}
+
 }
 
 CubismPhysics::CubismPhysics()
     : _physicsRig(NULL)
+    , _outputWeight(0.0f)
+    , _isOutputPending(false)
+    , _skippedFrameCount(0)
+    , _boundModel(NULL)
+    , _parameterValues(NULL)
+    , _parameterMaximumValues(NULL)
+    , _parameterMinimumValues(NULL)
+    , _parameterDefaultValues(NULL)
 {
     // set default options.
     _options.Gravity.Y = -1.0f;
     _options.Gravity.X = 0;
     _options.Wind.X = 0;
     _options.Wind.Y = 0;
+    _options.Solver = SolverType_Reference;
+    _options.MaxSubSteps = 0;
+    _options.FpsScale = 1.0f;
+    _options.SkipFrames = 0;
+    _options.SleepVelocityThreshold = 0.0f;
+    _options.WakeInputEpsilon = 0.0f;
     _currentRemainTime = 0.0f;
 }
 
@@ -468,6 +740,11 @@ void CubismPhysics::Initialize()
     csmInt32 i, settingIndex;
     CubismVector2 radius;
 
+    // 物理点を初期化するので、振り子の状態は読み込み直し、休止も解く
+    _strandState.IsLoaded = false;
+    _restStates.Clear();
+    _restStates.Resize(_physicsRig->SubRigCount);
+
     for (settingIndex = 0; settingIndex < _physicsRig->SubRigCount; ++settingIndex)
     {
         currentSetting = &_physicsRig->Settings[settingIndex];
@@ -518,7 +795,14 @@ CubismPhysics* CubismPhysics::Create(const csmByte* buffer, csmSizeInt size)
 {
     CubismPhysics* ret = CSM_NEW CubismPhysics();
 
-    ret->Parse(buffer, size);
+    if (IsBinary(buffer, size))
+    {
+        ret->ParseBinary(buffer, size);
+    }
+    else
+    {
+        ret->Parse(buffer, size);
+    }
 
     if (!ret->_isJsonValid)
     {
@@ -530,6 +814,22 @@ CubismPhysics* CubismPhysics::Create(const csmByte* buffer, csmSizeInt size)
     return ret;
 }
 
+CubismPhysics* CubismPhysics::Create(const CubismPhysics* source)
+{
+    CubismPhysics* ret = CSM_NEW CubismPhysics();
+
+    ret->_physicsRig = CSM_NEW CubismPhysicsRig(*source->_physicsRig);
+    ret->_options = source->_options;
+    ret->_currentRigOutputs = source->_currentRigOutputs;
+    ret->_previousRigOutputs = source->_previousRigOutputs;
+    ret->_isJsonValid = source->_isJsonValid;
+
+    // 複製元の物理演算状態を引き継がないよう初期化する
+    ret->Initialize();
+
+    return ret;
+}
+
 void CubismPhysics::Delete(CubismPhysics* physics)
 {
     CSM_DELETE_SELF(CubismPhysics, physics);
@@ -580,6 +880,7 @@ void CubismPhysics::Parse(const csmByte* physicsJson, csmSizeInt size)
         for (csmInt32 j = 0; j < _physicsRig->Settings[i].InputCount; ++j)
         {
             _physicsRig->Inputs[inputIndex + j].SourceParameterIndex = -1;
+            _physicsRig->Inputs[inputIndex + j].SourceCacheIndex = -1;
             _physicsRig->Inputs[inputIndex + j].Weight = json->GetInputWeight(i, j);
             _physicsRig->Inputs[inputIndex + j].Reflect = json->GetInputReflect(i, j);
 
@@ -619,6 +920,7 @@ void CubismPhysics::Parse(const csmByte* physicsJson, csmSizeInt size)
         for (csmInt32 j = 0; j < _physicsRig->Settings[i].OutputCount; ++j)
         {
             _physicsRig->Outputs[outputIndex + j].DestinationParameterIndex = -1;
+            _physicsRig->Outputs[outputIndex + j].DestinationCacheIndex = -1;
             _physicsRig->Outputs[outputIndex + j].VertexIndex = json->GetOutputVertexIndex(i, j);
             _physicsRig->Outputs[outputIndex + j].AngleScale = json->GetOutputAngleScale(i, j);
             _physicsRig->Outputs[outputIndex + j].Weight = json->GetOutputWeight(i, j);
@@ -669,6 +971,224 @@ void CubismPhysics::Parse(const csmByte* physicsJson, csmSizeInt size)
 }
 
 
+void CubismPhysics::ParseBinary(const csmByte* physicsBinary, csmSizeInt size)
+{
+    _physicsRig = CSM_NEW CubismPhysicsRig;
+
+    _currentRigOutputs.Clear();
+    _previousRigOutputs.Clear();
+
+    Utils::CubismBinaryReader reader(physicsBinary, size);
+
+    _isJsonValid = reader.ReadUint32() == PhysicsBinaryMagic && reader.ReadUint32() == PhysicsBinaryVersion;
+
+    if (!_isJsonValid)
+    {
+        CubismLogError("Unsupported physics snapshot.");
+        return;
+    }
+
+    _physicsRig->Fps = reader.ReadFloat32();
+    _physicsRig->Gravity.X = reader.ReadFloat32();
+    _physicsRig->Gravity.Y = reader.ReadFloat32();
+    _physicsRig->Wind.X = reader.ReadFloat32();
+    _physicsRig->Wind.Y = reader.ReadFloat32();
+    _physicsRig->SubRigCount = reader.ReadCount(sizeof(csmFloat32) * 9);
+
+    for (csmInt32 i = 0; i < _physicsRig->SubRigCount && _isJsonValid; ++i)
+    {
+        CubismPhysicsSubRig setting;
+        setting.NormalizationPosition.Minimum = reader.ReadFloat32();
+        setting.NormalizationPosition.Maximum = reader.ReadFloat32();
+        setting.NormalizationPosition.Default = reader.ReadFloat32();
+        setting.NormalizationAngle.Minimum = reader.ReadFloat32();
+        setting.NormalizationAngle.Maximum = reader.ReadFloat32();
+        setting.NormalizationAngle.Default = reader.ReadFloat32();
+
+        // Input
+        setting.InputCount = reader.ReadCount(sizeof(csmUint32) * 4);
+        setting.BaseInputIndex = _physicsRig->Inputs.GetSize();
+        for (csmInt32 j = 0; j < setting.InputCount && _isJsonValid; ++j)
+        {
+            CubismPhysicsInput input = CubismPhysicsInput();
+            input.Source.TargetType = CubismPhysicsTargetType_Parameter;
+            input.Source.Id = CubismFramework::GetIdManager()->GetId(reader.ReadString());
+            input.SourceParameterIndex = -1;
+            input.SourceCacheIndex = -1;
+            input.Weight = reader.ReadFloat32();
+            input.Reflect = static_cast<csmInt16>(reader.ReadInt32());
+            input.Type = static_cast<csmInt16>(reader.ReadInt32());
+
+            switch (input.Type)
+            {
+            case CubismPhysicsSource_X:
+                input.GetNormalizedParameterValue = GetInputTranslationXFromNormalizedParameterValue;
+                break;
+            case CubismPhysicsSource_Y:
+                input.GetNormalizedParameterValue = GetInputTranslationYFromNormalizedParameterValue;
+                break;
+            case CubismPhysicsSource_Angle:
+                input.GetNormalizedParameterValue = GetInputAngleFromNormalizedParameterValue;
+                break;
+            default:
+                _isJsonValid = false;
+                break;
+            }
+
+            _physicsRig->Inputs.PushBack(input);
+        }
+
+        // Output
+        setting.OutputCount = reader.ReadCount(sizeof(csmUint32) * 6);
+        setting.BaseOutputIndex = _physicsRig->Outputs.GetSize();
+        for (csmInt32 j = 0; j < setting.OutputCount && _isJsonValid; ++j)
+        {
+            CubismPhysicsOutput output = CubismPhysicsOutput();
+            output.Destination.TargetType = CubismPhysicsTargetType_Parameter;
+            output.Destination.Id = CubismFramework::GetIdManager()->GetId(reader.ReadString());
+            output.DestinationParameterIndex = -1;
+            output.DestinationCacheIndex = -1;
+            output.VertexIndex = reader.ReadInt32();
+            output.AngleScale = reader.ReadFloat32();
+            output.Weight = reader.ReadFloat32();
+            output.Reflect = static_cast<csmInt16>(reader.ReadInt32());
+
+            switch (reader.ReadInt32())
+            {
+            case CubismPhysicsSource_X:
+                output.Type = CubismPhysicsSource_X;
+                output.GetValue = GetOutputTranslationX;
+                output.GetScale = GetOutputScaleTranslationX;
+                break;
+            case CubismPhysicsSource_Y:
+                output.Type = CubismPhysicsSource_Y;
+                output.GetValue = GetOutputTranslationY;
+                output.GetScale = GetOutputScaleTranslationY;
+                break;
+            case CubismPhysicsSource_Angle:
+                output.Type = CubismPhysicsSource_Angle;
+                output.GetValue = GetOutputAngle;
+                output.GetScale = GetOutputScaleAngle;
+                break;
+            default:
+                _isJsonValid = false;
+                break;
+            }
+
+            _physicsRig->Outputs.PushBack(output);
+        }
+
+        // Particle
+        setting.ParticleCount = reader.ReadCount(sizeof(csmFloat32) * 6);
+        setting.BaseParticleIndex = _physicsRig->Particles.GetSize();
+        for (csmInt32 j = 0; j < setting.ParticleCount; ++j)
+        {
+            CubismPhysicsParticle particle = CubismPhysicsParticle();
+            particle.Mobility = reader.ReadFloat32();
+            particle.Delay = reader.ReadFloat32();
+            particle.Acceleration = reader.ReadFloat32();
+            particle.Radius = reader.ReadFloat32();
+            particle.Position.X = reader.ReadFloat32();
+            particle.Position.Y = reader.ReadFloat32();
+            _physicsRig->Particles.PushBack(particle);
+        }
+
+        // 出力が参照する振り子の位置がサブリグの範囲内かを確認する
+        for (csmInt32 j = 0; j < setting.OutputCount && _isJsonValid; ++j)
+        {
+            const csmInt32 vertexIndex = _physicsRig->Outputs[setting.BaseOutputIndex + j].VertexIndex;
+            _isJsonValid = vertexIndex >= 0 && vertexIndex < setting.ParticleCount;
+        }
+
+        _physicsRig->Settings.PushBack(setting);
+
+        PhysicsOutput rigOutput;
+        rigOutput.outputs.Resize(setting.OutputCount);
+        _currentRigOutputs.PushBack(rigOutput);
+        _previousRigOutputs.PushBack(rigOutput);
+    }
+
+    _isJsonValid = _isJsonValid && reader.IsFinished();
+
+    if (!_isJsonValid)
+    {
+        CubismLogError("Physics snapshot is corrupted.");
+        return;
+    }
+
+    Initialize();
+}
+
+csmBool CubismPhysics::IsBinary(const csmByte* buffer, csmSizeInt size)
+{
+    Utils::CubismBinaryReader reader(buffer, size);
+
+    return reader.ReadUint32() == PhysicsBinaryMagic && reader.IsValid();
+}
+
+void CubismPhysics::WriteBinary(csmVector<csmByte>& buffer) const
+{
+    buffer.Clear();
+
+    Utils::CubismBinaryWriter writer(buffer);
+
+    writer.WriteUint32(PhysicsBinaryMagic);
+    writer.WriteUint32(PhysicsBinaryVersion);
+    writer.WriteFloat32(_physicsRig->Fps);
+    writer.WriteFloat32(_physicsRig->Gravity.X);
+    writer.WriteFloat32(_physicsRig->Gravity.Y);
+    writer.WriteFloat32(_physicsRig->Wind.X);
+    writer.WriteFloat32(_physicsRig->Wind.Y);
+    writer.WriteInt32(_physicsRig->SubRigCount);
+
+    for (csmInt32 i = 0; i < _physicsRig->SubRigCount; ++i)
+    {
+        const CubismPhysicsSubRig& setting = _physicsRig->Settings[i];
+        writer.WriteFloat32(setting.NormalizationPosition.Minimum);
+        writer.WriteFloat32(setting.NormalizationPosition.Maximum);
+        writer.WriteFloat32(setting.NormalizationPosition.Default);
+        writer.WriteFloat32(setting.NormalizationAngle.Minimum);
+        writer.WriteFloat32(setting.NormalizationAngle.Maximum);
+        writer.WriteFloat32(setting.NormalizationAngle.Default);
+
+        writer.WriteInt32(setting.InputCount);
+        for (csmInt32 j = 0; j < setting.InputCount; ++j)
+        {
+            const CubismPhysicsInput& input = _physicsRig->Inputs[setting.BaseInputIndex + j];
+            writer.WriteString(input.Source.Id->GetString());
+            writer.WriteFloat32(input.Weight);
+            writer.WriteInt32(input.Reflect);
+            writer.WriteInt32(input.Type);
+        }
+
+        writer.WriteInt32(setting.OutputCount);
+        for (csmInt32 j = 0; j < setting.OutputCount; ++j)
+        {
+            const CubismPhysicsOutput& output = _physicsRig->Outputs[setting.BaseOutputIndex + j];
+            writer.WriteString(output.Destination.Id->GetString());
+            writer.WriteInt32(output.VertexIndex);
+            writer.WriteFloat32(output.AngleScale);
+            writer.WriteFloat32(output.Weight);
+            writer.WriteInt32(output.Reflect);
+            writer.WriteInt32(output.Type);
+        }
+
+        // 速度などの状態はInitializeで作り直されるため書き出さない
+        writer.WriteInt32(setting.ParticleCount);
+        for (csmInt32 j = 0; j < setting.ParticleCount; ++j)
+        {
+            const CubismPhysicsParticle& particle = _physicsRig->Particles[setting.BaseParticleIndex + j];
+            writer.WriteFloat32(particle.Mobility);
+            writer.WriteFloat32(particle.Delay);
+            writer.WriteFloat32(particle.Acceleration);
+            writer.WriteFloat32(particle.Radius);
+            writer.WriteFloat32(particle.Position.X);
+            writer.WriteFloat32(particle.Position.Y);
+        }
+    }
+}
+
+
 void CubismPhysics::Stabilization(CubismModel* model)
 {
     csmFloat32 totalAngle;
@@ -682,29 +1202,20 @@ void CubismPhysics::Stabilization(CubismModel* model)
     CubismPhysicsOutput* currentOutputs;
     CubismPhysicsParticle* currentParticles;
 
-    csmFloat32* parameterValues;
-    const csmFloat32* parameterMaximumValues;
-    const csmFloat32* parameterMinimumValues;
-    const csmFloat32* parameterDefaultValues;
-
-    parameterValues = Core::csmGetParameterValues(model->GetModel());
-    parameterMaximumValues = Core::csmGetParameterMaximumValues(model->GetModel());
-    parameterMinimumValues = Core::csmGetParameterMinimumValues(model->GetModel());
-    parameterDefaultValues = Core::csmGetParameterDefaultValues(model->GetModel());
+    Bind(model);
 
-    if (_parameterCaches.GetSize() < model->GetParameterCount())
-    {
-        _parameterCaches.Resize(model->GetParameterCount());
-    }
-    if (_parameterInputCaches.GetSize() < model->GetParameterCount())
+    // 物理点を置き直すので、振り子の状態は読み込み直し、休止も解く
+    _strandState.IsLoaded = false;
+    for (i = 0; i < static_cast<csmInt32>(_restStates.GetSize()); ++i)
     {
-        _parameterInputCaches.Resize(model->GetParameterCount());
+        _restStates[i].IsSleeping = false;
+        _restStates[i].RestTickCount = 0;
     }
 
-    for (int j = 0; j < model->GetParameterCount(); ++j)
+    for (i = 0; i < static_cast<csmInt32>(_boundParameterIndices.GetSize()); ++i)
     {
-        _parameterCaches[j] = parameterValues[j];
-        _parameterInputCaches[j] = parameterValues[j];
+        _parameterCaches[i] = _parameterValues[_boundParameterIndices[i]];
+        _parameterInputCaches[i] = _parameterValues[_boundParameterIndices[i]];
     }
 
     for (settingIndex = 0; settingIndex < _physicsRig->SubRigCount; ++settingIndex)
@@ -724,24 +1235,24 @@ void CubismPhysics::Stabilization(CubismModel* model)
 
             if (currentInputs[i].SourceParameterIndex == -1)
             {
-                currentInputs[i].SourceParameterIndex = model->GetParameterIndex(currentInputs[i].Source.Id);
+                continue;
             }
 
             currentInputs[i].GetNormalizedParameterValue(
                 &totalTranslation,
                 &totalAngle,
-                parameterValues[currentInputs[i].SourceParameterIndex],
-                parameterMinimumValues[currentInputs[i].SourceParameterIndex],
-                parameterMaximumValues[currentInputs[i].SourceParameterIndex],
-                parameterDefaultValues[currentInputs[i].SourceParameterIndex],
+                _parameterValues[currentInputs[i].SourceParameterIndex],
+                _parameterMinimumValues[currentInputs[i].SourceParameterIndex],
+                _parameterMaximumValues[currentInputs[i].SourceParameterIndex],
+                _parameterDefaultValues[currentInputs[i].SourceParameterIndex],
                 &currentSetting->NormalizationPosition,
                 &currentSetting->NormalizationAngle,
                 currentInputs[i].Reflect,
                 weight
             );
 
-            _parameterCaches[currentInputs[i].SourceParameterIndex] =
-                parameterValues[currentInputs[i].SourceParameterIndex];
+            _parameterCaches[currentInputs[i].SourceCacheIndex] =
+                _parameterValues[currentInputs[i].SourceParameterIndex];
         }
 
         radAngle = CubismMath::DegreesToRadian(-totalAngle);
@@ -764,13 +1275,7 @@ void CubismPhysics::Stabilization(CubismModel* model)
         {
             particleIndex = currentOutputs[i].VertexIndex;
 
-            if (currentOutputs[i].DestinationParameterIndex == -1)
-            {
-                currentOutputs[i].DestinationParameterIndex = model->GetParameterIndex(
-                    currentOutputs[i].Destination.Id);
-            }
-
-            if (particleIndex < 1 || particleIndex >= currentSetting->ParticleCount)
+            if (currentOutputs[i].DestinationParameterIndex == -1 || particleIndex < 1 || particleIndex >= currentSetting->ParticleCount)
             {
                 continue;
             }
@@ -791,13 +1296,13 @@ void CubismPhysics::Stabilization(CubismModel* model)
             _previousRigOutputs[settingIndex].outputs[i] = outputValue;
 
             UpdateOutputParameterValue(
-                &parameterValues[currentOutputs[i].DestinationParameterIndex],
-                parameterMinimumValues[currentOutputs[i].DestinationParameterIndex],
-                parameterMaximumValues[currentOutputs[i].DestinationParameterIndex],
+                &_parameterValues[currentOutputs[i].DestinationParameterIndex],
+                _parameterMinimumValues[currentOutputs[i].DestinationParameterIndex],
+                _parameterMaximumValues[currentOutputs[i].DestinationParameterIndex],
                 outputValue,
                 &currentOutputs[i]);
 
-            _parameterCaches[currentOutputs[i].DestinationParameterIndex] = parameterValues[currentOutputs[i].DestinationParameterIndex];
+            _parameterCaches[currentOutputs[i].DestinationCacheIndex] = _parameterValues[currentOutputs[i].DestinationParameterIndex];
         }
     }
 }
@@ -841,68 +1346,93 @@ void CubismPhysics::Stabilization(CubismModel* model)
 /// @param model
 /// @param deltaTimeSeconds  rendering delta time.
 void CubismPhysics::Evaluate(CubismModel* model, csmFloat32 deltaTimeSeconds)
+{
+    Simulate(model, deltaTimeSeconds);
+    ApplyOutputs(model);
+}
+
+void CubismPhysics::Simulate(CubismModel* model, csmFloat32 deltaTimeSeconds)
 {
     csmFloat32 totalAngle;
-    csmFloat32 weight;
-    csmFloat32 radAngle;
-    csmFloat32 outputValue;
     CubismVector2 totalTranslation;
-    csmInt32 i, settingIndex, particleIndex;
+    csmInt32 i, settingIndex;
     CubismPhysicsSubRig* currentSetting;
-    CubismPhysicsInput* currentInputs;
-    CubismPhysicsOutput* currentOutputs;
-    CubismPhysicsParticle* currentParticles;
+
+    _isOutputPending = false;
 
     if (0.0f >= deltaTimeSeconds)
     {
         return;
     }
 
-    csmFloat32* parameterValues;
-    const csmFloat32* parameterMaximumValues;
-    const csmFloat32* parameterMinimumValues;
-    const csmFloat32* parameterDefaultValues;
-
     csmFloat32 physicsDeltaTime;
+    csmInt32 subStepCount;
     _currentRemainTime += deltaTimeSeconds;
-    if (_currentRemainTime > MaxDeltaTime)
+
+    if (_physicsRig->Fps > 0.0f)
     {
-        _currentRemainTime = 0.0f;
+        physicsDeltaTime = 1.0f / _physicsRig->Fps;
+    }
+    else
+    {
+        physicsDeltaTime = deltaTimeSeconds;
     }
 
-    parameterValues = Core::csmGetParameterValues(model->GetModel());
-    parameterMaximumValues = Core::csmGetParameterMaximumValues(model->GetModel());
-    parameterMinimumValues = Core::csmGetParameterMinimumValues(model->GetModel());
-    parameterDefaultValues = Core::csmGetParameterDefaultValues(model->GetModel());
+    if (_options.FpsScale > 0.0f && _options.FpsScale < 1.0f)
+    {
+        physicsDeltaTime /= _options.FpsScale;
+    }
 
-    if (_parameterCaches.GetSize() < model->GetParameterCount())
+    // 省いたフレームの時間を後でまとめて計算しないよう、省くフレームの数だけ1ステップを長くする
+    if (_options.SkipFrames > 0)
     {
-        _parameterCaches.Resize(model->GetParameterCount());
+        physicsDeltaTime *= static_cast<csmFloat32>(_options.SkipFrames + 1);
     }
-    if (_parameterInputCaches.GetSize() < model->GetParameterCount())
+
+    // 計算を省くフレームでは時間だけを進め、前回計算した2つの結果の間を補間し直す
+    if (_skippedFrameCount < _options.SkipFrames)
     {
-        _parameterInputCaches.Resize(model->GetParameterCount());
-        for (int j = 0; j < model->GetParameterCount(); ++j) {
-            _parameterInputCaches[j] = parameterValues[j];
-        }
+        ++_skippedFrameCount;
+        _outputWeight = CubismMath::Min(_currentRemainTime / physicsDeltaTime, 1.0f);
+        _isOutputPending = true;
+        return;
     }
+    _skippedFrameCount = 0;
 
-    if (_physicsRig->Fps > 0.0f)
+    // ステップ数の上限を超える分の時間は捨て、端数だけを残す。上限がなければ長すぎる時間をリセットする
+    if (_options.MaxSubSteps > 0)
     {
-        physicsDeltaTime = 1.0f / _physicsRig->Fps;
+        if (_currentRemainTime >= physicsDeltaTime * (_options.MaxSubSteps + 1))
+        {
+            _currentRemainTime = physicsDeltaTime * _options.MaxSubSteps + CubismMath::ModF(_currentRemainTime, physicsDeltaTime);
+        }
     }
-    else
+    else if (_currentRemainTime > MaxDeltaTime)
     {
-        physicsDeltaTime = deltaTimeSeconds;
+        _currentRemainTime = 0.0f;
+    }
+
+    Bind(model);
+
+    // 振り子をまとめた計算から切り替わった時は、物理点に状態を書き戻す
+    if (_options.Solver != SolverType_Simd && _strandState.IsLoaded)
+    {
+        StoreStrandState();
     }
 
-    while (_currentRemainTime >= physicsDeltaTime)
+    for (subStepCount = 0; _currentRemainTime >= physicsDeltaTime; ++subStepCount)
     {
+        // 丸め誤差で上限を超えるときは、残りの時間を端数にする
+        if (_options.MaxSubSteps > 0 && subStepCount >= _options.MaxSubSteps)
+        {
+            _currentRemainTime = CubismMath::ModF(_currentRemainTime, physicsDeltaTime);
+            break;
+        }
+
         // copyRigOutputs _currentRigOutputs to _previousRigOutputs
         for (settingIndex = 0; settingIndex < _physicsRig->SubRigCount; ++settingIndex)
         {
             currentSetting = &_physicsRig->Settings[settingIndex];
-            currentOutputs = &_physicsRig->Outputs[currentSetting->BaseOutputIndex];
             for (i = 0; i < currentSetting->OutputCount; ++i)
             {
                 _previousRigOutputs[settingIndex].outputs[i] = _currentRigOutputs[settingIndex].outputs[i];
@@ -913,107 +1443,65 @@ void CubismPhysics::Evaluate(CubismModel* model, csmFloat32 deltaTimeSeconds)
         // Calculate the input at the timing to UpdateParticles by linear interpolation with the _parameterInputCaches and parameterValues.
         // _parameterCachesはグループ間での値の伝搬の役割があるので_parameterInputCachesとの分離が必要。
         // _parameterCaches needs to be separated from _parameterInputCaches because of its role in propagating values between groups.
+        // 補間するのは物理演算が参照するパラメータだけ
         float inputWeight =  physicsDeltaTime / _currentRemainTime;
-        for (csmInt32 j = 0; j < model->GetParameterCount(); ++j)
+        for (csmInt32 j = 0; j < static_cast<csmInt32>(_boundParameterIndices.GetSize()); ++j)
         {
-            _parameterCaches[j] = _parameterInputCaches[j] * (1.0f - inputWeight) + parameterValues[j] * inputWeight;
+            _parameterCaches[j] = _parameterInputCaches[j] * (1.0f - inputWeight) + _parameterValues[_boundParameterIndices[j]] * inputWeight;
             _parameterInputCaches[j] = _parameterCaches[j];
         }
 
-        for (settingIndex = 0; settingIndex < _physicsRig->SubRigCount; ++settingIndex)
+        if (_options.Solver == SolverType_Simd)
         {
-            totalAngle = 0.0f;
-            totalTranslation.X = 0.0f;
-            totalTranslation.Y = 0.0f;
-            currentSetting = &_physicsRig->Settings[settingIndex];
-            currentInputs = &_physicsRig->Inputs[currentSetting->BaseInputIndex];
-            currentOutputs = &_physicsRig->Outputs[currentSetting->BaseOutputIndex];
-            currentParticles = &_physicsRig->Particles[currentSetting->BaseParticleIndex];
-
-            // Load input parameters.
-            for (i = 0; i < currentSetting->InputCount; ++i)
-            {
-                weight = currentInputs[i].Weight / MaximumWeight;
-
-                if (currentInputs[i].SourceParameterIndex == -1)
-                {
-                    currentInputs[i].SourceParameterIndex = model->GetParameterIndex(currentInputs[i].Source.Id);
-                }
-
-                currentInputs[i].GetNormalizedParameterValue(
-                    &totalTranslation,
-                    &totalAngle,
-                    _parameterCaches[currentInputs[i].SourceParameterIndex],
-                    parameterMinimumValues[currentInputs[i].SourceParameterIndex],
-                    parameterMaximumValues[currentInputs[i].SourceParameterIndex],
-                    parameterDefaultValues[currentInputs[i].SourceParameterIndex],
-                    &currentSetting->NormalizationPosition,
-                    &currentSetting->NormalizationAngle,
-                    currentInputs[i].Reflect,
-                    weight
-                );
-            }
-
-            radAngle = CubismMath::DegreesToRadian(-totalAngle);
-
-            totalTranslation.X = (totalTranslation.X * CubismMath::CosF(radAngle) - totalTranslation.Y * CubismMath::SinF(radAngle));
-            totalTranslation.Y = (totalTranslation.X * CubismMath::SinF(radAngle) + totalTranslation.Y * CubismMath::CosF(radAngle));
-
-            // Calculate particles position.
-            UpdateParticles(
-                currentParticles,
-                currentSetting->ParticleCount,
-                totalTranslation,
-                totalAngle,
-                _options.Wind,
-                MovementThreshold * currentSetting->NormalizationPosition.Maximum,
-                physicsDeltaTime,
-                AirResistance
-            );
-
-            // Update output parameters.
-            for (i = 0; i < currentSetting->OutputCount; ++i)
+            UpdateStrands(model, physicsDeltaTime);
+        }
+        else
+        {
+            for (settingIndex = 0; settingIndex < _physicsRig->SubRigCount; ++settingIndex)
             {
-                particleIndex = currentOutputs[i].VertexIndex;
+                currentSetting = &_physicsRig->Settings[settingIndex];
 
-                if (currentOutputs[i].DestinationParameterIndex == -1)
-                {
-                    currentOutputs[i].DestinationParameterIndex = model->GetParameterIndex(currentOutputs[i].Destination.Id);
-                }
+                LoadInputs(model, settingIndex, &totalTranslation, &totalAngle);
 
-                if (particleIndex < 1 || particleIndex >= currentSetting->ParticleCount)
+                if (CheckRestInputs(settingIndex, totalTranslation, totalAngle))
                 {
+                    ReuseOutputs(model, settingIndex);
                     continue;
                 }
 
-                CubismVector2 translation;
-                translation.X = currentParticles[particleIndex].Position.X - currentParticles[particleIndex - 1].Position.X;
-                translation.Y = currentParticles[particleIndex].Position.Y - currentParticles[particleIndex - 1].Position.Y;
-
-                outputValue = currentOutputs[i].GetValue(
-                    translation,
-                    currentParticles,
-                    particleIndex,
-                    currentOutputs[i].Reflect,
-                    _options.Gravity
+                // Calculate particles position.
+                UpdateParticles(
+                    &_physicsRig->Particles[currentSetting->BaseParticleIndex],
+                    currentSetting->ParticleCount,
+                    totalTranslation,
+                    totalAngle,
+                    _options.Wind,
+                    MovementThreshold * currentSetting->NormalizationPosition.Maximum,
+                    physicsDeltaTime,
+                    AirResistance
                 );
 
-                _currentRigOutputs[settingIndex].outputs[i] = outputValue;
-
-                UpdateOutputParameterValue(
-                        &_parameterCaches[currentOutputs[i].DestinationParameterIndex],
-                        parameterMinimumValues[currentOutputs[i].DestinationParameterIndex],
-                        parameterMaximumValues[currentOutputs[i].DestinationParameterIndex],
-                        outputValue,
-                        &currentOutputs[i]);
+                UpdateOutputs(model, settingIndex);
+                UpdateRestState(settingIndex, GetMaxVelocity(&_physicsRig->Particles[currentSetting->BaseParticleIndex], currentSetting->ParticleCount));
             }
         }
 
         _currentRemainTime -= physicsDeltaTime;
     }
 
-    const float alpha = _currentRemainTime / physicsDeltaTime;
-    Interpolate(model, alpha);
+    _outputWeight = _currentRemainTime / physicsDeltaTime;
+    _isOutputPending = true;
+}
+
+void CubismPhysics::ApplyOutputs(CubismModel* model)
+{
+    if (!_isOutputPending)
+    {
+        return;
+    }
+
+    Interpolate(model, _outputWeight);
+    _isOutputPending = false;
 }
 
 void CubismPhysics::Interpolate(CubismModel* model, csmFloat32 weight)
@@ -1021,13 +1509,8 @@ void CubismPhysics::Interpolate(CubismModel* model, csmFloat32 weight)
     csmInt32 i, settingIndex;
     CubismPhysicsOutput* currentOutputs;
     CubismPhysicsSubRig* currentSetting;
-    csmFloat32* parameterValues;
-    const csmFloat32* parameterMaximumValues;
-    const csmFloat32* parameterMinimumValues;
 
-    parameterValues = Core::csmGetParameterValues(model->GetModel());
-    parameterMaximumValues = Core::csmGetParameterMaximumValues(model->GetModel());
-    parameterMinimumValues = Core::csmGetParameterMinimumValues(model->GetModel());
+    Bind(model);
 
     for (settingIndex = 0; settingIndex < _physicsRig->SubRigCount; ++settingIndex)
     {
@@ -1043,9 +1526,9 @@ void CubismPhysics::Interpolate(CubismModel* model, csmFloat32 weight)
             }
 
             UpdateOutputParameterValue(
-                &parameterValues[currentOutputs[i].DestinationParameterIndex],
-                parameterMinimumValues[currentOutputs[i].DestinationParameterIndex],
-                parameterMaximumValues[currentOutputs[i].DestinationParameterIndex],
+                &_parameterValues[currentOutputs[i].DestinationParameterIndex],
+                _parameterMinimumValues[currentOutputs[i].DestinationParameterIndex],
+                _parameterMaximumValues[currentOutputs[i].DestinationParameterIndex],
                 _previousRigOutputs[settingIndex].outputs[i] * (1 - weight) + _currentRigOutputs[settingIndex].outputs[i] * weight,
                 &currentOutputs[i]
             );
@@ -1053,9 +1536,528 @@ void CubismPhysics::Interpolate(CubismModel* model, csmFloat32 weight)
     }
 }
 
+void CubismPhysics::LoadInputs(CubismModel* model, csmInt32 settingIndex, CubismVector2* totalTranslation, csmFloat32* totalAngle)
+{
+    csmFloat32 weight;
+    csmFloat32 radAngle;
+    csmInt32 i;
+
+    CubismPhysicsSubRig* currentSetting = &_physicsRig->Settings[settingIndex];
+    CubismPhysicsInput* currentInputs = &_physicsRig->Inputs[currentSetting->BaseInputIndex];
+
+    *totalAngle = 0.0f;
+    totalTranslation->X = 0.0f;
+    totalTranslation->Y = 0.0f;
+
+    // Load input parameters.
+    for (i = 0; i < currentSetting->InputCount; ++i)
+    {
+        weight = currentInputs[i].Weight / MaximumWeight;
+
+        if (currentInputs[i].SourceParameterIndex == -1)
+        {
+            continue;
+        }
+
+        currentInputs[i].GetNormalizedParameterValue(
+            totalTranslation,
+            totalAngle,
+            _parameterCaches[currentInputs[i].SourceCacheIndex],
+            _parameterMinimumValues[currentInputs[i].SourceParameterIndex],
+            _parameterMaximumValues[currentInputs[i].SourceParameterIndex],
+            _parameterDefaultValues[currentInputs[i].SourceParameterIndex],
+            &currentSetting->NormalizationPosition,
+            &currentSetting->NormalizationAngle,
+            currentInputs[i].Reflect,
+            weight
+        );
+    }
+
+    radAngle = CubismMath::DegreesToRadian(-*totalAngle);
+
+    totalTranslation->X = (totalTranslation->X * CubismMath::CosF(radAngle) - totalTranslation->Y * CubismMath::SinF(radAngle));
+    totalTranslation->Y = (totalTranslation->X * CubismMath::SinF(radAngle) + totalTranslation->Y * CubismMath::CosF(radAngle));
+}
+
+void CubismPhysics::UpdateOutputs(CubismModel* model, csmInt32 settingIndex)
+{
+    csmFloat32 outputValue;
+    csmInt32 i, particleIndex;
+
+    CubismPhysicsSubRig* currentSetting = &_physicsRig->Settings[settingIndex];
+    CubismPhysicsOutput* currentOutputs = &_physicsRig->Outputs[currentSetting->BaseOutputIndex];
+    CubismPhysicsParticle* currentParticles = &_physicsRig->Particles[currentSetting->BaseParticleIndex];
+
+    // Update output parameters.
+    for (i = 0; i < currentSetting->OutputCount; ++i)
+    {
+        particleIndex = currentOutputs[i].VertexIndex;
+
+        if (currentOutputs[i].DestinationParameterIndex == -1 || particleIndex < 1 || particleIndex >= currentSetting->ParticleCount)
+        {
+            continue;
+        }
+
+        CubismVector2 translation;
+        translation.X = currentParticles[particleIndex].Position.X - currentParticles[particleIndex - 1].Position.X;
+        translation.Y = currentParticles[particleIndex].Position.Y - currentParticles[particleIndex - 1].Position.Y;
+
+        outputValue = currentOutputs[i].GetValue(
+            translation,
+            currentParticles,
+            particleIndex,
+            currentOutputs[i].Reflect,
+            _options.Gravity
+        );
+
+        _currentRigOutputs[settingIndex].outputs[i] = outputValue;
+
+        UpdateOutputParameterValue(
+                &_parameterCaches[currentOutputs[i].DestinationCacheIndex],
+                _parameterMinimumValues[currentOutputs[i].DestinationParameterIndex],
+                _parameterMaximumValues[currentOutputs[i].DestinationParameterIndex],
+                outputValue,
+                &currentOutputs[i]);
+    }
+}
+
+void CubismPhysics::Bind(CubismModel* model)
+{
+    if (_boundModel == model)
+    {
+        return;
+    }
+
+    const csmInt32 parameterCount = model->GetParameterCount();
+    csmVector<csmInt32> cacheIndices;
+    cacheIndices.Assign(parameterCount, -1, false);
+    _boundParameterIndices.Clear();
+
+    // モデルにないパラメータは-1にして、入出力を飛ばす
+    for (csmUint32 i = 0; i < _physicsRig->Inputs.GetSize(); ++i)
+    {
+        CubismPhysicsInput& input = _physicsRig->Inputs[i];
+        input.SourceParameterIndex = model->GetParameterIndex(input.Source.Id);
+        input.SourceParameterIndex = input.SourceParameterIndex < parameterCount ? input.SourceParameterIndex : -1;
+        input.SourceCacheIndex = GetCacheIndex(cacheIndices, _boundParameterIndices, input.SourceParameterIndex);
+    }
+
+    for (csmUint32 i = 0; i < _physicsRig->Outputs.GetSize(); ++i)
+    {
+        CubismPhysicsOutput& output = _physicsRig->Outputs[i];
+        output.DestinationParameterIndex = model->GetParameterIndex(output.Destination.Id);
+        output.DestinationParameterIndex = output.DestinationParameterIndex < parameterCount ? output.DestinationParameterIndex : -1;
+        output.DestinationCacheIndex = GetCacheIndex(cacheIndices, _boundParameterIndices, output.DestinationParameterIndex);
+    }
+
+    _parameterValues = Core::csmGetParameterValues(model->GetModel());
+    _parameterMaximumValues = Core::csmGetParameterMaximumValues(model->GetModel());
+    _parameterMinimumValues = Core::csmGetParameterMinimumValues(model->GetModel());
+    _parameterDefaultValues = Core::csmGetParameterDefaultValues(model->GetModel());
+
+    _parameterCaches.Clear();
+    _parameterInputCaches.Clear();
+    for (csmUint32 i = 0; i < _boundParameterIndices.GetSize(); ++i)
+    {
+        _parameterCaches.PushBack(_parameterValues[_boundParameterIndices[i]]);
+        _parameterInputCaches.PushBack(_parameterValues[_boundParameterIndices[i]]);
+    }
+
+    // 振り子の並びはパラメータのインデックスから作るので作り直す
+    if (_strandState.IsLoaded)
+    {
+        StoreStrandState();
+    }
+    _strandState.IsBuilt = false;
+
+    _boundModel = model;
+}
+
+csmBool CubismPhysics::CheckRestInputs(csmInt32 settingIndex, const CubismVector2& totalTranslation, csmFloat32 totalAngle)
+{
+    CubismPhysicsRestState& rest = _restStates[settingIndex];
+
+    rest.IsInputSteady = CubismMath::AbsF(totalTranslation.X - rest.Translation.X) <= _options.WakeInputEpsilon
+        && CubismMath::AbsF(totalTranslation.Y - rest.Translation.Y) <= _options.WakeInputEpsilon
+        && CubismMath::AbsF(totalAngle - rest.Angle) <= _options.WakeInputEpsilon;
+
+    if (rest.IsSleeping && rest.IsInputSteady)
+    {
+        return true;
+    }
+
+    rest.IsSleeping = false;
+    rest.Translation = totalTranslation;
+    rest.Angle = totalAngle;
+
+    return false;
+}
+
+void CubismPhysics::UpdateRestState(csmInt32 settingIndex, csmFloat32 maxVelocity)
+{
+    CubismPhysicsRestState& rest = _restStates[settingIndex];
+
+    // 振動の折り返しで一瞬止まっただけの設定を休止させないよう、続けて止まっていることを確かめる
+    if (rest.IsInputSteady && maxVelocity < _options.SleepVelocityThreshold)
+    {
+        ++rest.RestTickCount;
+    }
+    else
+    {
+        rest.RestTickCount = 0;
+    }
+
+    rest.IsSleeping = rest.RestTickCount >= SleepTickCount;
+}
+
+void CubismPhysics::ReuseOutputs(CubismModel* model, csmInt32 settingIndex)
+{
+    CubismPhysicsSubRig* currentSetting = &_physicsRig->Settings[settingIndex];
+    CubismPhysicsOutput* currentOutputs = &_physicsRig->Outputs[currentSetting->BaseOutputIndex];
+
+    for (csmInt32 i = 0; i < currentSetting->OutputCount; ++i)
+    {
+        const csmInt32 particleIndex = currentOutputs[i].VertexIndex;
+
+        if (currentOutputs[i].DestinationParameterIndex == -1 || particleIndex < 1 || particleIndex >= currentSetting->ParticleCount)
+        {
+            continue;
+        }
+
+        UpdateOutputParameterValue(
+                &_parameterCaches[currentOutputs[i].DestinationCacheIndex],
+                _parameterMinimumValues[currentOutputs[i].DestinationParameterIndex],
+                _parameterMaximumValues[currentOutputs[i].DestinationParameterIndex],
+                _currentRigOutputs[settingIndex].outputs[i],
+                &currentOutputs[i]);
+    }
+}
+
+/// Builds the strand layout for SolverType_Simd.
+///
+/// A setting that reads a parameter written by an earlier setting is placed in a later wave.
+/// A setting that writes a parameter read or written by an earlier setting is placed in the same or a later wave.
+/// Within a wave all inputs are loaded before any output is written, and outputs are written in setting order,
+/// so the results are the same as evaluating the settings one by one.
+void CubismPhysics::BuildStrandState(CubismModel* model)
+{
+    CubismPhysicsStrandState& state = _strandState;
+    csmInt32 i, j, k, settingIndex;
+
+    // Assign each setting to a wave. Parameter indices are already resolved by Bind.
+    csmVector<csmInt32> waveIndices;
+    csmInt32 waveCount = 0;
+    waveIndices.UpdateSize(_physicsRig->SubRigCount, 0, false);
+
+    for (settingIndex = 0; settingIndex < _physicsRig->SubRigCount; ++settingIndex)
+    {
+        const CubismPhysicsSubRig& setting = _physicsRig->Settings[settingIndex];
+        csmInt32 waveIndex = 0;
+
+        for (j = 0; j < settingIndex; ++j)
+        {
+            const CubismPhysicsSubRig& earlier = _physicsRig->Settings[j];
+
+            for (k = 0; k < earlier.OutputCount; ++k)
+            {
+                const csmInt32 written = _physicsRig->Outputs[earlier.BaseOutputIndex + k].DestinationParameterIndex;
+
+                for (i = 0; i < setting.InputCount; ++i)
+                {
+                    if (_physicsRig->Inputs[setting.BaseInputIndex + i].SourceParameterIndex == written)
+                    {
+                        waveIndex = CubismMath::Max(waveIndex, waveIndices[j] + 1);
+                    }
+                }
+            }
+
+            for (i = 0; i < setting.OutputCount; ++i)
+            {
+                const csmInt32 written = _physicsRig->Outputs[setting.BaseOutputIndex + i].DestinationParameterIndex;
+
+                for (k = 0; k < earlier.OutputCount; ++k)
+                {
+                    if (_physicsRig->Outputs[earlier.BaseOutputIndex + k].DestinationParameterIndex == written)
+                    {
+                        waveIndex = CubismMath::Max(waveIndex, waveIndices[j]);
+                    }
+                }
+
+                for (k = 0; k < earlier.InputCount; ++k)
+                {
+                    if (_physicsRig->Inputs[earlier.BaseInputIndex + k].SourceParameterIndex == written)
+                    {
+                        waveIndex = CubismMath::Max(waveIndex, waveIndices[j]);
+                    }
+                }
+            }
+        }
+
+        waveIndices[settingIndex] = waveIndex;
+        waveCount = CubismMath::Max(waveCount, waveIndex + 1);
+    }
+
+    // Lay out the waves, giving each one whole blocks of lanes.
+    state.Waves.Clear();
+    state.Blocks.Clear();
+    state.SettingOrder.Clear();
+    state.SettingLanes.UpdateSize(_physicsRig->SubRigCount, 0, false);
+
+    csmInt32 particleTotal = 0;
+
+    for (csmInt32 waveIndex = 0; waveIndex < waveCount; ++waveIndex)
+    {
+        CubismPhysicsStrandWave wave;
+        wave.BaseSettingIndex = state.SettingOrder.GetSize();
+        wave.BaseBlockIndex = state.Blocks.GetSize();
+
+        for (settingIndex = 0; settingIndex < _physicsRig->SubRigCount; ++settingIndex)
+        {
+            if (waveIndices[settingIndex] != waveIndex)
+            {
+                continue;
+            }
+
+            const csmInt32 lane = state.SettingOrder.GetSize() - wave.BaseSettingIndex;
+
+            if (lane % BlockLanes == 0)
+            {
+                CubismPhysicsStrandBlock block;
+                block.BaseParticleIndex = 0;
+                block.ParticleCount = 0;
+                block.IsSleeping = false;
+                state.Blocks.PushBack(block);
+            }
+
+            CubismPhysicsStrandBlock& block = state.Blocks[state.Blocks.GetSize() - 1];
+            block.ParticleCount = CubismMath::Max(block.ParticleCount, _physicsRig->Settings[settingIndex].ParticleCount);
+
+            state.SettingLanes[settingIndex] = wave.BaseBlockIndex * BlockLanes + lane;
+            state.SettingOrder.PushBack(settingIndex);
+        }
+
+        wave.SettingCount = state.SettingOrder.GetSize() - wave.BaseSettingIndex;
+        wave.BlockCount = state.Blocks.GetSize() - wave.BaseBlockIndex;
+        state.Waves.PushBack(wave);
+    }
+
+    for (i = 0; i < static_cast<csmInt32>(state.Blocks.GetSize()); ++i)
+    {
+        state.Blocks[i].BaseParticleIndex = particleTotal;
+        particleTotal += state.Blocks[i].ParticleCount * BlockLanes;
+    }
+
+    // Unused lanes hang straight down with unit length, so they stay finite.
+    state.PositionX.Assign(particleTotal, 0.0f, false);
+    state.PositionY.Assign(particleTotal, 0.0f, false);
+    state.VelocityX.Assign(particleTotal, 0.0f, false);
+    state.VelocityY.Assign(particleTotal, 0.0f, false);
+    state.Acceleration.Assign(particleTotal, 0.0f, false);
+    state.Delay.Assign(particleTotal, 0.0f, false);
+    state.Radius.Assign(particleTotal, 1.0f, false);
+    state.Mobility.Assign(particleTotal, 0.0f, false);
+
+    for (i = 0; i < static_cast<csmInt32>(state.Blocks.GetSize()); ++i)
+    {
+        for (j = 0; j < state.Blocks[i].ParticleCount * BlockLanes; ++j)
+        {
+            state.PositionY[state.Blocks[i].BaseParticleIndex + j] = static_cast<csmFloat32>(j / BlockLanes);
+        }
+    }
+
+    const csmInt32 laneTotal = state.Blocks.GetSize() * BlockLanes;
+    state.RootX.Assign(laneTotal, 0.0f, false);
+    state.RootY.Assign(laneTotal, 0.0f, false);
+    state.GravityX.Assign(laneTotal, 0.0f, false);
+    state.GravityY.Assign(laneTotal, 1.0f, false);
+    state.LastGravityX.Assign(laneTotal, 0.0f, false);
+    state.LastGravityY.Assign(laneTotal, 1.0f, false);
+    state.RotationCos.Assign(laneTotal, 1.0f, false);
+    state.RotationSin.Assign(laneTotal, 0.0f, false);
+    state.Threshold.Assign(laneTotal, 0.0f, false);
+
+    for (settingIndex = 0; settingIndex < _physicsRig->SubRigCount; ++settingIndex)
+    {
+        const CubismPhysicsSubRig& setting = _physicsRig->Settings[settingIndex];
+        const csmInt32 lane = state.SettingLanes[settingIndex];
+        const csmInt32 base = state.Blocks[lane / BlockLanes].BaseParticleIndex + lane % BlockLanes;
+
+        for (i = 0; i < setting.ParticleCount; ++i)
+        {
+            const CubismPhysicsParticle& particle = _physicsRig->Particles[setting.BaseParticleIndex + i];
+
+            state.Acceleration[base + i * BlockLanes] = particle.Acceleration;
+            state.Delay[base + i * BlockLanes] = particle.Delay;
+            state.Radius[base + i * BlockLanes] = particle.Radius;
+            state.Mobility[base + i * BlockLanes] = particle.Mobility;
+        }
+    }
+
+    state.IsBuilt = true;
+    state.IsLoaded = false;
+}
+
+void CubismPhysics::LoadStrandState()
+{
+    CubismPhysicsStrandState& state = _strandState;
+
+    for (csmInt32 settingIndex = 0; settingIndex < _physicsRig->SubRigCount; ++settingIndex)
+    {
+        const CubismPhysicsSubRig& setting = _physicsRig->Settings[settingIndex];
+        const CubismPhysicsParticle* strand = &_physicsRig->Particles[setting.BaseParticleIndex];
+        const csmInt32 lane = state.SettingLanes[settingIndex];
+        const csmInt32 base = state.Blocks[lane / BlockLanes].BaseParticleIndex + lane % BlockLanes;
+
+        for (csmInt32 i = 0; i < setting.ParticleCount; ++i)
+        {
+            state.PositionX[base + i * BlockLanes] = strand[i].Position.X;
+            state.PositionY[base + i * BlockLanes] = strand[i].Position.Y;
+            state.VelocityX[base + i * BlockLanes] = strand[i].Velocity.X;
+            state.VelocityY[base + i * BlockLanes] = strand[i].Velocity.Y;
+        }
+
+        // 先頭以外の物理点は常に同じ重力を持つ
+        if (setting.ParticleCount > 1)
+        {
+            state.LastGravityX[lane] = strand[1].LastGravity.X;
+            state.LastGravityY[lane] = strand[1].LastGravity.Y;
+        }
+    }
+
+    state.IsLoaded = true;
+}
+
+void CubismPhysics::StoreStrandState()
+{
+    CubismPhysicsStrandState& state = _strandState;
+
+    for (csmInt32 settingIndex = 0; settingIndex < _physicsRig->SubRigCount; ++settingIndex)
+    {
+        const CubismPhysicsSubRig& setting = _physicsRig->Settings[settingIndex];
+        CubismPhysicsParticle* strand = &_physicsRig->Particles[setting.BaseParticleIndex];
+        const csmInt32 lane = state.SettingLanes[settingIndex];
+        const csmInt32 base = state.Blocks[lane / BlockLanes].BaseParticleIndex + lane % BlockLanes;
+
+        for (csmInt32 i = 1; i < setting.ParticleCount; ++i)
+        {
+            strand[i].Velocity.X = state.VelocityX[base + i * BlockLanes];
+            strand[i].Velocity.Y = state.VelocityY[base + i * BlockLanes];
+            strand[i].LastGravity.X = state.LastGravityX[lane];
+            strand[i].LastGravity.Y = state.LastGravityY[lane];
+        }
+    }
+
+    state.IsLoaded = false;
+}
+
+void CubismPhysics::UpdateStrands(CubismModel* model, csmFloat32 deltaTimeSeconds)
+{
+    CubismPhysicsStrandState& state = _strandState;
+    csmFloat32 totalAngle;
+    CubismVector2 totalTranslation;
+    csmInt32 i, j;
+
+    if (!state.IsBuilt)
+    {
+        BuildStrandState(model);
+    }
+
+    if (!state.IsLoaded)
+    {
+        LoadStrandState();
+    }
+
+    for (csmInt32 waveIndex = 0; waveIndex < static_cast<csmInt32>(state.Waves.GetSize()); ++waveIndex)
+    {
+        const CubismPhysicsStrandWave& wave = state.Waves[waveIndex];
+
+        // Load inputs of every setting in the wave before any output is written.
+        for (i = 0; i < wave.SettingCount; ++i)
+        {
+            const csmInt32 settingIndex = state.SettingOrder[wave.BaseSettingIndex + i];
+            const csmInt32 lane = state.SettingLanes[settingIndex];
+
+            LoadInputs(model, settingIndex, &totalTranslation, &totalAngle);
+            CheckRestInputs(settingIndex, totalTranslation, totalAngle);
+
+            CubismVector2 currentGravity = CubismMath::RadianToDirection(CubismMath::DegreesToRadian(totalAngle));
+            currentGravity.Normalize();
+
+            const CubismVector2 lastGravity(state.LastGravityX[lane], state.LastGravityY[lane]);
+            const csmFloat32 radian = CubismMath::DirectionToRadian(lastGravity, currentGravity) / AirResistance;
+
+            state.RootX[lane] = totalTranslation.X;
+            state.RootY[lane] = totalTranslation.Y;
+            state.GravityX[lane] = currentGravity.X;
+            state.GravityY[lane] = currentGravity.Y;
+            state.RotationCos[lane] = CubismMath::CosF(radian);
+            state.RotationSin[lane] = CubismMath::SinF(radian);
+            state.Threshold[lane] = MovementThreshold * _physicsRig->Settings[settingIndex].NormalizationPosition.Maximum;
+        }
+
+        // Calculate particles position, skipping blocks whose settings all stay asleep.
+        for (i = 0; i < wave.BlockCount; ++i)
+        {
+            const csmInt32 blockIndex = wave.BaseBlockIndex + i;
+            CubismPhysicsStrandBlock& block = state.Blocks[blockIndex];
+
+            block.IsSleeping = true;
+            for (j = i * BlockLanes; j < CubismMath::Min((i + 1) * BlockLanes, wave.SettingCount); ++j)
+            {
+                block.IsSleeping = block.IsSleeping && _restStates[state.SettingOrder[wave.BaseSettingIndex + j]].IsSleeping;
+            }
+
+            if (!block.IsSleeping)
+            {
+                UpdateStrandBlock(state, block, blockIndex * BlockLanes, _options.Wind, deltaTimeSeconds);
+            }
+        }
+
+        // Copy positions back for the output getters, then update outputs in setting order.
+        for (i = 0; i < wave.SettingCount; ++i)
+        {
+            const csmInt32 settingIndex = state.SettingOrder[wave.BaseSettingIndex + i];
+            const CubismPhysicsSubRig& setting = _physicsRig->Settings[settingIndex];
+            CubismPhysicsParticle* strand = &_physicsRig->Particles[setting.BaseParticleIndex];
+            const csmInt32 lane = state.SettingLanes[settingIndex];
+            const csmInt32 base = state.Blocks[lane / BlockLanes].BaseParticleIndex + lane % BlockLanes;
+
+            if (state.Blocks[lane / BlockLanes].IsSleeping)
+            {
+                ReuseOutputs(model, settingIndex);
+                continue;
+            }
+
+            csmFloat32 maxVelocity = 0.0f;
+
+            for (j = 0; j < setting.ParticleCount; ++j)
+            {
+                strand[j].Position.X = state.PositionX[base + j * BlockLanes];
+                strand[j].Position.Y = state.PositionY[base + j * BlockLanes];
+
+                if (j > 0)
+                {
+                    maxVelocity = CubismMath::Max(maxVelocity, CubismMath::AbsF(state.VelocityX[base + j * BlockLanes]));
+                    maxVelocity = CubismMath::Max(maxVelocity, CubismMath::AbsF(state.VelocityY[base + j * BlockLanes]));
+                }
+            }
+
+            UpdateOutputs(model, settingIndex);
+            UpdateRestState(settingIndex, maxVelocity);
+        }
+    }
+}
+
 void CubismPhysics::SetOptions(const Options& options)
 {
     _options = options;
+
+    // 重力や風が変わると前回の出力は使えないので、休止を解く
+    for (csmUint32 i = 0; i < _restStates.GetSize(); ++i)
+    {
+        _restStates[i].IsSleeping = false;
+        _restStates[i].RestTickCount = 0;
+    }
 }
 
 const CubismPhysics::Options& CubismPhysics::GetOptions() const
@@ -60,7 +60,8 @@ const csmChar* Acceleration = "Acceleration";
 
 CubismPhysicsJson::CubismPhysicsJson(const csmByte* buffer, csmSizeInt size)
 {
-    CreateCubismJson(buffer, size);
+    // 物理演算の設定はパース中だけ保持されるので、元のバッファを参照するアリーナモードで読む
+    CreateCubismJson(buffer, size, true);
 }
 
 CubismPhysicsJson::~CubismPhysicsJson()
@@ -143,7 +144,7 @@ csmFloat32 CubismPhysicsJson::GetNormalizationAngleDefaultValue(csmInt32 physics
 
 csmInt32 CubismPhysicsJson::GetInputCount(csmInt32 physicsSettingIndex) const
 {
-    return static_cast<csmInt32>(_json->GetRoot()[PhysicsSettings][physicsSettingIndex][Input].GetVector()->GetSize());
+    return static_cast<csmInt32>(_json->GetRoot()[PhysicsSettings][physicsSettingIndex][Input].GetSize());
 }
 
 csmFloat32 CubismPhysicsJson::GetInputWeight(csmInt32 physicsSettingIndex, csmInt32 inputIndex) const
@@ -169,7 +170,7 @@ CubismIdHandle CubismPhysicsJson::GetInputSourceId(csmInt32 physicsSettingIndex,
 // Output
 csmInt32 CubismPhysicsJson::GetOutputCount(csmInt32 physicsSettingIndex) const
 {
-    return static_cast<csmInt32>(_json->GetRoot()[PhysicsSettings][physicsSettingIndex][Output].GetVector()->GetSize());
+    return static_cast<csmInt32>(_json->GetRoot()[PhysicsSettings][physicsSettingIndex][Output].GetSize());
 }
 
 csmInt32 CubismPhysicsJson::GetOutputVertexIndex(csmInt32 physicsSettingIndex, csmInt32 outputIndex) const
@@ -205,7 +206,7 @@ csmBool CubismPhysicsJson::GetOutputReflect(csmInt32 physicsSettingIndex, csmInt
 // Particle
 csmInt32 CubismPhysicsJson::GetParticleCount(csmInt32 physicsSettingIndex) const
 {
-    return static_cast<csmInt32>(_json->GetRoot()[PhysicsSettings][physicsSettingIndex][Vertices].GetVector()->GetSize());
+    return static_cast<csmInt32>(_json->GetRoot()[PhysicsSettings][physicsSettingIndex][Vertices].GetSize());
 }
 
 csmFloat32 CubismPhysicsJson::GetParticleMobility(csmInt32 physicsSettingIndex, csmInt32 vertexIndex) const
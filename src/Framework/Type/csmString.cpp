@@ -457,9 +457,9 @@ const csmChar* csmString::GetRawString() const
     }
 }
 
-csmInt32 csmString::GetHashcode()
+csmInt32 csmString::GetHashcode() const
 {
-    if (_hashcode == -1) _hashcode = CalcHashcode(WritePointer(), this->_length);
+    // 文字列を設定するたびに算出しているので、ここで計算し直す必要はない
     return _hashcode;
 }
 
@@ -0,0 +1,136 @@
+﻿/**
+ * Copyright(c) Live2D Inc. All rights reserved.
+ *
+ * Use of this source code is governed by the Live2D Open Software license
+ * that can be found at https://www.live2d.com/eula/live2d-open-software-license-agreement_en.html.
+ */
+
+#include "Framework/Utils/CubismBinaryStream.hpp"
+#include <cstring>
+
+//--------- LIVE2D NAMESPACE ------------
+namespace Live2D { namespace Cubism { namespace Framework { namespace Utils {
+
+CubismBinaryWriter::CubismBinaryWriter(csmVector<csmByte>& buffer)
+    : _buffer(buffer)
+{
+}
+
+void CubismBinaryWriter::WriteUint32(csmUint32 value)
+{
+    WriteBytes(&value, sizeof(value));
+}
+
+void CubismBinaryWriter::WriteInt32(csmInt32 value)
+{
+    WriteBytes(&value, sizeof(value));
+}
+
+void CubismBinaryWriter::WriteFloat32(csmFloat32 value)
+{
+    WriteBytes(&value, sizeof(value));
+}
+
+void CubismBinaryWriter::WriteString(const csmString& value)
+{
+    WriteUint32(static_cast<csmUint32>(value.GetLength()));
+    WriteBytes(value.GetRawString(), value.GetLength());
+}
+
+void CubismBinaryWriter::WriteBytes(const void* bytes, csmSizeType size)
+{
+    const csmInt32 offset = _buffer.GetSize();
+
+    _buffer.UpdateSize(offset + static_cast<csmInt32>(size), 0, false);
+
+    if (size > 0)
+    {
+        memcpy(_buffer.GetPtr() + offset, bytes, size);
+    }
+}
+
+CubismBinaryReader::CubismBinaryReader(const csmByte* data, csmSizeInt size)
+    : _data(data)
+    , _size(data ? size : 0)
+    , _position(0)
+    , _isValid(true)
+{
+}
+
+csmUint32 CubismBinaryReader::ReadUint32()
+{
+    csmUint32 value = 0;
+    ReadBytes(&value, sizeof(value));
+    return value;
+}
+
+csmInt32 CubismBinaryReader::ReadInt32()
+{
+    csmInt32 value = 0;
+    ReadBytes(&value, sizeof(value));
+    return value;
+}
+
+csmFloat32 CubismBinaryReader::ReadFloat32()
+{
+    csmFloat32 value = 0.0f;
+    ReadBytes(&value, sizeof(value));
+    return value;
+}
+
+csmString CubismBinaryReader::ReadString()
+{
+    const csmUint32 length = ReadUint32();
+
+    if (!_isValid || length > _size - _position)
+    {
+        _isValid = false;
+        return csmString();
+    }
+
+    const csmChar* value = reinterpret_cast<const csmChar*>(_data + _position);
+    _position += length;
+
+    return csmString(value, static_cast<csmInt32>(length));
+}
+
+csmInt32 CubismBinaryReader::ReadCount(csmSizeInt elementSize)
+{
+    const csmInt32 count = ReadInt32();
+
+    if (!_isValid || count < 0 || (elementSize > 0 && static_cast<csmSizeInt>(count) > (_size - _position) / elementSize))
+    {
+        _isValid = false;
+        return 0;
+    }
+
+    return count;
+}
+
+csmBool CubismBinaryReader::IsValid() const
+{
+    return _isValid;
+}
+
+csmBool CubismBinaryReader::IsFinished() const
+{
+    return _isValid && _position == _size;
+}
+
+csmBool CubismBinaryReader::ReadBytes(void* bytes, csmSizeInt size)
+{
+    if (!_isValid || size > _size - _position)
+    {
+        _isValid = false;
+        return false;
+    }
+
+    memcpy(bytes, _data + _position, size);
+    _position += size;
+
+    return true;
+}
+
+}}}}
+
+//--------- LIVE2D NAMESPACE ------------
@@ -6,70 +6,871 @@
  */
 
 #include "Framework/Utils/CubismJson.hpp"
+#include <float.h>
 #include <stdlib.h>
+#include <string.h>
+#include <new>
 #include "Framework/Type/csmString.hpp"
 #include "Framework/Utils/CubismDebug.hpp"
 
 using namespace std; // for strtof
 
+// 空白と文字列の走査に使う命令セット。AVX2はコンパイラで有効にされている場合だけ使う
+#if defined(__AVX2__)
+#define CSM_JSON_SIMD_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CSM_JSON_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CSM_JSON_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 //------------ LIVE2D NAMESPACE ------------
 namespace Live2D { namespace Cubism { namespace Framework { namespace Utils {
 
-//StaticInitializeNotForClientCall()で初期化する
-Boolean* Boolean::TrueValue = NULL;
-Boolean* Boolean::FalseValue = NULL;
-Value* Value::ErrorValue = NULL;
-Value* Value::NullValue = NULL;
-csmVector<csmString>* Value::s_dummyKeys = NULL;
+//StaticInitializeNotForClientCall()で初期化する
+Boolean* Boolean::TrueValue = NULL;
+Boolean* Boolean::FalseValue = NULL;
+Value* Value::ErrorValue = NULL;
+Value* Value::NullValue = NULL;
+csmVector<csmString>* Value::s_dummyKeys = NULL;
+#ifdef CSM_JSON_BENCHMARK
+std::atomic<csmBool> CubismJson::s_fastPathEnabled(true);
+#endif
+
+void Value::StaticReleaseNotForClientCall()
+{
+    CSM_DELETE(Boolean::TrueValue);
+    CSM_DELETE(Boolean::FalseValue);
+    CSM_DELETE(Value::ErrorValue);
+    CSM_DELETE(Value::NullValue);
+    CSM_DELETE(Value::s_dummyKeys);
+
+    Boolean::TrueValue = NULL;
+    Boolean::FalseValue = NULL;
+    Value::ErrorValue = NULL;
+    Value::NullValue = NULL;
+    Value::s_dummyKeys = NULL;
+}
+
+void Value::StaticInitializeNotForClientCall()
+{
+    Boolean::TrueValue = CSM_NEW Boolean(true);
+    Boolean::FalseValue = CSM_NEW Boolean(false);
+
+    Value::ErrorValue = CSM_NEW Error("ERROR", true);
+    Value::NullValue = CSM_NEW Utils::NullValue();
+
+    Value::s_dummyKeys = CSM_NEW csmVector<csmString>();
+}
+
+/**
+ * @brief   アリーナモードの要素と作業領域を確保するバンプアロケータ
+ *
+ * 要素は個別に解放せず、アリーナの破棄時にまとめて解放する。
+ */
+class CubismJsonArena
+{
+public:
+    /**
+     * @brief   オブジェクトのメンバ。キーは元のバッファかアリーナを指す
+     */
+    struct Member
+    {
+        const csmChar* Key;     ///< キーの先頭
+        csmInt32 KeyLength;     ///< キーの長さ
+        Value* Item;            ///< 値
+    };
+
+    CubismJsonArena(csmSizeInt sourceSize)
+        : _chunks(NULL)
+        , _nodes(NULL)
+    {
+        // 要素はおおよそ元の数倍の大きさになるので、最初のチャンクで大半が収まるようにする
+        _nextChunkSize = sourceSize * 4 < MinimumChunkSize ? MinimumChunkSize : sourceSize * 4;
+    }
+
+    ~CubismJsonArena()
+    {
+        for (Node* node = _nodes; node != NULL; node = node->Next)
+        {
+            node->Item->~Value();
+        }
+
+        while (_chunks)
+        {
+            Chunk* next = _chunks->Next;
+            CSM_FREE(_chunks);
+            _chunks = next;
+        }
+    }
+
+    /**
+     * @brief   アリーナからメモリを確保する
+     *
+     * @param[in]   size    ->  確保するバイト数
+     * @return      確保した領域
+     */
+    void* Allocate(csmSizeType size)
+    {
+        size = (size + Alignment - 1) & ~(Alignment - 1);
+
+        if (!_chunks || _chunks->Used + size > _chunks->Size)
+        {
+            const csmSizeType capacity = size > _nextChunkSize ? size : _nextChunkSize;
+            Chunk* chunk = static_cast<Chunk*>(CSM_MALLOC(HeaderSize + capacity));
+            chunk->Next = _chunks;
+            chunk->Size = capacity;
+            chunk->Used = 0;
+            _chunks = chunk;
+            _nextChunkSize *= 2;
+        }
+
+        void* memory = reinterpret_cast<csmByte*>(_chunks) + HeaderSize + _chunks->Used;
+        _chunks->Used += size;
+        return memory;
+    }
+
+    /**
+     * @brief   アリーナの破棄時にデストラクタを呼ぶ要素として登録する
+     *
+     * @param[in]   item    ->  アリーナに確保した要素
+     * @return      item
+     */
+    template<class T>
+    T* Track(T* item)
+    {
+        Node* node = static_cast<Node*>(Allocate(sizeof(Node)));
+        node->Item = item;
+        node->Next = _nodes;
+        _nodes = node;
+        return item;
+    }
+
+    csmVector<Member> Members;      ///< パース中のオブジェクトのメンバを積む作業領域
+    csmVector<Value*> Elements;     ///< パース中の配列の要素を積む作業領域
+
+private:
+    struct Chunk
+    {
+        Chunk* Next;
+        csmSizeType Size;
+        csmSizeType Used;
+    };
+
+    struct Node
+    {
+        Value* Item;
+        Node* Next;
+    };
+
+    static const csmSizeType Alignment = 16;
+    static const csmSizeType HeaderSize = (sizeof(Chunk) + Alignment - 1) & ~(Alignment - 1);
+    static const csmSizeType MinimumChunkSize = 4096;
+
+    Chunk* _chunks;                 ///< 確保済みのチャンク。先頭が現在のチャンク
+    csmSizeType _nextChunkSize;     ///< 次に確保するチャンクのサイズ
+    Node* _nodes;                   ///< デストラクタを呼ぶ要素の一覧
+};
+
+namespace {
+
+csmBool EqualsView(const csmChar* view, csmInt32 viewLength, const csmChar* value, csmSizeType valueLength)
+{
+    return static_cast<csmSizeType>(viewLength) == valueLength && memcmp(view, value, valueLength) == 0;
+}
+
+csmUint32 CountTrailingZeros(csmUint32 mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return static_cast<csmUint32>(__builtin_ctz(mask));
+#endif
+}
+
+csmUint32 CountBits(csmUint32 mask)
+{
+    mask = mask - ((mask >> 1) & 0x55555555u);
+    mask = (mask & 0x33333333u) + ((mask >> 2) & 0x33333333u);
+    return (((mask + (mask >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+}
+
+#if defined(CSM_JSON_SIMD_AVX2)
+const csmInt32 ScanBlockSize = 32;
+
+/**
+ * @brief   ブロック内で対象の文字に一致したバイトをビットマスクにする
+ */
+csmUint32 MatchMask(__m256i block, csmChar c)
+{
+    return static_cast<csmUint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(c))));
+}
+
+/**
+ * @brief   ブロックの空白文字と改行のビットマスクを求める
+ */
+csmUint32 ClassifyWhitespace(const csmChar* p, csmUint32* outLineFeeds)
+{
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    *outLineFeeds = MatchMask(block, '\n');
+    return *outLineFeeds | MatchMask(block, ' ') | MatchMask(block, '\t') | MatchMask(block, '\r');
+}
+
+/**
+ * @brief   ブロックの " と \ のビットマスクを求める
+ */
+csmUint32 ClassifyStringEnd(const csmChar* p)
+{
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    return MatchMask(block, '\"') | MatchMask(block, '\\');
+}
+#elif defined(CSM_JSON_SIMD_SSE2)
+const csmInt32 ScanBlockSize = 16;
+
+csmUint32 MatchMask(__m128i block, csmChar c)
+{
+    return static_cast<csmUint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(c))));
+}
+
+csmUint32 ClassifyWhitespace(const csmChar* p, csmUint32* outLineFeeds)
+{
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    *outLineFeeds = MatchMask(block, '\n');
+    return *outLineFeeds | MatchMask(block, ' ') | MatchMask(block, '\t') | MatchMask(block, '\r');
+}
+
+csmUint32 ClassifyStringEnd(const csmChar* p)
+{
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    return MatchMask(block, '\"') | MatchMask(block, '\\');
+}
+#elif defined(CSM_JSON_SIMD_NEON)
+const csmInt32 ScanBlockSize = 16;
+
+/**
+ * @brief   比較結果（0x00/0xFF）の各バイトを1ビットに畳み込む
+ */
+csmUint32 MoveMask(uint8x16_t matched)
+{
+    static const uint8_t Weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    const uint8x16_t bits = vandq_u8(matched, vld1q_u8(Weights));
+    return vaddv_u8(vget_low_u8(bits)) | (static_cast<csmUint32>(vaddv_u8(vget_high_u8(bits))) << 8);
+}
+
+csmUint32 ClassifyWhitespace(const csmChar* p, csmUint32* outLineFeeds)
+{
+    const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+    const uint8x16_t lineFeeds = vceqq_u8(block, vdupq_n_u8('\n'));
+    const uint8x16_t whitespace = vorrq_u8(vorrq_u8(lineFeeds, vceqq_u8(block, vdupq_n_u8(' '))),
+                                           vorrq_u8(vceqq_u8(block, vdupq_n_u8('\t')), vceqq_u8(block, vdupq_n_u8('\r'))));
+    *outLineFeeds = MoveMask(lineFeeds);
+    return MoveMask(whitespace);
+}
+
+csmUint32 ClassifyStringEnd(const csmChar* p)
+{
+    const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+    return MoveMask(vorrq_u8(vceqq_u8(block, vdupq_n_u8('\"')), vceqq_u8(block, vdupq_n_u8('\\'))));
+}
+#endif
+
+/**
+ * @brief   高速な走査と数値変換を使うか
+ *
+ * ベンチマーク用のビルド（CSM_JSON_BENCHMARK）でだけ切り替えられる。
+ */
+csmBool FastPathEnabled()
+{
+#ifdef CSM_JSON_BENCHMARK
+    return CubismJson::IsFastPathEnabled();
+#else
+    return true;
+#endif
+}
+
+csmBool IsWhitespace(csmChar c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/**
+ * @brief   空白文字を読み飛ばす
+ *
+ * 整形されたJSONはインデントが長いので、SIMDが使える環境ではブロック単位で読み飛ばす。
+ *
+ * @param[in]   buffer          JSONのバッファ
+ * @param[in]   begin           読み飛ばしを始める位置
+ * @param[in]   length          バッファの長さ
+ * @param[out]  outLineCount    読み飛ばした改行の数を加算する
+ * @return  空白文字でない最初の位置。見つからなければlength
+ */
+csmInt32 SkipWhitespace(const csmChar* buffer, csmInt32 begin, csmInt32 length, csmInt32* outLineCount)
+{
+    csmInt32 i = begin;
+
+    // 区切り文字の直後に値が続く場合は読み飛ばすものがない
+    if (i >= length || !IsWhitespace(buffer[i]))
+    {
+        return i;
+    }
+
+#if defined(CSM_JSON_SIMD_AVX2) || defined(CSM_JSON_SIMD_SSE2) || defined(CSM_JSON_SIMD_NEON)
+    const csmUint32 fullMask = ScanBlockSize == 32 ? 0xFFFFFFFFu : 0xFFFFu;
+    for (; FastPathEnabled() && i + ScanBlockSize <= length; i += ScanBlockSize)
+    {
+        csmUint32 lineFeeds;
+        const csmUint32 others = ~ClassifyWhitespace(buffer + i, &lineFeeds) & fullMask;
+        if (others)
+        {
+            const csmUint32 offset = CountTrailingZeros(others);
+            *outLineCount += static_cast<csmInt32>(CountBits(lineFeeds & ((1u << offset) - 1)));
+            return i + static_cast<csmInt32>(offset);
+        }
+        *outLineCount += static_cast<csmInt32>(CountBits(lineFeeds));
+    }
+#endif
+
+    for (; i < length && IsWhitespace(buffer[i]); ++i)
+    {
+        if (buffer[i] == '\n')
+        {
+            ++*outLineCount;
+        }
+    }
+    return i;
+}
+
+/**
+ * @brief   文字列の終端 " かエスケープ \ を探す
+ *
+ * @return  見つかった位置。見つからなければlength
+ */
+csmInt32 FindStringEnd(const csmChar* string, csmInt32 begin, csmInt32 length)
+{
+    csmInt32 i = begin;
+
+#if defined(CSM_JSON_SIMD_AVX2) || defined(CSM_JSON_SIMD_SSE2) || defined(CSM_JSON_SIMD_NEON)
+    for (; FastPathEnabled() && i + ScanBlockSize <= length; i += ScanBlockSize)
+    {
+        const csmUint32 found = ClassifyStringEnd(string + i);
+        if (found)
+        {
+            return i + static_cast<csmInt32>(CountTrailingZeros(found));
+        }
+    }
+#endif
+
+    while (i < length && string[i] != '\"' && string[i] != '\\')
+    {
+        ++i;
+    }
+    return i;
+}
+
+/**
+ * @brief   数値を strtof で解析する
+ */
+csmFloat32 ParseNumberWithStrtof(const csmChar* buffer, csmInt32 begin, csmInt32* outEndPos)
+{
+    char* ret_ptr;
+    const csmFloat32 f = strtof(const_cast<csmChar*>(buffer + begin), &ret_ptr);
+    *outEndPos = static_cast<csmInt32>(ret_ptr - buffer);
+    return f;
+}
+
+/**
+ * @brief   数値を解析する
+ *
+ * 有効桁数19桁以内かつ10の指数が22以内の数値は、doubleで正確に丸めてからfloatにする。
+ * doubleの結果がちょうどfloatの中間点に乗った場合と、それ以外の表記は strtof に任せるので、結果は strtof と一致する。
+ * strtof と異なりロケールに依存せず、lengthを越えて読まない。
+ *
+ * @param[in]   buffer      JSONのバッファ
+ * @param[in]   begin       数値の先頭の位置
+ * @param[in]   length      バッファの長さ
+ * @param[out]  outEndPos   数値の次の位置
+ * @return  解析した数値
+ */
+csmFloat32 ParseNumber(const csmChar* buffer, csmInt32 begin, csmInt32 length, csmInt32* outEndPos)
+{
+    static const double PowersOfTen[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    if (!FastPathEnabled())
+    {
+        return ParseNumberWithStrtof(buffer, begin, outEndPos);
+    }
+
+    csmInt32 i = begin;
+    const csmBool negative = i < length && buffer[i] == '-';
+    if (negative)
+    {
+        ++i;
+    }
+
+    csmUint64 mantissa = 0;
+    csmInt32 digits = 0;        // 先頭の0を除いた桁数
+    csmInt32 exponent = 0;
+    csmBool hasDigits = false;
+
+    for (; i < length && buffer[i] >= '0' && buffer[i] <= '9'; ++i)
+    {
+        hasDigits = true;
+        if (mantissa != 0 || buffer[i] != '0')
+        {
+            mantissa = mantissa * 10 + static_cast<csmUint64>(buffer[i] - '0');
+            ++digits;
+        }
+    }
+
+    // 0x で始まる16進数の表記は strtof に任せる
+    const csmBool hexadecimal = i < length && (buffer[i] == 'x' || buffer[i] == 'X');
+
+    if (i < length && buffer[i] == '.')
+    {
+        csmInt32 j = i + 1;
+        for (; j < length && buffer[j] >= '0' && buffer[j] <= '9'; ++j)
+        {
+            hasDigits = true;
+            if (mantissa != 0 || buffer[j] != '0')
+            {
+                mantissa = mantissa * 10 + static_cast<csmUint64>(buffer[j] - '0');
+                ++digits;
+            }
+            --exponent;
+        }
+        if (hasDigits)
+        {
+            i = j;
+        }
+    }
+
+    if (hasDigits && i < length && (buffer[i] == 'e' || buffer[i] == 'E'))
+    {
+        csmInt32 j = i + 1;
+        const csmBool negativeExponent = j < length && buffer[j] == '-';
+        if (j < length && (buffer[j] == '-' || buffer[j] == '+'))
+        {
+            ++j;
+        }
+        if (j < length && buffer[j] >= '0' && buffer[j] <= '9')
+        {
+            csmInt32 value = 0;
+            for (; j < length && buffer[j] >= '0' && buffer[j] <= '9'; ++j)
+            {
+                if (value < 10000)
+                {
+                    value = value * 10 + (buffer[j] - '0');
+                }
+            }
+            exponent += negativeExponent ? -value : value;
+            i = j;
+        }
+    }
+
+    if (hasDigits && !hexadecimal && digits <= 19)
+    {
+        if (mantissa == 0)
+        {
+            *outEndPos = i;
+            return negative ? -0.0f : 0.0f;
+        }
+
+#if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD == 0 // x87の拡張精度では丸めが2回になるので使わない
+        if (mantissa <= (static_cast<csmUint64>(1) << 53) && exponent >= -22 && exponent <= 22)
+        {
+            // 仮数も10の累乗もdoubleで正確に表せるので、1回の乗除算で正しく丸められる
+            double value = static_cast<double>(mantissa);
+            value = exponent < 0 ? value / PowersOfTen[-exponent] : value * PowersOfTen[exponent];
+
+            if (value >= FLT_MIN && value <= FLT_MAX)
+            {
+                csmUint64 bits;
+                memcpy(&bits, &value, sizeof(bits));
+                // 下位29ビットが中間点を表していなければ、floatへの丸めは元の数値を直接丸めた結果と一致する
+                if ((bits & 0x1FFFFFFFu) != 0x10000000u)
+                {
+                    *outEndPos = i;
+                    return static_cast<csmFloat32>(negative ? -value : value);
+                }
+            }
+        }
+#endif
+    }
+
+    return ParseNumberWithStrtof(buffer, begin, outEndPos);
+}
+
+/**
+ * @brief   次の「"」までの文字列のエスケープを展開する
+ *
+ * @param[in]   string      ->  パース対象の文字列
+ * @param[in]   length      ->  パースする長さ
+ * @param[in]   begin       ->  パースを開始する位置
+ * @param[out]  outEndPos   ->  終端の「"」の次の位置
+ * @param[out]  outString   ->  展開した文字列を追加する
+ * @return  エラーの内容。成功したらNULL
+ */
+const csmChar* UnescapeString(const csmChar* string, csmInt32 length, csmInt32 begin, csmInt32* outEndPos, csmString& outString)
+{
+    const csmChar* error = NULL;
+    csmInt32 buf_start = begin; //sbufに登録されていない文字の開始位置
+
+    for (csmInt32 i = begin; i < length; i++)
+    {
+        // 終端とエスケープ以外の文字はまとめて読み飛ばす
+        i = FindStringEnd(string, i, length);
+        if (i >= length)
+        {
+            break;
+        }
+
+        if (string[i] == '\"') //終端の”
+        {
+            *outEndPos = i + 1; // ”の次の文字
+            outString.Append(static_cast<const csmChar*>(string + buf_start), (i - buf_start));
+            return error;
+        }
+
+        //エスケープの場合、２文字をセットで扱う
+        i++;
+
+        if (i - 1 > buf_start)
+        {
+            outString.Append(static_cast<const csmChar*>(string + buf_start), (i - buf_start - 1)); //前の文字までを登録する
+        }
+        buf_start = i + 1; //エスケープ（２文字）の次の文字から
+
+        if (i >= length)
+        {
+            break;
+        }
+
+        switch (string[i])
+        {
+        case '\\': outString.Append(1, '\\');
+            break;
+        case '\"': outString.Append(1, '\"');
+            break;
+        case '/': outString.Append(1, '/');
+            break;
+
+        case 'b': outString.Append(1, '\b');
+            break;
+        case 'f': outString.Append(1, '\f');
+            break;
+        case 'n': outString.Append(1, '\n');
+            break;
+        case 'r': outString.Append(1, '\r');
+            break;
+        case 't': outString.Append(1, '\t');
+            break;
+        case 'u':
+            error = "parse string/unicode escape not supported";
+        default:
+            break;
+        }
+    }
+    return "parse string/illegal end";
+}
+
+/**
+ * @brief   アリーナモードの文字列。元のバッファを指し、csmStringは取得された時に初めて作る
+ */
+class ArenaString : public Value
+{
+public:
+    ArenaString(const csmChar* value, csmInt32 length)
+        : Value()
+        , _value(value)
+        , _length(length)
+        , _isMaterialized(false)
+    { }
+
+    virtual csmBool IsString() { return true; }
+
+    virtual const csmString& GetString(const csmString& defaultValue = "", const csmString& indent = "")
+    {
+        if (!_isMaterialized)
+        {
+            _stringBuffer = csmString(_value, _length);
+            _isMaterialized = true;
+        }
+
+        return _stringBuffer;
+    }
+
+    virtual csmBool Equals(const csmString& v) { return EqualsView(_value, _length, v.GetRawString(), v.GetLength()); }
+    virtual csmBool Equals(const csmChar* v) { return EqualsView(_value, _length, v, strlen(v)); }
+    virtual csmBool Equals(csmInt32 v) { return false; }
+    virtual csmBool Equals(csmFloat32 v) { return false; }
+    virtual csmBool Equals(csmBool v) { return false; }
+
+private:
+    const csmChar* _value;  ///< 文字列の先頭。NUL終端されているとは限らない
+    csmInt32 _length;       ///< 文字列の長さ
+    csmBool _isMaterialized;    ///< _stringBufferに展開済みか
+};
+
+/**
+ * @brief   アリーナモードの配列。要素はアリーナ上の連続した領域に置く
+ */
+class ArenaArray : public Value
+{
+public:
+    ArenaArray(Value** items, csmInt32 count)
+        : Value()
+        , _items(items)
+        , _count(count)
+        , _vector(NULL)
+    { }
+
+    virtual ~ArenaArray()
+    {
+        if (_vector)
+        {
+            CSM_DELETE(_vector);
+        }
+    }
+
+    virtual csmBool IsArray() { return true; }
+
+    virtual Value& operator[](csmInt32 index)
+    {
+        if (index < 0 || _count <= index)
+        {
+            return *(ErrorValue->SetErrorNotForClientCall(CSM_JSON_ERROR_INDEX_OUT_OF_BOUNDS));
+        }
+
+        return *_items[index];
+    }
+
+    virtual Value& operator[](const csmString& string)
+    {
+        return *(ErrorValue->SetErrorNotForClientCall(CSM_JSON_ERROR_TYPE_MISMATCH));
+    }
+
+    virtual Value& operator[](const csmChar* s)
+    {
+        return *(ErrorValue->SetErrorNotForClientCall(CSM_JSON_ERROR_TYPE_MISMATCH));
+    }
+
+    virtual const csmString& GetString(const csmString& defaultValue = "", const csmString& indent = "")
+    {
+        _stringBuffer = indent + "[\n";
+        for (csmInt32 i = 0; i < _count; ++i)
+        {
+            _stringBuffer += indent + "	" + _items[i]->GetString(indent + "	") + "\n";
+        }
+        _stringBuffer += indent + "]\n";
+        return _stringBuffer;
+    }
+
+    // 互換用。呼ばれた時に初めて作る
+    virtual csmVector<Value*>* GetVector(csmVector<Value*>* defaultValue = NULL)
+    {
+        if (!_vector)
+        {
+            _vector = CSM_NEW csmVector<Value*>(_count);
+            for (csmInt32 i = 0; i < _count; ++i)
+            {
+                _vector->PushBack(_items[i], false);
+            }
+        }
+
+        return _vector;
+    }
+
+    virtual csmInt32 GetSize() { return _count; }
+
+private:
+    Value** _items;                 ///< 要素
+    csmInt32 _count;                ///< 要素数
+    csmVector<Value*>* _vector;     ///< GetVector()用に作った要素の複製
+};
+
+/**
+ * @brief   アリーナモードのオブジェクト。メンバは出現順にアリーナ上の連続した領域に置く
+ */
+class ArenaMap : public Value
+{
+public:
+    ArenaMap(CubismJsonArena::Member* members, csmInt32 count)
+        : Value()
+        , _members(members)
+        , _count(count)
+        , _map(NULL)
+        , _keys(NULL)
+    { }
+
+    virtual ~ArenaMap()
+    {
+        if (_map)
+        {
+            CSM_DELETE(_map);
+        }
+
+        if (_keys)
+        {
+            CSM_DELETE(_keys);
+        }
+    }
+
+    virtual csmBool IsMap() { return true; }
 
-void Value::StaticReleaseNotForClientCall()
+    virtual Value& operator[](const csmString& s)
+    {
+        return Find(s.GetRawString(), s.GetLength());
+    }
+
+    virtual Value& operator[](const csmChar* s)
+    {
+        return Find(s, strlen(s));
+    }
+
+    virtual Value& operator[](csmInt32 index)
+    {
+        return *(ErrorValue->SetErrorNotForClientCall(CSM_JSON_ERROR_TYPE_MISMATCH));
+    }
+
+    virtual const csmString& GetString(const csmString& defaultValue = "", const csmString& indent = "")
+    {
+        _stringBuffer = indent + "{\n";
+        for (csmInt32 i = 0; i < _count; ++i)
+        {
+            _stringBuffer += indent + "	" + csmString(_members[i].Key, _members[i].KeyLength) + " : " + _members[i].Item->GetString(indent + "	") + "\n";
+        }
+        _stringBuffer += indent + "}\n";
+        return _stringBuffer;
+    }
+
+    // 互換用。呼ばれた時に初めて作る
+    virtual csmMap<csmString, Value*>* GetMap(csmMap<csmString, Value*>* defaultValue = NULL)
+    {
+        if (!_map)
+        {
+            _map = CSM_NEW csmMap<csmString, Value*>();
+            for (csmInt32 i = 0; i < _count; ++i)
+            {
+                (*_map)[csmString(_members[i].Key, _members[i].KeyLength)] = _members[i].Item;
+            }
+        }
+
+        return _map;
+    }
+
+    virtual csmVector<csmString>& GetKeys()
+    {
+        if (!_keys)
+        {
+            _keys = CSM_NEW csmVector<csmString>();
+            csmMap<csmString, Value*>::const_iterator ite = GetMap()->Begin();
+            while (ite != _map->End())
+            {
+                _keys->PushBack((*ite).First, true);
+                ++ite;
+            }
+        }
+
+        return *_keys;
+    }
+
+    virtual csmInt32 GetSize() { return static_cast<csmInt32>(GetKeys().GetSize()); }
+
+private:
+    Value& Find(const csmChar* key, csmSizeType keyLength)
+    {
+        // 重複したキーは通常モードと同じく後の値を優先する
+        for (csmInt32 i = _count - 1; i >= 0; --i)
+        {
+            if (EqualsView(_members[i].Key, _members[i].KeyLength, key, keyLength))
+            {
+                return *_members[i].Item;
+            }
+        }
+
+        return *Value::NullValue;
+    }
+
+    CubismJsonArena::Member* _members;  ///< メンバ
+    csmInt32 _count;                    ///< メンバ数
+    csmMap<csmString, Value*>* _map;    ///< GetMap()用に作ったメンバの複製
+    csmVector<csmString>* _keys;        ///< GetKeys()用に作ったキーの一覧
+};
+
+Value* CreateArenaArray(CubismJsonArena* arena, csmInt32 base)
 {
-    CSM_DELETE(Boolean::TrueValue);
-    CSM_DELETE(Boolean::FalseValue);
-    CSM_DELETE(Value::ErrorValue);
-    CSM_DELETE(Value::NullValue);
-    CSM_DELETE(Value::s_dummyKeys);
+    const csmInt32 count = static_cast<csmInt32>(arena->Elements.GetSize()) - base;
+    Value** items = static_cast<Value**>(arena->Allocate(sizeof(Value*) * count));
 
-    Boolean::TrueValue = NULL;
-    Boolean::FalseValue = NULL;
-    Value::ErrorValue = NULL;
-    Value::NullValue = NULL;
-    Value::s_dummyKeys = NULL;
+    for (csmInt32 i = 0; i < count; ++i)
+    {
+        items[i] = arena->Elements[base + i];
+    }
+
+    arena->Elements.UpdateSize(base, NULL, false);
+
+    return arena->Track(CSM_PLACEMENT_NEW(arena->Allocate(sizeof(ArenaArray))) ArenaArray(items, count));
 }
 
-void Value::StaticInitializeNotForClientCall()
+Value* CreateArenaMap(CubismJsonArena* arena, csmInt32 base)
 {
-    Boolean::TrueValue = CSM_NEW Boolean(true);
-    Boolean::FalseValue = CSM_NEW Boolean(false);
+    const csmInt32 count = static_cast<csmInt32>(arena->Members.GetSize()) - base;
+    CubismJsonArena::Member* members = static_cast<CubismJsonArena::Member*>(arena->Allocate(sizeof(CubismJsonArena::Member) * count));
 
-    Value::ErrorValue = CSM_NEW Error("ERROR", true);
-    Value::NullValue = CSM_NEW Utils::NullValue();
+    for (csmInt32 i = 0; i < count; ++i)
+    {
+        members[i] = arena->Members[base + i];
+    }
+
+    arena->Members.UpdateSize(base, CubismJsonArena::Member(), false);
+
+    return arena->Track(CSM_PLACEMENT_NEW(arena->Allocate(sizeof(ArenaMap))) ArenaMap(members, count));
+}
 
-    Value::s_dummyKeys = CSM_NEW csmVector<csmString>();
 }
 
 CubismJson::CubismJson()
     : _error(NULL)
     , _lineCount(0)
     , _root(NULL)
+    , _arena(NULL)
 { }
 
 CubismJson::CubismJson(const csmByte* buffer, csmInt32 length)
     : _error(NULL)
     , _lineCount(0)
     , _root(NULL)
+    , _arena(NULL)
 {
     ParseBytes(buffer, length);
 }
 
 CubismJson::~CubismJson()
 {
-    if (_root && !_root->IsStatic())
+    if (_arena)
+    {
+        // アリーナモードでは成功時のルートもアリーナにある
+        CSM_DELETE(_arena);
+    }
+    else if (_root && !_root->IsStatic())
     {
         CSM_DELETE(_root);
     }
 
     _root = NULL;
+    _arena = NULL;
 }
 
 void CubismJson::Delete(CubismJson* instance)
@@ -78,9 +879,15 @@ void CubismJson::Delete(CubismJson* instance)
 }
 
 
-CubismJson* CubismJson::Create(const csmByte* buffer, csmSizeInt size)
+CubismJson* CubismJson::Create(const csmByte* buffer, csmSizeInt size, csmBool useArena)
 {
     CubismJson* json = CSM_NEW CubismJson();
+
+    if (useArena)
+    {
+        json->_arena = CSM_NEW CubismJsonArena(size);
+    }
+
     const csmBool succeeded = json->ParseBytes(buffer, size);
 
     if (!succeeded)
@@ -106,6 +913,13 @@ csmBool CubismJson::ParseBytes(const csmByte* buffer, csmInt32 size)
     csmInt32 endPos;
     _root = ParseValue(reinterpret_cast<const csmChar*>(buffer), size, 0, &endPos);
 
+    if ((_error || _root == NULL) && _arena)
+    {
+        // 途中まで作った要素はアリーナごと破棄し、エラー用のルートは通常どおり確保する
+        CSM_DELETE(_arena);
+        _arena = NULL;
+    }
+
     if (_error)
     {
 #if defined(CSM_TARGET_WIN_GL) || defined(_MSC_VER)
@@ -133,81 +947,61 @@ csmString CubismJson::ParseString(const csmChar* string, csmInt32 length, csmInt
 {
     if (_error)
     {
-        return NULL;
+        return csmString();
     }
 
     if (!string)
     {
         _error = "string is null";
-        return NULL;
+        return csmString();
     }
 
-    csmInt32 i = begin;
-    csmChar c, c2;
     csmString ret;
-    csmInt32 buf_start = begin; //sbufに登録されていない文字の開始位置
+    const csmChar* error = UnescapeString(string, length, begin, outEndPos, ret);
+    if (error)
+    {
+        _error = error;
+    }
+    return ret;
+}
 
-    for (; i < length; i++)
+
+csmBool CubismJson::ParseStringView(const csmChar* string, csmInt32 length, csmInt32 begin, csmInt32* outEndPos, const csmChar** outView, csmInt32* outViewLength)
+{
+    if (_error)
     {
-        c = static_cast<csmChar>(string[i] & 0xFF);
+        return false;
+    }
 
-        switch (c)
-        {
-        case '\"': {//終端の”, エスケープ文字は別に処理されるのでここにはこない
-            *outEndPos = i + 1; // ”の次の文字
-            ret.Append(static_cast<const csmChar*>(string + buf_start), (i - buf_start));
-            return ret;
-        }
-        case '\\': {//エスケープの場合
-            i++; //２文字をセットで扱う
+    // エスケープを含まなければ元のバッファをそのまま指す
+    const csmInt32 i = FindStringEnd(string, begin, length);
 
-            if (i - 1 > buf_start)
-            {
-                ret.Append(static_cast<const csmChar*>(string + buf_start), (i - buf_start - 1)); //前の文字までを登録する
-            }
-            buf_start = i + 1; //エスケープ（２文字）の次の文字から
+    if (i >= length)
+    {
+        _error = "parse string/illegal end";
+        return false;
+    }
 
-            if (i < length)
-            {
-                c2 = static_cast<csmChar>(string[i] & 0xFF);
-                switch (c2)
-                {
-                case '\\': ret.Append(1, '\\');
-                    break;
-                case '\"': ret.Append(1, '\"');
-                    break;
-                case '/': ret.Append(1, '/');
-                    break;
-
-                case 'b': ret.Append(1, '\b');
-                    break;
-                case 'f': ret.Append(1, '\f');
-                    break;
-                case 'n': ret.Append(1, '\n');
-                    break;
-                case 'r': ret.Append(1, '\r');
-                    break;
-                case 't': ret.Append(1, '\t');
-                    break;
-                case 'u':
-                    _error = "parse string/unicode escape not supported";
-                default:
-                    break;
-                }
-            }
-            else
-            {
-                _error = "parse string/escape error";
-            }
-            break;
-        }
-        default: {
-            break;
-        }
-        }
+    if (string[i] == '\"')
+    {
+        *outEndPos = i + 1;
+        *outView = string + begin;
+        *outViewLength = i - begin;
+        return true;
     }
-    _error = "parse string/illegal end";
-    return NULL;
+
+    // エスケープを含む文字列だけを展開してアリーナに複写する
+    const csmString unescaped = ParseString(string, length, begin, outEndPos);
+    if (_error)
+    {
+        return false;
+    }
+
+    csmChar* copy = static_cast<csmChar*>(_arena->Allocate(unescaped.GetLength() + 1));
+    memcpy(copy, unescaped.GetRawString(), unescaped.GetLength() + 1);
+    *outView = copy;
+    *outViewLength = unescaped.GetLength();
+    return true;
 }
 
 
@@ -224,10 +1018,14 @@ Value* CubismJson::ParseObject(const csmChar* buffer, csmInt32 length, csmInt32
         return NULL;
     }
 
-    Map* ret = CSM_NEW Map();
+    // アリーナモードではメンバを作業領域に積み、閉じカッコでまとめてArenaMapにする
+    Map* ret = _arena ? NULL : CSM_NEW Map();
+    const csmInt32 memberBase = _arena ? static_cast<csmInt32>(_arena->Members.GetSize()) : 0;
 
     //key : value ,
     csmString key;
+    const csmChar* keyView = NULL;
+    csmInt32 keyLength = 0;
     csmInt32 i = begin;
     csmChar c;
     csmInt32 local_ret_endpos2[1];
@@ -238,19 +1036,31 @@ Value* CubismJson::ParseObject(const csmChar* buffer, csmInt32 length, csmInt32
     {
         for (; i < length; i++)
         {
+            i = SkipWhitespace(buffer, i, length, &_lineCount);
+            if (i >= length)
+            {
+                break;
+            }
             c = static_cast<csmChar>(buffer[i] & 0xFF);
 
             switch (c)
             {
             case '\"':
-                key = ParseString(buffer, length, i + 1, local_ret_endpos2);
+                if (_arena)
+                {
+                    ParseStringView(buffer, length, i + 1, local_ret_endpos2, &keyView, &keyLength);
+                }
+                else
+                {
+                    key = ParseString(buffer, length, i + 1, local_ret_endpos2);
+                }
                 if (_error) return NULL;
                 i = local_ret_endpos2[0];
                 ok = true;
                 goto BREAK_LOOP1; //-- loopから出る
             case '}': //閉じカッコ
                 *outEndPos = i + 1;
-                return ret; //空
+                return _arena ? CreateArenaMap(_arena, memberBase) : ret; //空
             case ':':
                 _error = "illegal ':' position";
                 break;
@@ -270,6 +1080,11 @@ Value* CubismJson::ParseObject(const csmChar* buffer, csmInt32 length, csmInt32
         // : をチェック
         for (; i < length; i++)
         {
+            i = SkipWhitespace(buffer, i, length, &_lineCount);
+            if (i >= length)
+            {
+                break;
+            }
             c = static_cast<csmChar>(buffer[i] & 0xFF);
 
             switch (c)
@@ -302,10 +1117,23 @@ Value* CubismJson::ParseObject(const csmChar* buffer, csmInt32 length, csmInt32
         }
         i = local_ret_endpos2[0];
         // ret.put( key , value ) ;
-        ret->Put(key, value);
+        if (_arena)
+        {
+            const CubismJsonArena::Member member = { keyView, keyLength, value ? value : Value::NullValue };
+            _arena->Members.PushBack(member, false);
+        }
+        else
+        {
+            ret->Put(key, value);
+        }
 
         for (; i < length; i++)
         {
+            i = SkipWhitespace(buffer, i, length, &_lineCount);
+            if (i >= length)
+            {
+                break;
+            }
             c = static_cast<csmChar>(buffer[i] & 0xFF);
 
             switch (c)
@@ -314,7 +1142,7 @@ Value* CubismJson::ParseObject(const csmChar* buffer, csmInt32 length, csmInt32
                 goto BREAK_LOOP3;
             case '}':
                 *outEndPos = i + 1;
-                return ret; // << [] 正常終了 >>
+                return _arena ? CreateArenaMap(_arena, memberBase) : ret; // << [] 正常終了 >>
             case '\n': _lineCount++;
                 //case ' ': case '\t': case '\r':
             default: break; //スキップ
@@ -342,7 +1170,9 @@ Value* CubismJson::ParseArray(const csmChar* buffer, csmInt32 length, csmInt32 b
         return NULL;
     }
 
-    Array* ret = CSM_NEW Array();
+    // アリーナモードでは要素を作業領域に積み、閉じカッコでまとめてArenaArrayにする
+    Array* ret = _arena ? NULL : CSM_NEW Array();
+    const csmInt32 elementBase = _arena ? static_cast<csmInt32>(_arena->Elements.GetSize()) : 0;
 
     //key : value ,
     csmInt32 i = begin;
@@ -361,13 +1191,25 @@ Value* CubismJson::ParseArray(const csmChar* buffer, csmInt32 length, csmInt32 b
         i = local_ret_endpos2[0];
         if (value)
         {
-            ret->Add(value);
+            if (_arena)
+            {
+                _arena->Elements.PushBack(value, false);
+            }
+            else
+            {
+                ret->Add(value);
+            }
         }
 
         //FOR_LOOP3:
         //bool breakflag = false;
         for (; i < length; i++)
         {
+            i = SkipWhitespace(buffer, i, length, &_lineCount);
+            if (i >= length)
+            {
+                break;
+            }
             c = static_cast<csmChar>(buffer[i] & 0xFF);
 
             switch (c)
@@ -378,7 +1220,7 @@ Value* CubismJson::ParseArray(const csmChar* buffer, csmInt32 length, csmInt32 b
                 goto BREAK_LOOP3;
             case ']':
                 *outEndPos = i + 1;
-                return ret; //終了
+                return _arena ? CreateArenaArray(_arena, elementBase) : ret; //終了
             case '\n': ++_lineCount;
                 //case ' ': case '\t': case '\r':
             default: break; //スキップ
@@ -388,7 +1230,10 @@ Value* CubismJson::ParseArray(const csmChar* buffer, csmInt32 length, csmInt32 b
         ; //dummy
     }
 
-    CSM_DELETE(ret);
+    if (ret)
+    {
+        CSM_DELETE(ret);
+    }
     _error = "illegal end of parseObject";
     return NULL;
 }
@@ -414,6 +1259,11 @@ Value* CubismJson::ParseValue(const csmChar* buffer, csmInt32 length, csmInt32 b
 
     for (; i < length; i++)
     {
+        i = SkipWhitespace(buffer, i, length, &_lineCount);
+        if (i >= length)
+        {
+            break;
+        }
         csmChar c = static_cast<csmChar>(buffer[i] & 0xFF);
 
         switch (c)
@@ -422,12 +1272,22 @@ Value* CubismJson::ParseValue(const csmChar* buffer, csmInt32 length, csmInt32 b
         case '0': case '1': case '2': case '3': case '4':
         case '5': case '6': case '7': case '8': case '9':
             {
-                char* ret_ptr;
-                f = strtof(const_cast<csmChar*>(buffer + i), &ret_ptr);
-                *outEndPos = static_cast<csmInt32>(ret_ptr - buffer);
+                f = ParseNumber(buffer, i, length, outEndPos);
+                if (_arena)
+                {
+                    // Floatの文字列表現は内部バッファに収まるので、デストラクタを呼ぶ必要はない
+                    return CSM_PLACEMENT_NEW(_arena->Allocate(sizeof(Float))) Float(f);
+                }
                 return CSM_NEW Float(f);
             }
         case '\"':
+            if (_arena)
+            {
+                const csmChar* view;
+                csmInt32 viewLength;
+                if (!ParseStringView(buffer, length, i + 1, outEndPos, &view, &viewLength)) return NULL;
+                return _arena->Track(CSM_PLACEMENT_NEW(_arena->Allocate(sizeof(ArenaString))) ArenaString(view, viewLength));
+            }
             return CSM_NEW String(ParseString(buffer, length, i + 1, outEndPos)); //\"の次の文字から
         case '[':
             o = ParseArray(buffer, length, i + 1, outEndPos);
@@ -438,7 +1298,7 @@ Value* CubismJson::ParseValue(const csmChar* buffer, csmInt32 length, csmInt32 b
         case 'n': //null以外にない
             if (i + 3 < length)
             {
-                o = CSM_NEW NullValue(); //開放できるようにする
+                o = _arena ? Value::NullValue : CSM_NEW NullValue(); //開放できるようにする
                 *outEndPos = i + 4;
             }
             else _error = "parse null";
@@ -479,7 +1339,7 @@ Value* CubismJson::ParseValue(const csmChar* buffer, csmInt32 length, csmInt32 b
 
 Map::~Map()
 {
-    csmMap<csmString, Value*>::const_iterator ite = _map.Begin();
+    csmHashMap<csmString, Value*>::const_iterator ite = _map.Begin();
     while (ite != _map.End())
     {
         Value* v = (*ite).Second;
@@ -490,6 +1350,11 @@ Map::~Map()
         ++ite;
     }
 
+    if (_compatibleMap)
+    {
+        CSM_DELETE(_compatibleMap);
+    }
+
     if (_keys)
     {
         CSM_DELETE(_keys);
@@ -509,5 +1374,199 @@ Array::~Array()
         }
     }
 }
+
+
+csmBool CubismJsonReader::Read(const csmByte* buffer, csmSizeInt size, CubismJsonHandler& handler)
+{
+    enum State
+    {
+        State_Value,        // 値を待つ
+        State_Key,          // オブジェクトのキーを待つ
+        State_Next          // , か閉じカッコを待つ
+    };
+
+    static const csmInt32 MaxDepth = 128;
+
+    if (!buffer)
+    {
+        return false;
+    }
+
+    const csmChar* json = reinterpret_cast<const csmChar*>(buffer);
+    const csmInt32 length = static_cast<csmInt32>(size);
+    csmChar containers[MaxDepth];  // 開いているカッコ。'{' か '['
+    csmInt32 depth = 0;
+    csmInt32 lineCount = 0;
+    const csmChar* error = NULL;
+    State state = State_Value;
+    csmInt32 i = 0;
+
+    // UTF-8のBOMは読み飛ばす
+    if (length >= 3 && memcmp(json, "\xEF\xBB\xBF", 3) == 0)
+    {
+        i = 3;
+    }
+
+    while (!error)
+    {
+        i = SkipWhitespace(json, i, length, &lineCount);
+        if (i >= length)
+        {
+            error = "unexpected end";
+            break;
+        }
+
+        const csmChar c = json[i];
+
+        if (state == State_Key)
+        {
+            if (c != '\"')
+            {
+                error = "key not found";
+                break;
+            }
+
+            const csmInt32 end = FindStringEnd(json, i + 1, length);
+            if (end < length && json[end] == '\"')
+            {
+                if (!handler.OnKey(json + i + 1, end - i - 1)) break;
+                i = end + 1;
+            }
+            else
+            {
+                csmString key;
+                error = UnescapeString(json, length, i + 1, &i, key);
+                if (error || !handler.OnKey(key.GetRawString(), key.GetLength())) break;
+            }
+
+            i = SkipWhitespace(json, i, length, &lineCount);
+            if (i >= length || json[i] != ':')
+            {
+                error = "':' not found";
+                break;
+            }
+            ++i;
+            state = State_Value;
+            continue;
+        }
+
+        if (state == State_Next)
+        {
+            const csmChar container = containers[depth - 1];
+
+            if (c == ',')
+            {
+                ++i;
+                state = container == '{' ? State_Key : State_Value;
+                continue;
+            }
+            if ((c == '}' && container == '{') || (c == ']' && container == '['))
+            {
+                ++i;
+                --depth;
+                if (!(c == '}' ? handler.OnEndObject() : handler.OnEndArray())) break;
+                if (depth == 0)
+                {
+                    return true;
+                }
+                continue;
+            }
+
+            error = "',' or closing bracket not found";
+            break;
+        }
+
+        // State_Value
+        switch (c)
+        {
+        case '{':
+        case '[':
+            if (depth >= MaxDepth)
+            {
+                error = "nesting too deep";
+                break;
+            }
+            if (!(c == '{' ? handler.OnStartObject() : handler.OnStartArray())) return false;
+            containers[depth++] = c;
+            i = SkipWhitespace(json, i + 1, length, &lineCount);
+
+            // 空のオブジェクトと配列
+            if (i < length && json[i] == (c == '{' ? '}' : ']'))
+            {
+                state = State_Next;
+            }
+            else
+            {
+                state = c == '{' ? State_Key : State_Value;
+            }
+            continue;
+        case '\"': {
+            const csmInt32 end = FindStringEnd(json, i + 1, length);
+            if (end < length && json[end] == '\"')
+            {
+                if (!handler.OnString(json + i + 1, end - i - 1)) return false;
+                i = end + 1;
+            }
+            else
+            {
+                csmString value;
+                error = UnescapeString(json, length, i + 1, &i, value);
+                if (error) break;
+                if (!handler.OnString(value.GetRawString(), value.GetLength())) return false;
+            }
+            break;
+        }
+        case '-': case '.':
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9': {
+            csmInt32 end;
+            const csmFloat32 value = ParseNumber(json, i, length, &end);
+            if (end <= i)
+            {
+                error = "illegal number";
+                break;
+            }
+            if (!handler.OnNumber(value)) return false;
+            i = end;
+            break;
+        }
+        case 't':
+        case 'f':
+        case 'n': {
+            const csmChar* literal = c == 't' ? "true" : c == 'f' ? "false" : "null";
+            const csmInt32 literalLength = static_cast<csmInt32>(strlen(literal));
+            if (i + literalLength > length || memcmp(json + i, literal, literalLength) != 0)
+            {
+                error = "illegal literal";
+                break;
+            }
+            if (!(c == 'n' ? handler.OnNull() : handler.OnBoolean(c == 't'))) return false;
+            i += literalLength;
+            break;
+        }
+        default:
+            error = "illegal value";
+            break;
+        }
+
+        if (error)
+        {
+            break;
+        }
+
+        // ルート要素が値だけの場合はここで終わる
+        if (depth == 0)
+        {
+            return true;
+        }
+        state = State_Next;
+    }
+
+    if (error)
+    {
+        CubismLogInfo("Json parse error : %s @line %d", error, lineCount + 1);
+    }
+    return false;
+}
 }}}}
 //------------ LIVE2D NAMESPACE ------------
@@ -0,0 +1,102 @@
+module;
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+export module Bundle;
+
+using namespace std;
+
+// Single-file model bundle (little endian):
+//   BundleHeader
+//   BundleEntry[entryCount]    sorted by name, byte-wise
+//   name pool                  entry names, relative to the model directory, '/' separated, not terminated
+//   payloads                   each starting at a multiple of BundleAlignment
+export
+{
+	inline constexpr uint32_t BundleMagic = 0x4244324C; // "L2DB"
+	inline constexpr uint32_t BundleVersion = 1;
+	// Covers csmAlignofMoc, so the moc3 payload can be revived inside the mapping.
+	inline constexpr uint64_t BundleAlignment = 64;
+
+	struct BundleHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t reserved;
+	};
+
+	struct BundleEntry
+	{
+		uint64_t offset;
+		uint64_t size;
+		uint32_t nameOffset;
+		uint32_t nameLength;
+	};
+
+	static_assert(sizeof(BundleHeader) == 16 && sizeof(BundleEntry) == 24);
+
+	class BundleReader final
+	{
+		uint8_t* Data = nullptr;
+		const BundleEntry* Entries = nullptr;
+		uint32_t Count = 0;
+
+		const BundleEntry* Lookup(string_view name) const
+		{
+			uint32_t low = 0, high = Count;
+			while (low < high)
+			{
+				const auto mid = low + (high - low) / 2;
+				const auto compare = GetName(mid).compare(name);
+				if (compare == 0) return Entries + mid;
+				if (compare < 0) low = mid + 1;
+				else high = mid;
+			}
+			return nullptr;
+		}
+
+	public:
+		BundleReader() = default;
+
+		// data must stay valid (and aligned to BundleAlignment) for the lifetime of the reader.
+		BundleReader(uint8_t* data, size_t size) : Data(data)
+		{
+			BundleHeader header;
+			if (size < sizeof(header)) throw runtime_error("Bundle is truncated");
+			memcpy(&header, data, sizeof(header));
+			if (header.magic != BundleMagic) throw runtime_error("Not a model bundle");
+			if (header.version != BundleVersion) throw runtime_error("Unsupported bundle version " + to_string(header.version));
+			if (header.entryCount > (size - sizeof(header)) / sizeof(BundleEntry)) throw runtime_error("Bundle index is truncated");
+			Entries = (const BundleEntry*)(data + sizeof(header));
+			Count = header.entryCount;
+			for (uint32_t i = 0; i < Count; i++)
+			{
+				const auto& entry = Entries[i];
+				if (entry.offset % BundleAlignment != 0 || entry.offset > size || entry.size > size - entry.offset ||
+					entry.nameOffset > size || entry.nameLength > size - entry.nameOffset)
+					throw runtime_error("Bundle entry " + to_string(i) + " is out of range");
+			}
+		}
+
+		explicit operator bool() const { return Data != nullptr; }
+
+		uint32_t GetEntryCount() const { return Count; }
+
+		string_view GetName(uint32_t index) const
+		{
+			return { (const char*)Data + Entries[index].nameOffset, Entries[index].nameLength };
+		}
+
+		// Returns the payload of the named entry, or a span without data if the bundle does not contain it.
+		span<uint8_t> Find(string_view name) const
+		{
+			const auto entry = Lookup(name);
+			if (!entry) return {};
+			return { Data + entry->offset, (size_t)entry->size };
+		}
+	};
+}
@@ -0,0 +1,197 @@
+module;
+#include <Framework/CubismFramework.hpp>
+#include <Framework/Model/CubismMoc.hpp>
+#include <Framework/Motion/CubismMotion.hpp>
+#include <Framework/Physics/CubismPhysics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <cstdio>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <glad/gl.h>
+#include <jni.h>
+#include <jnipp.h>
+module Live2D;
+
+import Util;
+
+using namespace Live2D::Cubism::Framework;
+using namespace L2D;
+
+std::mutex AssetCache::Mutex;
+std::unordered_map<std::string, std::weak_ptr<ModelAssets>> AssetCache::Entries;
+std::atomic<MotionResidency> AssetCache::Residency = MotionResidency::PreloadAll;
+std::atomic<size_t> AssetCache::MotionBudget = 0;
+std::mutex ParseCache::Mutex;
+std::string ParseCache::Directory;
+
+ModelAssets::ModelAssets(const std::string& key) : Key(key), Residency(AssetCache::Residency), MotionBudget(AssetCache::MotionBudget)
+{
+}
+
+ModelAssets::~ModelAssets()
+{
+	Motions.clear();
+	CubismPhysics::Delete(Physics);
+	CubismMoc::Delete(Moc);
+	for (const auto texture : Textures) TextureManager::Instance().ReleaseTexture(texture);
+	AssetCache::Forget(Key);
+}
+
+std::shared_ptr<CubismMotion> ModelAssets::AcquireMotion(const std::string& file, const std::function<CubismMotion*()>& load)
+{
+	{
+		std::lock_guard lock(MotionMutex);
+		if (const auto it = Motions.find(file); it != Motions.end())
+		{
+			RecentMotions.splice(RecentMotions.begin(), RecentMotions, it->second.Recent);
+			return it->second.Motion;
+		}
+	}
+	// Parsed outside the lock, so a motion requested by two threads at once may be parsed twice; the first one wins.
+	const auto loaded = load();
+	if (!loaded) return nullptr;
+	std::shared_ptr<CubismMotion> motion(loaded, [](CubismMotion* motion) { ACubismMotion::Delete(motion); });
+	std::lock_guard lock(MotionMutex);
+	const auto [it, inserted] = Motions.try_emplace(file, MotionEntry{ motion, motion->GetMotionDataSize() });
+	if (!inserted) return it->second.Motion;
+	RecentMotions.push_front(file);
+	it->second.Recent = RecentMotions.begin();
+	MotionBytes += it->second.Bytes;
+	if (Residency != MotionResidency::LazyBudgeted) return motion;
+	while (MotionBytes > MotionBudget && RecentMotions.size() > 1)
+	{
+		const auto victim = Motions.find(RecentMotions.back());
+		MotionBytes -= victim->second.Bytes;
+		Motions.erase(victim);
+		RecentMotions.pop_back();
+	}
+	return motion;
+}
+
+size_t ModelAssets::GetMemoryUsage()
+{
+	std::lock_guard lock(MotionMutex);
+	return MocBytes + MotionBytes + TextureBytes;
+}
+
+void ModelAssets::QueueTextures()
+{
+	if (TextureImages.empty()) return;
+	auto& manager = TextureManager::Instance();
+	Textures.assign(TextureImages.size(), nullptr);
+	for (size_t i = 0; i < TextureImages.size(); i++)
+	{
+		if (TextureImages[i].fileName.empty()) continue;
+		Textures[i] = manager.QueueTexture(TextureImages[i]);
+		TextureBytes += Textures[i]->bytes;
+	}
+	TextureImages.clear();
+}
+
+bool ModelAssets::TexturesReady() const
+{
+	// The queue is shared with other models, so only this model's textures are waited for.
+	return std::none_of(Textures.begin(), Textures.end(), [](const TextureManager::TextureInfo* texture) { return texture && texture->pending; });
+}
+
+std::shared_ptr<ModelAssets> AssetCache::Acquire(const std::string& key, const std::function<void(ModelAssets&)>& populate)
+{
+	std::shared_ptr<ModelAssets> assets;
+	std::promise<void> ready;
+	auto owner = false;
+	{
+		std::lock_guard lock(Mutex);
+		if (const auto it = Entries.find(key); it != Entries.end()) assets = it->second.lock();
+		if (!assets)
+		{
+			assets = std::make_shared<ModelAssets>(key);
+			assets->Ready = ready.get_future().share();
+			Entries[key] = assets;
+			owner = true;
+		}
+	}
+	if (!owner)
+	{
+		assets->Ready.get();
+		return assets;
+	}
+	try
+	{
+		populate(*assets);
+		ready.set_value();
+	}
+	catch (...)
+	{
+		{
+			std::lock_guard lock(Mutex);
+			if (const auto it = Entries.find(key); it != Entries.end() && it->second.lock() == assets) Entries.erase(it);
+		}
+		ready.set_exception(std::current_exception());
+		throw;
+	}
+	return assets;
+}
+
+void AssetCache::SetMotionResidency(JNIEnv* env, jclass, const jint mode, const jlong budget)
+{
+	if (mode < (jint)MotionResidency::PreloadAll || mode > (jint)MotionResidency::LazyBudgeted) return Throw(env, "Unknown motion residency mode");
+	Residency = (MotionResidency)mode;
+	MotionBudget = (size_t)std::max<jlong>(budget, 0);
+}
+
+void AssetCache::Forget(const std::string& key)
+{
+	std::lock_guard lock(Mutex);
+	if (const auto it = Entries.find(key); it != Entries.end() && it->second.expired()) Entries.erase(it);
+}
+
+std::string ParseCache::GetPath(const char* kind, const uint64_t hash)
+{
+	std::lock_guard lock(Mutex);
+	if (Directory.empty()) return {};
+	char name[64];
+	snprintf(name, sizeof(name), "/%016llx.%s.bin", (unsigned long long)hash, kind);
+	return Directory + name;
+}
+
+bool ParseCache::IsEnabled()
+{
+	std::lock_guard lock(Mutex);
+	return !Directory.empty();
+}
+
+std::shared_ptr<FileView> ParseCache::Find(const char* kind, const uint64_t hash)
+{
+	const auto path = GetPath(kind, hash);
+	if (path.empty() || !IsRegularFile(path)) return nullptr;
+	try
+	{
+		return std::make_shared<FileView>(path);
+	}
+	catch (const std::exception&)
+	{
+		return nullptr;
+	}
+}
+
+void ParseCache::Store(const char* kind, const uint64_t hash, csmVector<csmByte>& snapshot)
+{
+	// The cache is only an accelerator, so a snapshot that cannot be written is dropped.
+	if (const auto path = GetPath(kind, hash); !path.empty()) WriteFileAtomic(path, snapshot.GetPtr(), snapshot.GetSize());
+}
+
+void ParseCache::SetDirectory(JNIEnv* env, jclass, const jstring path)
+{
+	auto directory = path ? jni::Object(path).call<std::string>("toString") : std::string();
+	while (directory.size() > 1 && (directory.back() == '/' || directory.back() == '\\')) directory.pop_back();
+	if (!directory.empty() && !CreateDirectories(directory)) return Throw(env, "Failed to create the parse cache directory");
+	std::lock_guard lock(Mutex);
+	Directory = std::move(directory);
+}
@@ -3,13 +3,30 @@ module;
 #include <Framework/ICubismAllocator.hpp>
 #include <Framework/CubismModelSettingJson.hpp>
 #include <Framework/Model/CubismUserModel.hpp>
+#include <Framework/Motion/CubismMotion.hpp>
+#include <Framework/Physics/CubismPhysics.hpp>
+#include <Framework/Type/csmHashMap.hpp>
 #include <string>
 #include <functional>
 #include <glad/gl.h>
 #include <functional>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
 #include <jni.h>
+#include <jnipp.h>
 export module Live2D;
 
+import Bundle;
+import Util;
+
 using namespace Csm;
 using namespace std;
 using namespace Live2D::Cubism::Framework;
@@ -41,6 +58,10 @@ export namespace L2D
 		void DeallocateAligned(void* alignedMemory) override;
 	};
 
+	// Process-wide registry of the GL textures of every model. Textures are indexed by id, by canonical path
+	// and by a hash of the encoded image, so an atlas shared between models is uploaded once; a hash match is
+	// only shared once the pixels compare equal.
+	// Each Create/QueueTexture call takes a reference that ReleaseTexture gives back. Only used on the GL thread.
 	class TextureManager final
 	{
 	public:
@@ -50,30 +71,261 @@ export namespace L2D
 			int width;
 			int height;
 			std::string fileName;
+			uint64_t hash;
+			// Format of a texture file, 0 for a decoded png.
+			uint32_t format;
+			size_t bytes;
+			size_t references;
+			bool pending;
+			std::vector<std::string> paths;
 		};
-		csmVector<TextureInfo*> textures;
+		struct ImageLevel
+		{
+			int width;
+			int height;
+			size_t offset;
+			size_t size;
+		};
+		struct Image
+		{
+			std::string fileName;
+			int width;
+			int height;
+			std::shared_ptr<unsigned char> pixels;
+			uint64_t hash;
+			// Precomputed mip chain of a texture file, in pixels; empty for decoded pngs, whose mips are generated.
+			uint32_t format = 0;
+			std::vector<ImageLevel> levels;
+		};
+		struct PendingUpload
+		{
+			TextureInfo* info;
+			Image image;
+			// Bands of rows of the current level already uploaded.
+			int uploadedBands;
+			size_t uploadedLevels;
+		};
+		std::unordered_map<GLuint, std::unique_ptr<TextureInfo>> textures;
+		std::unordered_map<std::string, TextureInfo*> paths;
+		std::unordered_map<uint64_t, TextureInfo*> hashes;
+		std::deque<PendingUpload> uploads;
+		GLuint uploadBuffer = 0;
+		size_t gpuBytes = 0;
+		// Bytes streamed per frame by PumpFrame, however many models are loading; 0 uploads everything at once.
+		static std::atomic<size_t> UploadBudget;
+		// Compressed formats the context can sample, queried once the GL functions are loaded.
+		static std::vector<GLint> CompressedFormats;
 
 		TextureManager();
 		~TextureManager();
+		static TextureManager& Instance();
+		static Image DecodePng(const std::string& fileName, const csmByte* data, csmSizeInt size);
+		static Image DecodePngFile(const std::string& fileName);
+		// Maps a precomputed texture file; the image keeps view alive while its pixels are in use.
+		static Image ReadTextureFile(const std::string& fileName, const std::shared_ptr<FileView>& view, const csmByte* data, csmSizeInt size);
+		static void QueryFormats();
+		static bool IsFormatSupported(uint32_t format);
+		TextureInfo* CreateTexture(const Image& image);
 		TextureInfo* CreateTextureFromPngFile(const std::string& fileName);
+		// Allocates the texture right away and queues its pixels; it must not be sampled while it is pending.
+		TextureInfo* QueueTexture(const Image& image);
+		// Streams queued pixels through a pixel unpack buffer, about budget bytes (0 for no limit) but at least one band
+		// of rows, or of 4x4 block rows for compressed levels.
+		// Returns true once every queued texture is complete.
+		bool PumpUploads(size_t budget);
+		// Spends one frame's UploadBudget on the queue. updateAll calls it once per frame; engines that update
+		// models one by one call Live2DNative.pumpTextureUploads once per frame instead.
+		static void PumpFrame();
+		// Deletes every texture, whatever its references.
 		void ReleaseTextures();
+		void ReleaseTexture(TextureInfo* texture);
 		void ReleaseTexture(csmUint32 textureId);
 		void ReleaseTexture(const std::string& fileName);
 		TextureInfo* GetTextureInfoById(GLuint textureId) const;
+		// GPU memory held by all textures, mip chains included.
+		size_t GetMemoryUsage() const;
+		static void SetUploadBudget(JNIEnv* env, jclass cls, jlong budget);
+		static jlong GetMemoryUsageJ(JNIEnv* env, jclass cls);
+		static void PumpFrameJ(JNIEnv* env, jclass cls);
+	private:
+		static std::string Canonicalize(const std::string& fileName);
+		// GPU memory of image once uploaded, mip chain included.
+		static size_t GetImageBytes(const Image& image);
+		// Compares the pixels of texture, queued or read back from the GPU, with those of image.
+		bool HasSamePixels(const TextureInfo& texture, const Image& image);
+		TextureInfo* Find(const Image& image);
+		TextureInfo* AddTexture(const Image& image, const void* pixels);
+	};
+
+	enum class MotionResidency : jint
+	{
+		PreloadAll,
+		Lazy,
+		LazyBudgeted
+	};
+
+	// Immutable data parsed once per model path and shared by every Live2DModel loaded from it.
+	// Instances borrow the moc, the motion data and the textures, so each one deletes its own csmModel before letting go.
+	class ModelAssets final
+	{
+	public:
+		struct MotionEntry
+		{
+			std::shared_ptr<CubismMotion> Motion;
+			size_t Bytes;
+			std::list<std::string>::iterator Recent;
+		};
+
+		std::string Key;
+		CubismMoc* Moc = nullptr;
+		size_t MocBytes = 0;
+		std::mutex MocMutex;
+		MotionResidency Residency;
+		size_t MotionBudget;
+		size_t MotionBytes = 0;
+		std::unordered_map<std::string, MotionEntry> Motions;
+		std::list<std::string> RecentMotions;
+		std::mutex MotionMutex;
+		CubismPhysics* Physics = nullptr;
+		std::vector<TextureManager::Image> TextureImages;
+		std::vector<TextureManager::TextureInfo*> Textures;
+		size_t TextureBytes = 0;
+		std::shared_future<void> Ready;
+
+		explicit ModelAssets(const std::string& key);
+		~ModelAssets();
+		// Returns the parsed motion for file, running load and caching the result on a miss.
+		// Under LazyBudgeted the least recently used motions are evicted past MotionBudget; callers keep
+		// the returned reference for as long as a motion created from it may still be evaluated.
+		std::shared_ptr<CubismMotion> AcquireMotion(const std::string& file, const std::function<CubismMotion*()>& load);
+		size_t GetMemoryUsage();
+		// Queues the decoded textures on the first call; TextureManager::PumpFrame streams them in.
+		void QueueTextures();
+		// True once every texture of this model is complete.
+		bool TexturesReady() const;
+	};
+
+	class AssetCache final
+	{
+		static std::mutex Mutex;
+		static std::unordered_map<std::string, std::weak_ptr<ModelAssets>> Entries;
+	public:
+		// Motion residency applied to assets populated from now on.
+		static std::atomic<MotionResidency> Residency;
+		static std::atomic<size_t> MotionBudget;
+
+		// Returns the live assets for key, running populate on the calling thread if nobody holds them yet.
+		// Concurrent callers for the same key wait for that population and see its exception if it fails.
+		static std::shared_ptr<ModelAssets> Acquire(const std::string& key, const std::function<void(ModelAssets&)>& populate);
+		static void Forget(const std::string& key);
+		static void SetMotionResidency(JNIEnv* env, jclass cls, jint mode, jlong budget);
+		AssetCache() = delete;
+		~AssetCache() = delete;
+	};
+
+	// Opt-in on-disk cache of parsed assets, enabled by setting a directory. Snapshots are binary forms of the parsed
+	// Framework objects stored under a hash of the source bytes, so an edited source misses and is parsed again.
+	class ParseCache final
+	{
+		static std::mutex Mutex;
+		static std::string Directory;
+		static std::string GetPath(const char* kind, uint64_t hash);
+	public:
+		static bool IsEnabled();
+		// Returns the snapshot of kind stored for the source with hash, or nullptr on a miss.
+		static std::shared_ptr<FileView> Find(const char* kind, uint64_t hash);
+		static void Store(const char* kind, uint64_t hash, csmVector<csmByte>& snapshot);
+		static void SetDirectory(JNIEnv* env, jclass cls, jstring path);
+
+		// Runs create on the cached snapshot of source if there is one and on source itself otherwise, storing the
+		// snapshot of the result for the next time. A snapshot that create rejects is replaced.
+		template <typename T, typename F>
+		static T* Parse(const char* kind, const csmByte* source, const csmSizeInt size, const F& create)
+		{
+			if (!IsEnabled() || T::IsBinary(source, size)) return create(source, size);
+			const auto hash = HashBytes(source, size);
+			if (const auto snapshot = Find(kind, hash))
+			{
+				if (const auto parsed = create(snapshot->GetData(), snapshot->GetSize())) return parsed;
+			}
+			const auto parsed = create(source, size);
+			if (!parsed) return nullptr;
+			csmVector<csmByte> snapshot;
+			parsed->WriteBinary(snapshot);
+			Store(kind, hash, snapshot);
+			return parsed;
+		}
+
+		ParseCache() = delete;
+		~ParseCache() = delete;
+	};
+
+	// Steps the physics of every model updated in the same frame on the worker pool. Simulation only reads
+	// each model's own parameters, so the rigs of different models run concurrently; Simulate joins before
+	// returning and the caller writes the outputs back in model order, which keeps the frame deterministic.
+	class PhysicsWorld final
+	{
+		struct Entry
+		{
+			CubismPhysics* Physics;
+			CubismModel* Model;
+			csmFloat32 DeltaTime;
+		};
+
+		std::vector<Entry> Entries;
+	public:
+		void Add(CubismPhysics* physics, CubismModel* model, csmFloat32 deltaTime);
+		void Simulate();
+		void Clear();
 	};
 
 	class Live2DModel final : public CubismUserModel
 	{
+		enum class LoadState : jint
+		{
+			Loading,
+			Ready,
+			Failed
+		};
+
+		// Physics cost tier requested by the engine; applied on the next update, once the rig exists.
+		struct PhysicsQuality
+		{
+			csmInt32 MaxSubSteps = 0;
+			csmFloat32 FpsScale = 1.0f;
+			csmInt32 SkipFrames = 0;
+			// The reference solver unless the engine opts in: the SIMD one may round differently under FMA contraction.
+			CubismPhysics::SolverType Solver = CubismPhysics::SolverType_Reference;
+			// Rest detection changes outputs slightly, so it stays off (0) until the engine sets thresholds.
+			csmFloat32 SleepVelocityThreshold = 0.0f;
+			csmFloat32 WakeInputEpsilon = 0.0f;
+			bool Changed = false;
+		};
+
+		struct PlayingMotion
+		{
+			CubismMotionQueueEntryHandle Handle;
+			std::shared_ptr<CubismMotion> Source;
+			bool Finished;
+		};
+
 		std::string ModelName;
 		std::string ModelDir;
+		std::shared_ptr<FileView> BundleView;
+		BundleReader Bundle;
 		csmFloat32 UserTimeSeconds;
 		CubismModelSettingJson* ModelJson;
 		csmVector<CubismIdHandle> EyeBlinkIds;
 		csmVector<CubismIdHandle> LipSyncIds;
-		csmMap<csmString, ACubismMotion*> Motions;
-		csmMap<csmString, ACubismMotion*> Expressions;
+		csmHashMap<csmString, ACubismMotion*> Motions;
+		csmHashMap<csmString, ACubismMotion*> Expressions;
 		std::vector<csmString> ExpressionIds;
-		TextureManager TextureManager;
+		std::shared_ptr<ModelAssets> Assets;
+		std::vector<PlayingMotion> PlayingMotions;
+		PhysicsQuality Quality;
+		std::atomic<LoadState> State;
+		std::future<void> Pending;
+		jni::Object Callback;
 		const CubismId* AngleX;
 		const CubismId* AngleY;
 		const CubismId* AngleZ;
@@ -85,25 +337,42 @@ export namespace L2D
 		~Live2DModel() override;
 		std::string MakeAssetPath(const std::string& file);
 		void SetAssetDirectory(const std::string& path);
+		std::span<csmByte> OpenAsset(const std::string& file, std::shared_ptr<FileView>& view);
+		bool HasAsset(const std::string& file);
 		void LoadAsset(const std::string& file, const std::function<void(csmByte*, csmSizeInt)>& callback);
+		void LoadSharedAssets(ModelAssets& assets);
 		CubismMotionQueueEntryHandle StartMotion(const csmChar* group, csmInt32 no, csmInt32 priority, ACubismMotion::FinishedMotionCallback onFinishedMotionHandler = nullptr);
 		void SetExpression(const csmChar* id);
 		void ReleaseModelSetting();
 		void Draw(CubismMatrix44& matrix);
 		void ModelParamUpdate();
+		void ModelParamUpdateBeforePhysics();
+		void ModelParamUpdateAfterPhysics();
+		CubismMatrix44 MakeProjection(int width, int height);
 		void SetupTextures();
-		void PreloadMotionGroup(const csmChar* group);
+		CubismMotion* ParseMotion(const std::string& file);
+		CubismMotion* CreateMotion(const std::string& file, csmFloat32 fadeIn, csmFloat32 fadeOut, std::shared_ptr<CubismMotion>& source, ACubismMotion::FinishedMotionCallback onFinishedMotionHandler = nullptr);
 		void SetupModel();
+		void LoadModelData();
+		void SetupGraphics();
+		bool Poll();
 		void ModelOnUpdate(int width, int height, double currentTime);
 		bool HitTest(const csmChar* hitAreaName, csmFloat32 x, csmFloat32 y);
 		static void Load(JNIEnv* env, jobject self, jobject name, jobject path);
+		static void LoadAsync(JNIEnv* env, jobject self, jobject name, jobject path, jobject callback);
+		static jint GetStateJ(JNIEnv* env, jobject self);
+		static jlong GetMemoryUsageJ(JNIEnv* env, jobject self);
 		static void Update(JNIEnv* env, jobject self, jint width, jint height);
+		static void UpdateAll(JNIEnv* env, jclass cls, jobjectArray models, jint width, jint height);
 		static void StartMotionJ(JNIEnv* env, jobject self, jstring group, jint no, jint priority);
 		static void SetExpressionJ(JNIEnv* env, jobject self, jstring id);
 		static jint GetMotionCount(JNIEnv* env, jobject self, jstring group);
 		static jarray GetExpressions(JNIEnv* env, jobject self);
 		static jboolean HitTestJ(JNIEnv* env, jobject self, jstring id, jfloat x, jfloat y);
 		static void SetDraggingJ(JNIEnv* env, jobject self, jfloat x, jfloat y);
+		static void SetPhysicsQualityJ(JNIEnv* env, jobject self, jint maxSubSteps, jfloat fpsScale, jint skipFrames);
+		static void SetPhysicsSolverJ(JNIEnv* env, jobject self, jint solver);
+		static void SetPhysicsSleepJ(JNIEnv* env, jobject self, jfloat velocityThreshold, jfloat wakeEpsilon);
 		static void Release(JNIEnv* env, jclass cls, jlong ptr);
 	public:
 		static int RegisterMethods(JNIEnv* env);
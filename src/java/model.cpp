@@ -7,14 +7,24 @@ module;
 #include <Framework/Utils/CubismString.hpp>
 #include <Framework/CubismModelSettingJson.hpp>
 #include <Framework/Rendering/OpenGL/CubismRenderer_OpenGLCore.hpp>
+#include <algorithm>
 #include <functional>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <span>
+#include <stdexcept>
 #include <jni.h>
 #include <jnipp.h>
 #define GLAD_GL_IMPLEMENTATION
 #include <glad/gl.h>
 module Live2D;
 
+import Bundle;
 import Util;
+import Worker;
 
 using namespace jni;
 using namespace Live2D::Cubism::Framework;
@@ -25,21 +35,27 @@ static double (*GetTime)();
 void L2D::Init(JNIEnv*, jclass, jlong handle, jlong fun)
 {
 	gladLoadGL((GLADloadfunc)handle);
+	TextureManager::QueryFormats();
 	GetTime = (decltype(GetTime))fun;
 }
 
 int L2D::RegisterMethods(JNIEnv* env)
 {
 	const auto native = env->FindClass("com/primogemstudio/advancedfmk/live2d/Live2DNative");
-	JNINativeMethod methods[1];
+	JNINativeMethod methods[6];
 	methods[0] = JNIMethod("init", "(JJ)V", Init);
+	methods[1] = JNIMethod("setMotionResidency", "(IJ)V", AssetCache::SetMotionResidency);
+	methods[2] = JNIMethod("setTextureUploadBudget", "(J)V", TextureManager::SetUploadBudget);
+	methods[3] = JNIMethod("getTextureMemoryUsage", "()J", TextureManager::GetMemoryUsageJ);
+	methods[4] = JNIMethod("setParseCacheDirectory", "(Ljava/lang/String;)V", ParseCache::SetDirectory);
+	methods[5] = JNIMethod("pumpTextureUploads", "()V", TextureManager::PumpFrameJ);
 	return Live2DModel::RegisterMethods(env) + env->RegisterNatives(native, methods, std::size(methods));
 }
 
 int Live2DModel::RegisterMethods(JNIEnv* env)
 {
 	const auto native = env->FindClass("com/primogemstudio/advancedfmk/live2d/Live2DModel");
-	JNINativeMethod methods[9];
+	JNINativeMethod methods[16];
 	methods[0] = JNIMethod("load", "(Ljava/lang/String;Ljava/lang/String;)V", Load);
 	methods[1] = JNIMethod("update", "(II)V", Update);
 	methods[2] = JNIMethod("release", "(J)V", Release);
@@ -49,6 +65,13 @@ int Live2DModel::RegisterMethods(JNIEnv* env)
 	methods[6] = JNIMethod("getExpressions", "()[Ljava/lang/String;", GetExpressions);
 	methods[7] = JNIMethod("hitTest", "(Ljava/lang/String;FF)Z", HitTestJ);
 	methods[8] = JNIMethod("setDragging", "(FF)V", SetDraggingJ);
+	methods[9] = JNIMethod("loadAsync", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/Runnable;)V", LoadAsync);
+	methods[10] = JNIMethod("getState", "()I", GetStateJ);
+	methods[11] = JNIMethod("getMemoryUsage", "()J", GetMemoryUsageJ);
+	methods[12] = JNIMethod("updateAll", "([Lcom/primogemstudio/advancedfmk/live2d/Live2DModel;II)V", UpdateAll);
+	methods[13] = JNIMethod("setPhysicsQuality", "(IFI)V", SetPhysicsQualityJ);
+	methods[14] = JNIMethod("setPhysicsSolver", "(I)V", SetPhysicsSolverJ);
+	methods[15] = JNIMethod("setPhysicsSleep", "(FF)V", SetPhysicsSleepJ);
 	return env->RegisterNatives(native, methods, std::size(methods));
 }
 
@@ -59,6 +82,7 @@ static Live2DModel* Get(const jobject self)
 
 jboolean Live2DModel::HitTestJ(JNIEnv* env, jobject self, jstring id, jfloat x, jfloat y)
 {
+	if (!Get(self)->IsInitialized()) return false;
 	return Get(self)->HitTest(Object(id).call<std::string>("toString").data(), x, y);
 }
 
@@ -67,38 +91,137 @@ void Live2DModel::SetDraggingJ(JNIEnv* env, jobject self, jfloat x, jfloat y)
 	Get(self)->SetDragging(x, y);
 }
 
+void Live2DModel::SetPhysicsQualityJ(JNIEnv*, jobject self, jint maxSubSteps, jfloat fpsScale, jint skipFrames)
+{
+	auto& quality = Get(self)->Quality;
+	quality.MaxSubSteps = maxSubSteps;
+	quality.FpsScale = fpsScale;
+	quality.SkipFrames = skipFrames;
+	quality.Changed = true;
+}
+
+// 0 selects the reference solver, 1 the SIMD one; anything else falls back to the reference solver.
+void Live2DModel::SetPhysicsSolverJ(JNIEnv*, jobject self, jint solver)
+{
+	auto& quality = Get(self)->Quality;
+	quality.Solver = solver == CubismPhysics::SolverType_Simd ? CubismPhysics::SolverType_Simd : CubismPhysics::SolverType_Reference;
+	quality.Changed = true;
+}
+
+// Sub-rigs whose inputs hold still and whose particles move slower than velocityThreshold stop simulating until an
+// input moves by more than wakeEpsilon; 1e-3 for both suits typical rigs. A threshold of 0 turns it off.
+void Live2DModel::SetPhysicsSleepJ(JNIEnv*, jobject self, jfloat velocityThreshold, jfloat wakeEpsilon)
+{
+	auto& quality = Get(self)->Quality;
+	quality.SleepVelocityThreshold = velocityThreshold;
+	quality.WakeInputEpsilon = wakeEpsilon;
+	quality.Changed = true;
+}
+
 void Live2DModel::Update(JNIEnv*, jobject self, jint width, jint height)
 {
-	Get(self)->ModelOnUpdate(width, height, GetTime());
+	if (const auto model = Get(self); model->Poll()) model->ModelOnUpdate(width, height, GetTime());
+}
+
+// Updates and draws a frame's models with one shared delta time. Everything but the physics simulation runs
+// on the render thread in array order; the simulations of all models are spread over the worker pool.
+void Live2DModel::UpdateAll(JNIEnv* env, jclass, jobjectArray models, jint width, jint height)
+{
+	static PhysicsWorld world;
+	TextureManager::PumpFrame();
+	std::vector<Live2DModel*> ready;
+	for (jsize i = 0, count = env->GetArrayLength(models); i < count; i++)
+	{
+		const auto self = env->GetObjectArrayElement(models, i);
+		// A model listed twice is updated once: two simulations of one rig would race on the workers.
+		if (const auto model = Get(self); std::find(ready.begin(), ready.end(), model) == ready.end() && model->Poll()) ready.push_back(model);
+		env->DeleteLocalRef(self);
+	}
+	if (ready.empty()) return;
+	Timer::UpdateTime(GetTime());
+	world.Clear();
+	for (const auto model : ready)
+	{
+		model->ModelParamUpdateBeforePhysics();
+		if (model->_physics) world.Add(model->_physics, model->_model, Timer::GetDeltaTime());
+	}
+	world.Simulate();
+	for (const auto model : ready)
+	{
+		if (model->_physics) model->_physics->ApplyOutputs(model->_model);
+		model->ModelParamUpdateAfterPhysics();
+		auto projection = model->MakeProjection(width, height);
+		model->Draw(projection);
+	}
 }
 
-void Live2DModel::Load(JNIEnv*, jobject self, jobject name, jobject path)
+void Live2DModel::Load(JNIEnv* env, jobject self, jobject name, jobject path)
 {
 	Object self_obj(self), name_obj(name), path_obj(path);
 	const auto model = new Live2DModel(name_obj.call<std::string>("toString"), path_obj.call<std::string>("toString"));
-	model->SetupModel();
+	try
+	{
+		model->SetupModel();
+	}
+	catch (const std::exception& e)
+	{
+		// Exceptions must not cross the JNI boundary; the caller gets an exception and no model.
+		CubismLogError("Failed to load model %s: %s", model->ModelName.c_str(), e.what());
+		delete model;
+		return Throw(env, e.what());
+	}
+	catch (...)
+	{
+		CubismLogError("Failed to load model %s", model->ModelName.c_str());
+		delete model;
+		return Throw(env, "Failed to load model");
+	}
 	self_obj.set("ptr", (jlong)model);
 }
 
+void Live2DModel::LoadAsync(JNIEnv*, jobject self, jobject name, jobject path, jobject callback)
+{
+	Object self_obj(self), name_obj(name), path_obj(path);
+	const auto model = new Live2DModel(name_obj.call<std::string>("toString"), path_obj.call<std::string>("toString"));
+	if (callback) model->Callback = Object(callback);
+	model->Pending = WorkerPool::Instance().Submit([model] { model->LoadModelData(); });
+	self_obj.set("ptr", (jlong)model);
+}
+
+jint Live2DModel::GetStateJ(JNIEnv*, const jobject self)
+{
+	return (jint)Get(self)->State.load();
+}
+
+jlong Live2DModel::GetMemoryUsageJ(JNIEnv*, const jobject self)
+{
+	const auto model = Get(self);
+	if (!model->IsInitialized()) return 0;
+	return (jlong)model->Assets->GetMemoryUsage();
+}
+
 void Live2DModel::StartMotionJ(JNIEnv*, const jobject self, const jstring group, const jint no, const jint priority)
 {
+	if (!Get(self)->IsInitialized()) return;
 	Get(self)->StartMotion(Object(group).call<std::string>("toString").data(), no, priority);
 }
 
 void Live2DModel::SetExpressionJ(JNIEnv*, const jobject self, const jstring id)
 {
+	if (!Get(self)->IsInitialized()) return;
 	Get(self)->SetExpression(Object(id).call<std::string>("toString").data());
 }
 
 jint Live2DModel::GetMotionCount(JNIEnv*, const jobject self, const jstring group)
 {
+	if (!Get(self)->IsInitialized()) return 0;
 	return Get(self)->ModelJson->GetMotionCount(Object(group).call<std::string>("toString").data());
 }
 
 jarray Live2DModel::GetExpressions(JNIEnv*, const jobject self)
 {
 	auto ptr = Get(self);
-	Array<string> arr(ptr->ExpressionIds.size());
+	Array<string> arr(ptr->IsInitialized() ? ptr->ExpressionIds.size() : 0);
 	for (int i = 0; i < arr.getLength(); i++) arr.setElement(i, ptr->ExpressionIds[i].GetRawString());
 	return arr.makeLocalReference();
 }
@@ -108,7 +231,7 @@ void Live2DModel::Release(JNIEnv*, jclass, jlong ptr)
 	delete (Live2DModel*)ptr;
 }
 
-Live2DModel::Live2DModel(const std::string& name, const std::string& dir) : ModelName(name), ModelDir(dir), UserTimeSeconds(0.0f), ModelJson(nullptr)
+Live2DModel::Live2DModel(const std::string& name, const std::string& dir) : ModelName(name), ModelDir(dir), UserTimeSeconds(0.0f), ModelJson(nullptr), State(LoadState::Loading)
 {
 	AngleX = CubismFramework::GetIdManager()->GetId(DefaultParameterId::ParamAngleX);
 	AngleY = CubismFramework::GetIdManager()->GetId(DefaultParameterId::ParamAngleY);
@@ -120,7 +243,16 @@ Live2DModel::Live2DModel(const std::string& name, const std::string& dir) : Mode
 
 Live2DModel::~Live2DModel()
 {
+	if (Pending.valid()) Pending.wait();
 	ReleaseModelSetting();
+	if (_moc)
+	{
+		// The moc belongs to the shared assets, which may go away with this instance.
+		std::lock_guard lock(Assets->MocMutex);
+		if (_model) _moc->DeleteModel(_model);
+		_model = nullptr;
+		_moc = nullptr;
+	}
 }
 
 std::string Live2DModel::MakeAssetPath(const std::string& file)
@@ -133,40 +265,167 @@ void Live2DModel::SetAssetDirectory(const std::string& path)
 	ModelDir = path;
 }
 
+std::span<csmByte> Live2DModel::OpenAsset(const std::string& file, std::shared_ptr<FileView>& view)
+{
+	if (!Bundle)
+	{
+		view = std::make_shared<FileView>(MakeAssetPath(file));
+		return { view->GetData(), view->GetSize() };
+	}
+	const auto data = Bundle.Find(file);
+	if (!data.data()) throw std::runtime_error(file + " is missing from " + ModelDir);
+	view = BundleView;
+	return data;
+}
+
+bool Live2DModel::HasAsset(const std::string& file)
+{
+	if (!Bundle) return IsRegularFile(MakeAssetPath(file));
+	return Bundle.Find(file).data() != nullptr;
+}
+
 void Live2DModel::LoadAsset(const std::string& file, const std::function<void(csmByte*, csmSizeInt)>& callback)
 {
 	if (file.empty()) return;
-	auto buff = LoadFile(MakeAssetPath(file).c_str());
-	callback((uint8_t*)buff.data(), buff.size());
+	std::shared_ptr<FileView> view;
+	const auto data = OpenAsset(file, view);
+	callback(data.data(), (csmSizeInt)data.size());
 }
 
 void Live2DModel::SetupModel()
+{
+	LoadModelData();
+	Assets->QueueTextures();
+	TextureManager::Instance().PumpUploads(0);
+	SetupGraphics();
+}
+
+void Live2DModel::LoadSharedAssets(ModelAssets& assets)
+{
+	{
+		// The moc is revived inside the private mapping, which it keeps alive until it is deleted.
+		std::shared_ptr<FileView> view;
+		const auto data = OpenAsset(ModelJson->GetModelFileName(), view);
+		assets.Moc = CubismMoc::Create(data.data(), (csmSizeInt)data.size(), [](void*, void* owner) { delete (std::shared_ptr<FileView>*)owner; }, new std::shared_ptr<FileView>(std::move(view)));
+		if (!assets.Moc) throw std::runtime_error("Failed to load moc of " + ModelName);
+		// The revived moc lives in place inside the mapping, so its footprint is the size of the moc3 data.
+		assets.MocBytes = data.size();
+	}
+	std::vector<std::function<void()>> tasks;
+	tasks.emplace_back([this, &assets, file = std::string(ModelJson->GetPhysicsFileName())] {
+		LoadAsset(file, [&](auto buff, auto size) {
+			assets.Physics = ParseCache::Parse<CubismPhysics>("physics3", buff, size, [](auto data, auto length) { return CubismPhysics::Create(data, length); });
+			});
+		});
+	if (assets.Residency == MotionResidency::PreloadAll)
+	{
+		std::set<std::string> files;
+		for (csmInt32 i = 0; i < ModelJson->GetMotionGroupCount(); i++)
+		{
+			const csmChar* group = ModelJson->GetMotionGroupName(i);
+			for (csmInt32 no = 0; no < ModelJson->GetMotionCount(group); no++) files.emplace(ModelJson->GetMotionFileName(group, no));
+		}
+		files.erase("");
+		for (const auto& file : files) tasks.emplace_back([this, &assets, &file] { assets.AcquireMotion(file, [&] { return ParseMotion(file); }); });
+	}
+	assets.TextureImages.resize(ModelJson->GetTextureCount());
+	for (csmInt32 i = 0; i < ModelJson->GetTextureCount(); i++)
+	{
+		if (!strcmp(ModelJson->GetTextureFileName(i), "")) continue;
+		tasks.emplace_back([this, file = std::string(ModelJson->GetTextureFileName(i)), &image = assets.TextureImages[i]] {
+			// A precomputed texture file next to the png skips decoding and mip generation, if the context can sample its format.
+			if (const auto precomputed = file + ".l2dt"; HasAsset(precomputed))
+			{
+				std::shared_ptr<FileView> view;
+				const auto data = OpenAsset(precomputed, view);
+				image = L2D::TextureManager::ReadTextureFile(MakeAssetPath(precomputed), view, data.data(), (csmSizeInt)data.size());
+				if (L2D::TextureManager::IsFormatSupported(image.format)) return;
+			}
+			LoadAsset(file, [&](auto buff, auto size) { image = L2D::TextureManager::DecodePng(MakeAssetPath(file), buff, size); });
+			});
+	}
+	WorkerPool::Instance().ParallelFor(tasks.size(), [&tasks](size_t i) { tasks[i](); });
+}
+
+void Live2DModel::LoadModelData()
 {
 	_updating = true;
 	_initialized = false;
+	if (IsRegularFile(ModelDir))
+	{
+		// A bundle is mapped once and every asset, the moc included, is served from that mapping.
+		BundleView = std::make_shared<FileView>(ModelDir);
+		Bundle = BundleReader(BundleView->GetData(), BundleView->GetSize());
+	}
 	LoadAsset(ModelName + ".model3.json", [this](auto buff, auto size) { ModelJson = new CubismModelSettingJson(buff, size); });
-	LoadAsset(ModelJson->GetModelFileName(), [this](auto buff, auto size) { LoadModel(buff, size); });
-	for (auto expressionIndex = 0; expressionIndex < ModelJson->GetExpressionCount(); ++expressionIndex)
+	Assets = AssetCache::Acquire(ModelDir + ModelName, [this](auto& assets) { LoadSharedAssets(assets); });
 	{
-		LoadAsset(ModelJson->GetExpressionFileName(expressionIndex), [this, expressionIndex](const csmByte* buff, const csmSizeInt size) {
-			auto expressionName = ModelJson->GetExpressionName(expressionIndex);
-			if (auto motion = LoadExpression(buff, size, expressionName))
+		std::lock_guard lock(Assets->MocMutex);
+		_moc = Assets->Moc;
+		SetupModelFromMoc();
+	}
+	if (!_model) throw std::runtime_error("Failed to create model of " + ModelName);
+	if (Assets->Physics) _physics = CubismPhysics::Create(Assets->Physics);
+	{
+		auto count = ModelJson->GetEyeBlinkParameterCount();
+		if (count > 0) _eyeBlink = CubismEyeBlink::Create(ModelJson);
+		for (int i = 0; i < count; ++i) EyeBlinkIds.PushBack(ModelJson->GetEyeBlinkParameterId(i));
+		count = ModelJson->GetLipSyncParameterCount();
+		for (int i = 0; i < count; ++i) LipSyncIds.PushBack(ModelJson->GetLipSyncParameterId(i));
+	}
+	if (Assets->Residency == MotionResidency::PreloadAll)
+	{
+		for (csmInt32 i = 0; i < ModelJson->GetMotionGroupCount(); i++)
+		{
+			const csmChar* group = ModelJson->GetMotionGroupName(i);
+			for (csmInt32 no = 0; no < ModelJson->GetMotionCount(group); no++)
 			{
-				if (Expressions[expressionName])
-				{
-					ACubismMotion::Delete(Expressions[expressionName]);
-					Expressions[expressionName] = nullptr;
-					Expressions[expressionName] = motion;
-					return;
-				}
-				Expressions[expressionName] = motion;
-				ExpressionIds.emplace_back(expressionName);
+				auto name = Utils::CubismString::GetFormatedString("%s_%d", group, no);
+				std::shared_ptr<CubismMotion> source;
+				auto motion = CreateMotion(ModelJson->GetMotionFileName(group, no), ModelJson->GetMotionFadeInTimeValue(group, no), ModelJson->GetMotionFadeOutTimeValue(group, no), source);
+				if (!motion) continue;
+				if (Motions[name]) ACubismMotion::Delete(Motions[name]);
+				Motions[name] = motion;
 			}
+		}
+	}
+	std::vector<std::function<void()>> tasks;
+	std::vector<ACubismMotion*> expressions(ModelJson->GetExpressionCount());
+	for (csmInt32 i = 0; i < ModelJson->GetExpressionCount(); i++)
+	{
+		tasks.emplace_back([this, file = std::string(ModelJson->GetExpressionFileName(i)), name = ModelJson->GetExpressionName(i), &expression = expressions[i]] {
+			LoadAsset(file, [&](auto buff, auto size) {
+				expression = ParseCache::Parse<CubismExpressionMotion>("exp3", buff, size, [&](auto data, auto length) { return static_cast<CubismExpressionMotion*>(LoadExpression(data, length, name)); });
+				});
 			});
 	}
-	LoadAsset(ModelJson->GetPoseFileName(), [this](auto buff, auto size) { LoadPose(buff, size); });
-	LoadAsset(ModelJson->GetPhysicsFileName(), [this](auto buff, auto size) { LoadPhysics(buff, size); });
-	LoadAsset(ModelJson->GetUserDataFile(), [this](auto buff, auto size) { LoadUserData(buff, size); });
+	tasks.emplace_back([this, file = std::string(ModelJson->GetPoseFileName())] {
+		LoadAsset(file, [this](auto buff, auto size) { _pose = ParseCache::Parse<CubismPose>("pose3", buff, size, [](auto data, auto length) { return CubismPose::Create(data, length); }); });
+		});
+	tasks.emplace_back([this, file = std::string(ModelJson->GetUserDataFile())] { LoadAsset(file, [this](auto buff, auto size) { LoadUserData(buff, size); }); });
+	std::exception_ptr error;
+	try
+	{
+		WorkerPool::Instance().ParallelFor(tasks.size(), [&tasks](size_t i) { tasks[i](); });
+	}
+	catch (...)
+	{
+		error = std::current_exception();
+	}
+	for (csmUint32 i = 0; i < expressions.size(); i++)
+	{
+		if (!expressions[i]) continue;
+		auto expressionName = ModelJson->GetExpressionName(i);
+		if (Expressions[expressionName])
+		{
+			ACubismMotion::Delete(Expressions[expressionName]);
+			Expressions[expressionName] = expressions[i];
+			continue;
+		}
+		Expressions[expressionName] = expressions[i];
+		ExpressionIds.emplace_back(expressionName);
+	}
+	if (error) std::rethrow_exception(error);
 	{
 		_breath = CubismBreath::Create();
 		csmVector<CubismBreath::BreathParameterData> breathParameters;
@@ -177,51 +436,76 @@ void Live2DModel::SetupModel()
 		breathParameters.PushBack(CubismBreath::BreathParameterData(CubismFramework::GetIdManager()->GetId(DefaultParameterId::ParamBreath), 0.5f, 0.5f, 3.2345f, 0.5f));
 		_breath->SetParameters(breathParameters);
 	}
-	{
-		auto count = ModelJson->GetEyeBlinkParameterCount();
-		if (count > 0) _eyeBlink = CubismEyeBlink::Create(ModelJson);
-		for (int i = 0; i < count; ++i) EyeBlinkIds.PushBack(ModelJson->GetEyeBlinkParameterId(i));
-		count = ModelJson->GetLipSyncParameterCount();
-		for (int i = 0; i < count; ++i) LipSyncIds.PushBack(ModelJson->GetLipSyncParameterId(i));
-	}
 	{
 		csmMap<csmString, csmFloat32> layout;
 		ModelJson->GetLayoutMap(layout);
 		_modelMatrix->SetupFromLayout(layout);
 		_model->SaveParameters();
-		for (csmInt32 i = 0; i < ModelJson->GetMotionGroupCount(); i++)
-		{
-			const csmChar* group = ModelJson->GetMotionGroupName(i);
-			PreloadMotionGroup(group);
-		}
 		_motionManager->StopAllMotions();
 	}
+}
+
+void Live2DModel::SetupGraphics()
+{
 	CreateRenderer();
 	SetupTextures();
 	_updating = false;
 	_initialized = true;
+	State = LoadState::Ready;
 }
 
-void Live2DModel::PreloadMotionGroup(const csmChar* group)
+bool Live2DModel::Poll()
 {
-	const csmInt32 count = ModelJson->GetMotionCount(group);
-	for (csmInt32 i = 0; i < count; i++)
+	if (State != LoadState::Loading) return State == LoadState::Ready;
+	try
 	{
-		csmString name = Utils::CubismString::GetFormatedString("%s_%d", group, i);
-		csmString path = ModelJson->GetMotionFileName(group, i);
-		path = csmString(ModelDir.c_str()) + path;
-		auto buff = LoadFile(path.GetRawString());
-		if (auto motion = static_cast<CubismMotion*>(LoadMotion((uint8_t*)buff.data(), buff.size(), name.GetRawString())))
+		if (Pending.valid())
 		{
-			csmFloat32 fadeTime = ModelJson->GetMotionFadeInTimeValue(group, i);
-			if (fadeTime >= 0.0f) motion->SetFadeInTime(fadeTime);
-			fadeTime = ModelJson->GetMotionFadeOutTimeValue(group, i);
-			if (fadeTime >= 0.0f) motion->SetFadeOutTime(fadeTime);
-			motion->SetEffectIds(EyeBlinkIds, LipSyncIds);
-			if (Motions[name]) ACubismMotion::Delete(Motions[name]);
-			Motions[name] = motion;
+			if (Pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+			Pending.get();
 		}
+		// Textures stream in over several frames; the model is shown once all of them are complete.
+		Assets->QueueTextures();
+		if (!Assets->TexturesReady()) return false;
+		SetupGraphics();
+	}
+	catch (const std::exception& e)
+	{
+		CubismLogError("Failed to load model %s: %s", ModelName.c_str(), e.what());
+		State = LoadState::Failed;
+	}
+	catch (...)
+	{
+		CubismLogError("Failed to load model %s", ModelName.c_str());
+		State = LoadState::Failed;
+	}
+	if (!Callback.isNull())
+	{
+		Callback.call<void>("run");
+		Callback = Object();
 	}
+	return State == LoadState::Ready;
+}
+
+CubismMotion* Live2DModel::ParseMotion(const std::string& file)
+{
+	CubismMotion* motion = nullptr;
+	LoadAsset(file, [&](auto buff, auto size) {
+		motion = ParseCache::Parse<CubismMotion>("motion3", buff, size, [this](auto data, auto length) { return static_cast<CubismMotion*>(LoadMotion(data, length, nullptr)); });
+		});
+	return motion;
+}
+
+CubismMotion* Live2DModel::CreateMotion(const std::string& file, csmFloat32 fadeIn, csmFloat32 fadeOut, std::shared_ptr<CubismMotion>& source, ACubismMotion::FinishedMotionCallback onFinishedMotionHandler)
+{
+	if (file.empty()) return nullptr;
+	source = Assets->AcquireMotion(file, [&] { return ParseMotion(file); });
+	if (!source) return nullptr;
+	auto motion = CubismMotion::Create(source.get(), onFinishedMotionHandler);
+	if (fadeIn >= 0.0f) motion->SetFadeInTime(fadeIn);
+	if (fadeOut >= 0.0f) motion->SetFadeOutTime(fadeOut);
+	motion->SetEffectIds(EyeBlinkIds, LipSyncIds);
+	return motion;
 }
 
 void Live2DModel::ReleaseModelSetting()
@@ -238,28 +522,22 @@ CubismMotionQueueEntryHandle Live2DModel::StartMotion(const csmChar* group, csmI
 	if (!ModelJson->GetMotionCount(group)) return InvalidMotionQueueEntryHandleValue;
 	if (priority == Constants::PriorityForce) _motionManager->SetReservePriority(priority);
 	else if (!_motionManager->ReserveMotion(priority)) return InvalidMotionQueueEntryHandleValue;
-	auto fileName = ModelJson->GetMotionFileName(group, no);
 	auto name = Utils::CubismString::GetFormatedString("%s_%d", group, no);
 	auto motion = static_cast<CubismMotion*>(Motions[name.GetRawString()]);
+	std::shared_ptr<CubismMotion> source;
 	auto autoDelete = false;
 	if (!motion)
 	{
-		csmString path = fileName;
-		path = csmString(ModelDir.c_str()) + path;
-		auto buff = LoadFile(path.GetRawString());
-		motion = static_cast<CubismMotion*>(LoadMotion((uint8_t*)buff.data(), buff.size(), nullptr, onFinishedMotionHandler));
-		if (motion)
-		{
-			csmFloat32 fadeTime = ModelJson->GetMotionFadeInTimeValue(group, no);
-			if (fadeTime >= 0.0f) motion->SetFadeInTime(fadeTime);
-			fadeTime = ModelJson->GetMotionFadeOutTimeValue(group, no);
-			if (fadeTime >= 0.0f) motion->SetFadeOutTime(fadeTime);
-			motion->SetEffectIds(EyeBlinkIds, LipSyncIds);
-			autoDelete = true;
-		}
+		motion = CreateMotion(ModelJson->GetMotionFileName(group, no), ModelJson->GetMotionFadeInTimeValue(group, no), ModelJson->GetMotionFadeOutTimeValue(group, no), source, onFinishedMotionHandler);
+		if (!motion) return InvalidMotionQueueEntryHandleValue;
+		// Motions that can be evicted are not kept by the instance; the queue deletes them and they pin their data while queued.
+		if (Assets->Residency == MotionResidency::LazyBudgeted) autoDelete = true;
+		else Motions[name.GetRawString()] = motion;
 	}
 	else motion->SetFinishedMotionHandler(onFinishedMotionHandler);
-	return _motionManager->StartMotionPriority(motion, autoDelete, priority);
+	const auto handle = _motionManager->StartMotionPriority(motion, autoDelete, priority);
+	if (autoDelete) PlayingMotions.push_back({ handle, std::move(source), false });
+	return handle;
 }
 
 void Live2DModel::SetExpression(const csmChar* id)
@@ -269,18 +547,22 @@ void Live2DModel::SetExpression(const csmChar* id)
 
 void Live2DModel::SetupTextures()
 {
-	for (csmInt32 modelTextureNumber = 0; modelTextureNumber < ModelJson->GetTextureCount(); modelTextureNumber++)
+	for (csmUint32 modelTextureNumber = 0; modelTextureNumber < Assets->Textures.size(); modelTextureNumber++)
 	{
-		if (!strcmp(ModelJson->GetTextureFileName(modelTextureNumber), "")) continue;
-		csmString texturePath = ModelJson->GetTextureFileName(modelTextureNumber);
-		texturePath = csmString(ModelDir.c_str()) + texturePath;
-		auto texture = TextureManager.CreateTextureFromPngFile(texturePath.GetRawString());
-		GetRenderer<Rendering::CubismRenderer_OpenGLCore>()->BindTexture(modelTextureNumber, texture->id);
+		if (!Assets->Textures[modelTextureNumber]) continue;
+		GetRenderer<Rendering::CubismRenderer_OpenGLCore>()->BindTexture(modelTextureNumber, Assets->Textures[modelTextureNumber]->id);
 	}
 	GetRenderer<Rendering::CubismRenderer_OpenGLCore>()->IsPremultipliedAlpha(false);
 }
 
 void Live2DModel::ModelParamUpdate()
+{
+	ModelParamUpdateBeforePhysics();
+	if (_physics) _physics->Evaluate(_model, Timer::GetDeltaTime());
+	ModelParamUpdateAfterPhysics();
+}
+
+void Live2DModel::ModelParamUpdateBeforePhysics()
 {
 	auto deltaTimeSeconds = Timer::GetDeltaTime();
 	UserTimeSeconds += deltaTimeSeconds;
@@ -290,7 +572,13 @@ void Live2DModel::ModelParamUpdate()
 	csmBool motionUpdated = false;
 	_model->LoadParameters();
 	if (_motionManager->IsFinished()) StartMotion(Constants::MotionGroupIdle, 0, Constants::PriorityIdle);
-	else motionUpdated = _motionManager->UpdateMotion(_model, deltaTimeSeconds);
+	else
+	{
+		// Entries finished before this update are deleted by it, after which their motion data may be released.
+		for (auto& playing : PlayingMotions) playing.Finished = _motionManager->IsFinished(playing.Handle);
+		motionUpdated = _motionManager->UpdateMotion(_model, deltaTimeSeconds);
+		std::erase_if(PlayingMotions, [](const PlayingMotion& playing) { return playing.Finished; });
+	}
 	_model->SaveParameters();
 	_opacity = _model->GetModelOpacity();
 	if (!motionUpdated && _eyeBlink) _eyeBlink->UpdateParameters(_model, deltaTimeSeconds);
@@ -302,8 +590,23 @@ void Live2DModel::ModelParamUpdate()
 	_model->AddParameterValue(EyeBallX, _dragX);
 	_model->AddParameterValue(EyeBallY, _dragY);
 	if (_breath) _breath->UpdateParameters(_model, deltaTimeSeconds);
-	if (_physics) _physics->Evaluate(_model, deltaTimeSeconds);
-	if (_pose) _pose->UpdateParameters(_model, deltaTimeSeconds);
+	if (_physics && Quality.Changed)
+	{
+		auto options = _physics->GetOptions();
+		options.MaxSubSteps = Quality.MaxSubSteps;
+		options.FpsScale = Quality.FpsScale;
+		options.SkipFrames = Quality.SkipFrames;
+		options.Solver = Quality.Solver;
+		options.SleepVelocityThreshold = Quality.SleepVelocityThreshold;
+		options.WakeInputEpsilon = Quality.WakeInputEpsilon;
+		_physics->SetOptions(options);
+		Quality.Changed = false;
+	}
+}
+
+void Live2DModel::ModelParamUpdateAfterPhysics()
+{
+	if (_pose) _pose->UpdateParameters(_model, Timer::GetDeltaTime());
 	_model->Update();
 }
 
@@ -315,9 +618,8 @@ void Live2DModel::Draw(CubismMatrix44& matrix)
 	GetRenderer<Rendering::CubismRenderer_OpenGLCore>()->DrawModel();
 }
 
-void Live2DModel::ModelOnUpdate(int width, int height, double currentTime)
+CubismMatrix44 Live2DModel::MakeProjection(int width, int height)
 {
-	Timer::UpdateTime(currentTime);
 	CubismMatrix44 projection;
 	projection.LoadIdentity();
 	if (_model->GetCanvasWidth() > 1.0f && width < height)
@@ -326,6 +628,13 @@ void Live2DModel::ModelOnUpdate(int width, int height, double currentTime)
 		projection.Scale(1.0f, static_cast<float>(width) / static_cast<float>(height));
 	}
 	else projection.Scale(static_cast<float>(height) / static_cast<float>(width), 1.0f);
+	return projection;
+}
+
+void Live2DModel::ModelOnUpdate(int width, int height, double currentTime)
+{
+	Timer::UpdateTime(currentTime);
+	auto projection = MakeProjection(width, height);
 	ModelParamUpdate();
 	Draw(projection);
 }
@@ -0,0 +1,34 @@
+module;
+#include <Framework/CubismFramework.hpp>
+#include <Framework/Model/CubismModel.hpp>
+#include <Framework/Physics/CubismPhysics.hpp>
+#include <vector>
+#include <jni.h>
+#include <jnipp.h>
+module Live2D;
+
+import Worker;
+
+using namespace Live2D::Cubism::Framework;
+using namespace L2D;
+
+void PhysicsWorld::Add(CubismPhysics* physics, CubismModel* model, const csmFloat32 deltaTime)
+{
+	Entries.push_back({ physics, model, deltaTime });
+}
+
+// One task per model: the sub-rigs of a model feed each other through the parameter caches, and a rig steps
+// in microseconds, so splitting it further would cost more in hand-off than it saves.
+void PhysicsWorld::Simulate()
+{
+	WorkerPool::Instance().ParallelFor(Entries.size(), [this](const size_t i)
+	{
+		const auto& entry = Entries[i];
+		entry.Physics->Simulate(entry.Model, entry.DeltaTime);
+	});
+}
+
+void PhysicsWorld::Clear()
+{
+	Entries.clear();
+}
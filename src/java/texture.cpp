@@ -1,8 +1,19 @@
 module;
 #include <Framework/CubismModelSettingJson.hpp>
 #include <Framework/Model/CubismUserModel.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
 #include <string>
 #include <iostream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 #define STBI_NO_STDIO
 #define STBI_ONLY_PNG
@@ -10,76 +21,323 @@ module;
 #include "stb_image.h"
 #include <fstream>
 #include <glad/gl.h>
+#include <jni.h>
 module Live2D;
 
+import TextureFile;
 import Util;
 
 using namespace Live2D::Cubism::Framework;
 using namespace std;
 using namespace L2D;
 
+std::atomic<size_t> TextureManager::UploadBudget = 8 << 20;
+std::vector<GLint> TextureManager::CompressedFormats;
+
 TextureManager::TextureManager() = default;
 TextureManager::~TextureManager() = default;
 
-TextureManager::TextureInfo* TextureManager::CreateTextureFromPngFile(const std::string& fileName)
+TextureManager& TextureManager::Instance()
+{
+	static TextureManager manager;
+	return manager;
+}
+
+TextureManager::Image TextureManager::DecodePng(const std::string& fileName, const csmByte* data, csmSizeInt size)
 {
-	for (csmUint32 i = 0; i < textures.GetSize(); i++) if (textures[i]->fileName == fileName) return textures[i];
-	GLuint textureId;
 	int width, height, channels;
-	auto data = LoadFile(fileName.c_str());
-	auto png = stbi_load_from_memory((uint8_t*)data.data(), data.size(), &width, &height, &channels, STBI_rgb_alpha);
+	auto png = stbi_load_from_memory(data, (int)size, &width, &height, &channels, STBI_rgb_alpha);
+	if (!png) throw std::runtime_error("Failed to decode " + fileName);
+	return { fileName, width, height, std::shared_ptr<unsigned char>(png, stbi_image_free), HashBytes(data, size) };
+}
+
+TextureManager::Image TextureManager::DecodePngFile(const std::string& fileName)
+{
+	FileView file(fileName);
+	return DecodePng(fileName, file.GetData(), file.GetSize());
+}
+
+TextureManager::Image TextureManager::ReadTextureFile(const std::string& fileName, const std::shared_ptr<FileView>& view, const csmByte* data, csmSizeInt size)
+{
+	const TextureFileReader reader(data, size);
+	const auto& header = reader.GetHeader();
+	Image image = { fileName, (int)header.width, (int)header.height, std::shared_ptr<unsigned char>(view, (unsigned char*)data), HashBytes(data, size), header.format };
+	for (uint32_t i = 0; i < header.levelCount; i++)
+	{
+		const auto& level = reader.GetLevel(i);
+		image.levels.push_back({ (int)level.width, (int)level.height, (size_t)level.offset, (size_t)level.size });
+	}
+	return image;
+}
+
+void TextureManager::QueryFormats()
+{
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+	CompressedFormats.assign(count, 0);
+	if (count > 0) glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, CompressedFormats.data());
+}
+
+bool TextureManager::IsFormatSupported(const uint32_t format)
+{
+	if (format == TextureFormatRGBA8) return true;
+	return std::find(CompressedFormats.begin(), CompressedFormats.end(), (GLint)format) != CompressedFormats.end();
+}
+
+static void UploadLevel(const TextureManager::Image& image, const size_t index, const void* data)
+{
+	const auto& level = image.levels[index];
+	if (IsCompressedTextureFormat(image.format)) glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)index, image.format, level.width, level.height, 0, (GLsizei)level.size, data);
+	else glTexImage2D(GL_TEXTURE_2D, (GLint)index, GL_RGBA, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+}
+
+std::string TextureManager::Canonicalize(const std::string& fileName)
+{
+	// Lexical only: bundle entries do not exist on disk, and links to the same file are caught by the content hash.
+	return std::filesystem::path(fileName).lexically_normal().generic_string();
+}
+
+size_t TextureManager::GetImageBytes(const Image& image)
+{
+	// Level 0 plus the generated mip chain.
+	if (image.levels.empty()) return (size_t)image.width * image.height * 4 * 4 / 3;
+	size_t bytes = 0;
+	for (const auto& level : image.levels) bytes += level.size;
+	return bytes;
+}
+
+static std::span<const unsigned char> GetLevelPixels(const TextureManager::Image& image, const size_t index)
+{
+	if (image.levels.empty()) return { image.pixels.get(), (size_t)image.width * image.height * 4 };
+	return { image.pixels.get() + image.levels[index].offset, image.levels[index].size };
+}
+
+bool TextureManager::HasSamePixels(const TextureInfo& texture, const Image& image)
+{
+	if (texture.width != image.width || texture.height != image.height || texture.format != image.format || texture.bytes != GetImageBytes(image)) return false;
+	// Generated mips follow from level 0, so only texture files are compared level by level.
+	const auto levels = std::max<size_t>(image.levels.size(), 1);
+	if (texture.pending)
+	{
+		const auto it = std::find_if(uploads.begin(), uploads.end(), [&](const PendingUpload& upload) { return upload.info == &texture; });
+		if (it != uploads.end())
+		{
+			for (size_t i = 0; i < levels; i++)
+			{
+				const auto queued = GetLevelPixels(it->image, i), pixels = GetLevelPixels(image, i);
+				if (!std::equal(queued.begin(), queued.end(), pixels.begin(), pixels.end())) return false;
+			}
+			return true;
+		}
+	}
+	// The source pixels are gone once uploaded, so they are read back; this only happens when loading a likely duplicate.
+	std::vector<unsigned char> uploaded;
+	auto same = true;
+	glBindTexture(GL_TEXTURE_2D, texture.id);
+	for (size_t i = 0; same && i < levels; i++)
+	{
+		const auto pixels = GetLevelPixels(image, i);
+		uploaded.resize(pixels.size());
+		if (IsCompressedTextureFormat(image.format)) glGetCompressedTexImage(GL_TEXTURE_2D, (GLint)i, uploaded.data());
+		else glGetTexImage(GL_TEXTURE_2D, (GLint)i, GL_RGBA, GL_UNSIGNED_BYTE, uploaded.data());
+		same = std::equal(uploaded.begin(), uploaded.end(), pixels.begin(), pixels.end());
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return same;
+}
+
+TextureManager::TextureInfo* TextureManager::Find(const Image& image)
+{
+	auto path = Canonicalize(image.fileName);
+	if (const auto it = paths.find(path); it != paths.end()) return it->second;
+	// The hash only picks a candidate; a collision must not put another image on this model.
+	const auto it = hashes.find(image.hash);
+	if (it == hashes.end() || !HasSamePixels(*it->second, image)) return nullptr;
+	it->second->paths.push_back(path);
+	paths.emplace(std::move(path), it->second);
+	return it->second;
+}
+
+TextureManager::TextureInfo* TextureManager::AddTexture(const Image& image, const void* pixels)
+{
+	GLuint textureId;
 	glGenTextures(1, &textureId);
 	glBindTexture(GL_TEXTURE_2D, textureId);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, png);
-	glGenerateMipmap(GL_TEXTURE_2D);
+	if (image.levels.empty())
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		if (pixels) glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+	{
+		// Queued textures get every level allocated here and filled band by band by PumpUploads.
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)image.levels.size() - 1);
+		for (size_t i = 0; i < image.levels.size(); i++) UploadLevel(image, i, pixels ? image.pixels.get() + image.levels[i].offset : nullptr);
+	}
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glBindTexture(GL_TEXTURE_2D, 0);
-	stbi_image_free(png);
-	auto textureInfo = new TextureInfo();
-	if (textureInfo != nullptr)
+	auto textureInfo = std::make_unique<TextureInfo>();
+	textureInfo->id = textureId;
+	textureInfo->width = image.width;
+	textureInfo->height = image.height;
+	textureInfo->fileName = image.fileName;
+	textureInfo->hash = image.hash;
+	textureInfo->format = image.format;
+	textureInfo->bytes = GetImageBytes(image);
+	textureInfo->references = 1;
+	textureInfo->pending = pixels == nullptr;
+	textureInfo->paths.push_back(Canonicalize(image.fileName));
+	const auto texture = textureInfo.get();
+	paths.emplace(texture->paths.front(), texture);
+	hashes.emplace(texture->hash, texture);
+	textures.emplace(textureId, std::move(textureInfo));
+	gpuBytes += texture->bytes;
+	return texture;
+}
+
+TextureManager::TextureInfo* TextureManager::CreateTexture(const Image& image)
+{
+	if (const auto texture = Find(image))
 	{
-		textureInfo->fileName = fileName;
-		textureInfo->width = width;
-		textureInfo->height = height;
-		textureInfo->id = textureId;
-		textures.PushBack(textureInfo);
+		texture->references++;
+		return texture;
 	}
-	return textureInfo;
+	return AddTexture(image, image.pixels.get());
 }
 
-void TextureManager::ReleaseTextures()
+TextureManager::TextureInfo* TextureManager::QueueTexture(const Image& image)
 {
-	for (csmUint32 i = 0; i < textures.GetSize(); i++) delete textures[i];
-	textures.Clear();
+	if (const auto texture = Find(image))
+	{
+		texture->references++;
+		return texture;
+	}
+	const auto texture = AddTexture(image, nullptr);
+	uploads.push_back({ texture, image, 0, 0 });
+	return texture;
 }
 
-void TextureManager::ReleaseTexture(const csmUint32 textureId)
+bool TextureManager::PumpUploads(const size_t budget)
 {
-	for (csmUint32 i = 0; i < textures.GetSize(); i++)
+	if (uploads.empty()) return true;
+	if (!uploadBuffer) glGenBuffers(1, &uploadBuffer);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffer);
+	size_t uploaded = 0;
+	while (!uploads.empty() && (budget == 0 || uploaded < budget))
 	{
-		if (textures[i]->id != textureId) continue;
-		delete textures[i];
-		textures.Remove(i);
-		break;
+		auto& upload = uploads.front();
+		// A decoded png is a single level whose mips are generated at the end; a texture file carries every level.
+		const auto precomputed = !upload.image.levels.empty();
+		const auto level = precomputed ? upload.image.levels[upload.uploadedLevels] : ImageLevel{ upload.image.width, upload.image.height, 0, (size_t)upload.image.width * upload.image.height * 4 };
+		const auto compressed = precomputed && IsCompressedTextureFormat(upload.image.format);
+		// Levels go up in bands of rows, or of 4x4 block rows when compressed; every band of a level has the same size.
+		const auto bandRows = compressed ? 4 : 1;
+		const auto bands = (level.height + bandRows - 1) / bandRows;
+		const auto bandBytes = level.size / bands;
+		auto count = bands - upload.uploadedBands;
+		if (budget != 0) count = (int)std::clamp<size_t>((budget - uploaded) / bandBytes, 1, count);
+		const auto bytes = bandBytes * count;
+		const auto source = upload.image.pixels.get() + level.offset + bandBytes * upload.uploadedBands;
+		// Orphaning the buffer lets the driver keep transferring the previous chunk while this one is written.
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)bytes, nullptr, GL_STREAM_DRAW);
+		const auto mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (mapped) memcpy(mapped, source, bytes);
+		const auto buffered = mapped && glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		if (!buffered) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glBindTexture(GL_TEXTURE_2D, upload.info->id);
+		const auto y = upload.uploadedBands * bandRows;
+		const auto height = std::min(count * bandRows, level.height - y);
+		if (compressed) glCompressedTexSubImage2D(GL_TEXTURE_2D, (GLint)upload.uploadedLevels, 0, y, level.width, height, upload.image.format, (GLsizei)bytes, buffered ? nullptr : source);
+		else glTexSubImage2D(GL_TEXTURE_2D, (GLint)upload.uploadedLevels, 0, y, level.width, height, GL_RGBA, GL_UNSIGNED_BYTE, buffered ? nullptr : source);
+		if (!buffered) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffer);
+		uploaded += bytes;
+		upload.uploadedBands += count;
+		if (upload.uploadedBands < bands) continue;
+		upload.uploadedBands = 0;
+		if (precomputed && ++upload.uploadedLevels < upload.image.levels.size()) continue;
+		if (!precomputed) glGenerateMipmap(GL_TEXTURE_2D);
+		upload.info->pending = false;
+		uploads.pop_front();
 	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	if (!uploads.empty()) return false;
+	glDeleteBuffers(1, &uploadBuffer);
+	uploadBuffer = 0;
+	return true;
 }
 
-void TextureManager::ReleaseTexture(const std::string& fileName)
+void TextureManager::PumpFrame()
+{
+	Instance().PumpUploads(UploadBudget);
+}
+
+TextureManager::TextureInfo* TextureManager::CreateTextureFromPngFile(const std::string& fileName)
 {
-	for (csmUint32 i = 0; i < textures.GetSize(); i++)
+	if (const auto it = paths.find(Canonicalize(fileName)); it != paths.end())
 	{
-		if (textures[i]->fileName == fileName)
-		{
-			delete textures[i];
-			textures.Remove(i);
-			break;
-		}
+		it->second->references++;
+		return it->second;
 	}
+	return CreateTexture(DecodePngFile(fileName));
+}
+
+void TextureManager::ReleaseTextures()
+{
+	uploads.clear();
+	if (uploadBuffer) glDeleteBuffers(1, &uploadBuffer);
+	uploadBuffer = 0;
+	for (const auto& [id, texture] : textures) glDeleteTextures(1, &texture->id);
+	textures.clear();
+	paths.clear();
+	hashes.clear();
+	gpuBytes = 0;
+}
+
+void TextureManager::ReleaseTexture(TextureInfo* texture)
+{
+	if (!texture || --texture->references > 0) return;
+	if (texture->pending) std::erase_if(uploads, [&](const PendingUpload& upload) { return upload.info == texture; });
+	for (const auto& path : texture->paths) paths.erase(path);
+	if (const auto it = hashes.find(texture->hash); it != hashes.end() && it->second == texture) hashes.erase(it);
+	gpuBytes -= texture->bytes;
+	glDeleteTextures(1, &texture->id);
+	textures.erase(texture->id);
+}
+
+void TextureManager::ReleaseTexture(const csmUint32 textureId)
+{
+	ReleaseTexture(GetTextureInfoById(textureId));
+}
+
+void TextureManager::ReleaseTexture(const std::string& fileName)
+{
+	if (const auto it = paths.find(Canonicalize(fileName)); it != paths.end()) ReleaseTexture(it->second);
 }
 
 TextureManager::TextureInfo* TextureManager::GetTextureInfoById(GLuint textureId) const
 {
-	for (csmUint32 i = 0; i < textures.GetSize(); i++) if (textures[i]->id == textureId) return textures[i];
-	return nullptr;
+	const auto it = textures.find(textureId);
+	return it != textures.end() ? it->second.get() : nullptr;
+}
+
+size_t TextureManager::GetMemoryUsage() const
+{
+	return gpuBytes;
+}
+
+void TextureManager::SetUploadBudget(JNIEnv*, jclass, const jlong budget)
+{
+	UploadBudget = (size_t)std::max<jlong>(budget, 0);
+}
+
+jlong TextureManager::GetMemoryUsageJ(JNIEnv*, jclass)
+{
+	return (jlong)Instance().GetMemoryUsage();
+}
+
+void TextureManager::PumpFrameJ(JNIEnv*, jclass)
+{
+	PumpFrame();
 }
@@ -0,0 +1,102 @@
+module;
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+export module TextureFile;
+
+using namespace std;
+
+// Precomputed texture with its whole mip chain (little endian), stored next to the source png as <png>.l2dt:
+//   TextureFileHeader
+//   TextureFileLevel[levelCount]   level 0 first, each level half the size of the previous one
+//   payloads                       each starting at a multiple of TextureFileAlignment
+// format is the GL internal format of every level, so it can be handed to glCompressedTexImage2D as is.
+export
+{
+	inline constexpr uint32_t TextureFileMagic = 0x5444324C; // "L2DT"
+	inline constexpr uint32_t TextureFileVersion = 1;
+	inline constexpr uint64_t TextureFileAlignment = 16;
+
+	inline constexpr uint32_t TextureFormatRGBA8 = 0x8058;       // GL_RGBA8
+	inline constexpr uint32_t TextureFormatBC7 = 0x8E8C;         // GL_COMPRESSED_RGBA_BPTC_UNORM
+	inline constexpr uint32_t TextureFormatETC2 = 0x9278;        // GL_COMPRESSED_RGBA8_ETC2_EAC
+	inline constexpr uint32_t TextureFormatASTC4x4 = 0x93B0;     // GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+
+	struct TextureFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t format;
+		uint32_t width;
+		uint32_t height;
+		uint32_t levelCount;
+		uint32_t reserved[2];
+	};
+
+	struct TextureFileLevel
+	{
+		uint64_t offset;
+		uint64_t size;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	static_assert(sizeof(TextureFileHeader) == 32 && sizeof(TextureFileLevel) == 24);
+
+	inline bool IsCompressedTextureFormat(const uint32_t format)
+	{
+		return format == TextureFormatBC7 || format == TextureFormatETC2 || format == TextureFormatASTC4x4;
+	}
+
+	// Bytes of one level; all supported compressed formats store a 4x4 block in 16 bytes.
+	inline uint64_t GetTextureLevelSize(const uint32_t format, const uint32_t width, const uint32_t height)
+	{
+		if (IsCompressedTextureFormat(format)) return (uint64_t)((width + 3) / 4) * ((height + 3) / 4) * 16;
+		return (uint64_t)width * height * 4;
+	}
+
+	class TextureFileReader final
+	{
+		const uint8_t* Data = nullptr;
+		TextureFileHeader Header = {};
+		const TextureFileLevel* Levels = nullptr;
+
+	public:
+		TextureFileReader() = default;
+
+		// data must stay valid for the lifetime of the reader.
+		TextureFileReader(const uint8_t* data, size_t size) : Data(data)
+		{
+			if (size < sizeof(Header)) throw runtime_error("Texture file is truncated");
+			memcpy(&Header, data, sizeof(Header));
+			if (Header.magic != TextureFileMagic) throw runtime_error("Not a texture file");
+			if (Header.version != TextureFileVersion) throw runtime_error("Unsupported texture file version " + to_string(Header.version));
+			if (Header.format != TextureFormatRGBA8 && !IsCompressedTextureFormat(Header.format)) throw runtime_error("Unknown texture format " + to_string(Header.format));
+			if (Header.levelCount == 0 || Header.levelCount > 32 || Header.levelCount > (size - sizeof(Header)) / sizeof(TextureFileLevel))
+				throw runtime_error("Texture level table is truncated");
+			Levels = (const TextureFileLevel*)(data + sizeof(Header));
+			for (uint32_t i = 0; i < Header.levelCount; i++)
+			{
+				const auto& level = Levels[i];
+				if (level.width != max(Header.width >> i, 1u) || level.height != max(Header.height >> i, 1u) ||
+					level.size != GetTextureLevelSize(Header.format, level.width, level.height) ||
+					level.offset % TextureFileAlignment != 0 || level.offset > size || level.size > size - level.offset)
+					throw runtime_error("Texture level " + to_string(i) + " is out of range");
+			}
+		}
+
+		explicit operator bool() const { return Data != nullptr; }
+
+		const TextureFileHeader& GetHeader() const { return Header; }
+
+		const TextureFileLevel& GetLevel(uint32_t index) const { return Levels[index]; }
+
+		span<const uint8_t> GetLevelData(uint32_t index) const
+		{
+			return { Data + Levels[index].offset, (size_t)Levels[index].size };
+		}
+	};
+}
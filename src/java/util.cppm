@@ -1,40 +1,225 @@
 module;
-#include <fstream>
-#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
 #include <Framework/CubismFramework.hpp>
 #include <jni.h>
 #ifdef _WIN32
 #include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 export module Util;
 
 using namespace std;
 using namespace Csm;
 
+#ifdef _WIN32
+wstring Widen(const string& path)
+{
+	wstring convert;
+	auto len = (int)path.size();
+	auto size = MultiByteToWideChar(CP_UTF8, 0, path.data(), len, nullptr, 0);
+	convert.resize(size);
+	MultiByteToWideChar(CP_UTF8, 0, path.data(), len, convert.data(), size);
+	return convert;
+}
+#endif
+
 export
 {
-	vector<char> LoadFile(const char* path)
+	bool IsRegularFile(const string& path)
 	{
 #ifdef _WIN32
-		wstring convert;
+		auto attributes = GetFileAttributesW(Widen(path).c_str());
+		return attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+		struct stat info;
+		return stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+#endif
+	}
+
+	// Fast non-cryptographic 64-bit hash of a byte range, for content-addressed caches.
+	uint64_t HashBytes(const void* data, size_t size)
+	{
+		constexpr uint64_t Mix = 0x9E3779B97F4A7C15ull;
+		auto bytes = (const unsigned char*)data;
+		uint64_t hash = 0xCBF29CE484222325ull ^ (size * Mix);
+		for (; size >= 8; bytes += 8, size -= 8)
+		{
+			uint64_t word;
+			memcpy(&word, bytes, 8);
+			word *= Mix;
+			hash = (hash ^ (word ^ (word >> 31))) * 0xBF58476D1CE4E5B9ull;
+			hash = (hash << 27) | (hash >> 37);
+		}
+		uint64_t tail = 0;
+		if (size) memcpy(&tail, bytes, size);
+		hash = (hash ^ tail) * Mix;
+		hash ^= hash >> 32;
+		hash *= 0x94D049BB133111EBull;
+		return hash ^ (hash >> 29);
+	}
+
+	// Creates path and its missing parents; true if the directory exists afterwards.
+	bool CreateDirectories(const string& path)
+	{
+		for (size_t separator = path.find_first_of("/\\", 1); ; separator = path.find_first_of("/\\", separator + 1))
 		{
-			auto len = (int)strlen(path);
-			auto size = MultiByteToWideChar(CP_UTF8, 0, path, len, nullptr, 0);
-			convert.resize(size);
-			MultiByteToWideChar(CP_UTF8, 0, path, len, convert.data(), size);
+			const auto parent = path.substr(0, separator);
+#ifdef _WIN32
+			CreateDirectoryW(Widen(parent).c_str(), nullptr);
+#else
+			mkdir(parent.c_str(), 0755);
+#endif
+			if (separator == string::npos) break;
 		}
-		ifstream in(convert, ios::binary);
+#ifdef _WIN32
+		auto attributes = GetFileAttributesW(Widen(path).c_str());
+		return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
 #else
-		ifstream in(path, ios::binary);
+		struct stat info;
+		return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
 #endif
-		in.seekg(0, ios::end);
-		auto size = (int)in.tellg();
-		in.seekg(0, ios::beg);
-		vector<char> buff(size);
-		in.read(buff.data(), size);
-		return buff;
 	}
 
+	// Writes a whole file through a temporary sibling that is renamed over path, so concurrent readers
+	// and writers in any process only ever see a complete file. Returns false without throwing on failure.
+	bool WriteFileAtomic(const string& path, const void* data, size_t size)
+	{
+		static atomic<uint64_t> Sequence = 0;
+#ifdef _WIN32
+		const auto process = (uint64_t)GetCurrentProcessId();
+#else
+		const auto process = (uint64_t)getpid();
+#endif
+		const auto temporary = path + "." + to_string(process) + "." + to_string(Sequence++) + ".tmp";
+#ifdef _WIN32
+		auto file = CreateFileW(Widen(temporary).c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		auto written = true;
+		for (auto bytes = (const char*)data; size > 0;)
+		{
+			DWORD chunk = 0;
+			if (!WriteFile(file, bytes, (DWORD)(size < (1u << 30) ? size : (1u << 30)), &chunk, nullptr) || chunk == 0)
+			{
+				written = false;
+				break;
+			}
+			bytes += chunk;
+			size -= chunk;
+		}
+		CloseHandle(file);
+		if (written && MoveFileExW(Widen(temporary).c_str(), Widen(path).c_str(), MOVEFILE_REPLACE_EXISTING)) return true;
+		DeleteFileW(Widen(temporary).c_str());
+		return false;
+#else
+		const auto file = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (file < 0) return false;
+		auto written = true;
+		for (auto bytes = (const char*)data; size > 0;)
+		{
+			const auto chunk = write(file, bytes, size);
+			if (chunk <= 0)
+			{
+				written = false;
+				break;
+			}
+			bytes += chunk;
+			size -= (size_t)chunk;
+		}
+		written = close(file) == 0 && written;
+		if (written && rename(temporary.c_str(), path.c_str()) == 0) return true;
+		unlink(temporary.c_str());
+		return false;
+#endif
+	}
+
+	// Read-only view of a whole file mapped into memory. Pages are mapped copy-on-write,
+	// so consumers that patch the bytes in place (csmReviveMocInPlace) never touch the file.
+	class FileView final
+	{
+		csmByte* Data = nullptr;
+		size_t Size = 0;
+#ifdef _WIN32
+		HANDLE Mapping = nullptr;
+#endif
+
+		void Release()
+		{
+#ifdef _WIN32
+			if (Data) UnmapViewOfFile(Data);
+			if (Mapping) CloseHandle(Mapping);
+			Mapping = nullptr;
+#else
+			if (Data) munmap(Data, Size);
+#endif
+			Data = nullptr;
+			Size = 0;
+		}
+
+	public:
+		explicit FileView(const string& path)
+		{
+#ifdef _WIN32
+			auto file = CreateFileW(Widen(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE) throw runtime_error("Failed to open " + path);
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(file, &size))
+			{
+				CloseHandle(file);
+				throw runtime_error("Failed to stat " + path);
+			}
+			Size = (size_t)size.QuadPart;
+			if (Size > 0)
+			{
+				Mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+				if (Mapping) Data = (csmByte*)MapViewOfFile(Mapping, FILE_MAP_COPY, 0, 0, 0);
+			}
+			CloseHandle(file);
+			if (Size > 0 && !Data)
+			{
+				Release();
+				throw runtime_error("Failed to map " + path);
+			}
+#else
+			auto file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			if (file < 0) throw runtime_error("Failed to open " + path);
+			struct stat info;
+			if (fstat(file, &info) != 0)
+			{
+				close(file);
+				throw runtime_error("Failed to stat " + path);
+			}
+			Size = (size_t)info.st_size;
+			if (Size > 0)
+			{
+				auto address = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+				if (address != MAP_FAILED) Data = (csmByte*)address;
+			}
+			close(file);
+			if (Size > 0 && !Data)
+			{
+				Size = 0;
+				throw runtime_error("Failed to map " + path);
+			}
+#endif
+		}
+
+		FileView(const FileView&) = delete;
+		FileView& operator=(const FileView&) = delete;
+		~FileView() { Release(); }
+
+		csmByte* GetData() const { return Data; }
+		csmSizeInt GetSize() const { return (csmSizeInt)Size; }
+	};
+
 	namespace Constants
 	{
 		constexpr csmFloat32 ViewScale = 1.0f;
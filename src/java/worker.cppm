@@ -0,0 +1,135 @@
+module;
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+export module Worker;
+
+using namespace std;
+
+export namespace L2D
+{
+	class WorkerPool final
+	{
+		vector<jthread> Threads;
+		deque<function<void()>> Tasks;
+		mutex Mutex;
+		condition_variable Condition;
+		bool Stopping;
+
+		explicit WorkerPool(unsigned count) : Stopping(false)
+		{
+			for (unsigned i = 0; i < count; i++) Threads.emplace_back([this] { Run(); });
+		}
+
+		void Run()
+		{
+			while (true)
+			{
+				function<void()> task;
+				{
+					unique_lock lock(Mutex);
+					Condition.wait(lock, [this] { return Stopping || !Tasks.empty(); });
+					if (Tasks.empty()) return;
+					task = std::move(Tasks.front());
+					Tasks.pop_front();
+				}
+				task();
+			}
+		}
+
+		void Enqueue(function<void()> task)
+		{
+			{
+				lock_guard lock(Mutex);
+				Tasks.push_back(std::move(task));
+			}
+			Condition.notify_one();
+		}
+
+	public:
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		~WorkerPool()
+		{
+			{
+				lock_guard lock(Mutex);
+				Stopping = true;
+			}
+			Condition.notify_all();
+			for (auto& thread : Threads) thread.join();
+		}
+
+		static WorkerPool& Instance()
+		{
+			static WorkerPool pool(max(2u, thread::hardware_concurrency()) - 1);
+			return pool;
+		}
+
+		size_t GetThreadCount() const { return Threads.size(); }
+
+		future<void> Submit(function<void()> task)
+		{
+			auto packaged = make_shared<packaged_task<void()>>(std::move(task));
+			auto result = packaged->get_future();
+			Enqueue([packaged] { (*packaged)(); });
+			return result;
+		}
+
+		// Runs body(0..count-1) on the pool. The calling thread takes part in the loop,
+		// so nesting ParallelFor inside a pool task can not starve the queue.
+		void ParallelFor(size_t count, const function<void(size_t)>& body)
+		{
+			if (count == 0) return;
+			struct State
+			{
+				atomic<size_t> next = 0;
+				atomic<size_t> done = 0;
+				size_t count;
+				const function<void(size_t)>* body;
+				exception_ptr error;
+				mutex errorMutex;
+				mutex doneMutex;
+				condition_variable finished;
+
+				void Work()
+				{
+					for (size_t i; (i = next.fetch_add(1)) < count;)
+					{
+						try
+						{
+							(*body)(i);
+						}
+						catch (...)
+						{
+							lock_guard lock(errorMutex);
+							if (!error) error = current_exception();
+						}
+						if (done.fetch_add(1) + 1 == count)
+						{
+							lock_guard lock(doneMutex);
+							finished.notify_all();
+						}
+					}
+				}
+			};
+			auto state = make_shared<State>();
+			state->count = count;
+			state->body = &body;
+			for (size_t i = 0, helpers = min(count - 1, Threads.size()); i < helpers; i++) Enqueue([state] { state->Work(); });
+			state->Work();
+			{
+				unique_lock lock(state->doneMutex);
+				state->finished.wait(lock, [&] { return state->done.load() == count; });
+			}
+			if (state->error) rethrow_exception(state->error);
+		}
+	};
+}
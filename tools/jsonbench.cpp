@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <Framework/CubismFramework.hpp>
+#include <Framework/Motion/CubismMotion.hpp>
+#include <Framework/Physics/CubismPhysics.hpp>
+#include <Framework/Utils/CubismJson.hpp>
+// The Framework links the OpenGL renderer in; its loader is never called here.
+#define GLAD_GL_IMPLEMENTATION
+#include <glad/gl.h>
+
+using namespace std;
+using namespace Live2D::Cubism::Framework;
+
+// Times the JSON parser with its fast path (block scanning and the double based float path) against the
+// byte by byte scan and strtof it replaced, and checks that both produce the same values:
+//   live2d-jsonbench [-n runs] <file.json>...
+// Every file is parsed into a tree; *.motion3.json and *.physics3.json are also loaded the way a model does,
+// and compared through their binary snapshots. Exits with 1 if any result differs.
+// Needs the Framework built with CSM_JSON_BENCHMARK, which is what makes the parser's old path selectable.
+
+class Allocator final : public ICubismAllocator
+{
+	void* Allocate(const csmSizeType size) override
+	{
+		return malloc(size);
+	}
+
+	void Deallocate(void* memory) override
+	{
+		free(memory);
+	}
+
+	void* AllocateAligned(const csmSizeType size, const csmUint32 alignment) override
+	{
+		auto offset = alignment - 1 + sizeof(void*);
+		auto allocation = Allocate(size + static_cast<csmUint32>(offset));
+		auto alignedAddress = reinterpret_cast<size_t>(allocation) + sizeof(void*);
+		if (auto shift = alignedAddress % alignment) alignedAddress += (alignment - shift);
+		((void**)alignedAddress)[-1] = allocation;
+		return (void*)alignedAddress;
+	}
+
+	void DeallocateAligned(void* alignedMemory) override
+	{
+		Deallocate(((void**)alignedMemory)[-1]);
+	}
+};
+
+static vector<csmByte> ReadFile(const string& path)
+{
+	ifstream in(path, ios::binary);
+	if (!in) throw runtime_error("Failed to open " + path);
+	return { istreambuf_iterator<char>(in), istreambuf_iterator<char>() };
+}
+
+static bool EndsWith(const string& value, const string& suffix)
+{
+	return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Best wall time of runs calls, in milliseconds.
+static double Time(const int runs, const function<void()>& body)
+{
+	auto best = 1e30;
+	for (auto i = 0; i < runs; i++)
+	{
+		const auto begin = chrono::steady_clock::now();
+		body();
+		best = min(best, chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count());
+	}
+	return best;
+}
+
+// Compares two parsed trees; floats must match bit for bit. Returns the path of the first difference, or an empty string.
+static string Compare(Utils::Value& a, Utils::Value& b, const string& path)
+{
+	if (a.IsFloat() != b.IsFloat() || a.IsString() != b.IsString() || a.IsBool() != b.IsBool() ||
+		a.IsNull() != b.IsNull() || a.IsArray() != b.IsArray() || a.IsMap() != b.IsMap())
+		return path + ": type";
+	if (a.IsFloat())
+	{
+		const auto x = a.ToFloat(), y = b.ToFloat();
+		return memcmp(&x, &y, sizeof(x)) ? path + ": " + to_string(x) + " != " + to_string(y) : "";
+	}
+	if (a.IsString()) return strcmp(a.GetRawString(), b.GetRawString()) ? path + ": string" : "";
+	if (a.IsBool()) return a.ToBoolean() != b.ToBoolean() ? path + ": bool" : "";
+	if (a.IsArray())
+	{
+		if (a.GetSize() != b.GetSize()) return path + ": size";
+		for (csmInt32 i = 0; i < a.GetSize(); i++)
+			if (auto diff = Compare(a[i], b[i], path + "[" + to_string(i) + "]"); !diff.empty()) return diff;
+		return "";
+	}
+	if (a.IsMap())
+	{
+		const auto& keys = a.GetKeys();
+		if (keys.GetSize() != b.GetKeys().GetSize()) return path + ": size";
+		for (csmUint32 i = 0; i < keys.GetSize(); i++)
+			if (auto diff = Compare(a[keys[i]], b[keys[i]], path + "." + keys[i].GetRawString()); !diff.empty()) return diff;
+	}
+	return "";
+}
+
+static Utils::CubismJson* Parse(const vector<csmByte>& data)
+{
+	const auto json = Utils::CubismJson::Create(data.data(), (csmSizeInt)data.size());
+	if (!json) throw runtime_error("parse failed");
+	return json;
+}
+
+template <class T>
+static csmVector<csmByte> Snapshot(const vector<csmByte>& data, T* (*create)(const csmByte*, csmSizeInt), void (*destroy)(T*))
+{
+	const auto loaded = create(data.data(), (csmSizeInt)data.size());
+	if (!loaded) throw runtime_error("load failed");
+	csmVector<csmByte> binary;
+	loaded->WriteBinary(binary);
+	destroy(loaded);
+	return binary;
+}
+
+static CubismMotion* CreateMotion(const csmByte* data, const csmSizeInt size)
+{
+	return CubismMotion::Create(data, size);
+}
+
+static void DeleteMotion(CubismMotion* motion)
+{
+	ACubismMotion::Delete(motion);
+}
+
+static CubismPhysics* CreatePhysics(const csmByte* data, const csmSizeInt size)
+{
+	return CubismPhysics::Create(data, size);
+}
+
+static void DeletePhysics(CubismPhysics* physics)
+{
+	CubismPhysics::Delete(physics);
+}
+
+static void Report(const char* what, const double reference, const double fast)
+{
+	printf("  %-8s reference %9.3f ms  fast %9.3f ms  x%.2f\n", what, reference, fast, fast > 0 ? reference / fast : 0.0);
+}
+
+// Returns false if the two paths disagree.
+static bool Bench(const string& file, const int runs)
+{
+	const auto data = ReadFile(file);
+	printf("%s (%zu bytes)\n", file.c_str(), data.size());
+	auto same = true;
+
+	Utils::CubismJson::SetFastPathEnabled(false);
+	const auto reference = Parse(data);
+	const auto referenceTime = Time(runs, [&] { Utils::CubismJson::Delete(Parse(data)); });
+	Utils::CubismJson::SetFastPathEnabled(true);
+	const auto fast = Parse(data);
+	const auto fastTime = Time(runs, [&] { Utils::CubismJson::Delete(Parse(data)); });
+	if (const auto diff = Compare(reference->GetRoot(), fast->GetRoot(), "$"); !diff.empty())
+	{
+		printf("  tree differs at %s\n", diff.c_str());
+		same = false;
+	}
+	Utils::CubismJson::Delete(reference);
+	Utils::CubismJson::Delete(fast);
+	Report("tree", referenceTime, fastTime);
+
+	const auto loader = [&](const char* what, auto create, auto destroy)
+	{
+		Utils::CubismJson::SetFastPathEnabled(false);
+		auto expected = Snapshot(data, create, destroy);
+		const auto referenceLoad = Time(runs, [&] { Snapshot(data, create, destroy); });
+		Utils::CubismJson::SetFastPathEnabled(true);
+		auto actual = Snapshot(data, create, destroy);
+		const auto fastLoad = Time(runs, [&] { Snapshot(data, create, destroy); });
+		if (expected.GetSize() != actual.GetSize() || memcmp(expected.GetPtr(), actual.GetPtr(), expected.GetSize()) != 0)
+		{
+			printf("  %s snapshot differs\n", what);
+			same = false;
+		}
+		Report(what, referenceLoad, fastLoad);
+	};
+	if (EndsWith(file, ".motion3.json")) loader("motion", CreateMotion, DeleteMotion);
+	else if (EndsWith(file, ".physics3.json")) loader("physics", CreatePhysics, DeletePhysics);
+	return same;
+}
+
+int main(int argc, char** argv)
+{
+	auto runs = 10;
+	auto first = 1;
+	if (argc > 2 && !strcmp(argv[1], "-n"))
+	{
+		runs = max(atoi(argv[2]), 1);
+		first = 3;
+	}
+	if (first >= argc)
+	{
+		fprintf(stderr, "Usage: %s [-n runs] <file.json>...\n", argv[0]);
+		return 1;
+	}
+	static Allocator allocator;
+	static CubismFramework::Option option;
+	option.LogFunction = [](const char* message) { fputs(message, stderr); };
+	option.LoggingLevel = CubismFramework::Option::LogLevel_Warning;
+	CubismFramework::StartUp(&allocator, &option);
+	CubismFramework::Initialize();
+	auto result = 0;
+	for (auto i = first; i < argc; i++)
+	{
+		try
+		{
+			if (!Bench(argv[i], runs)) result = 1;
+		}
+		catch (const exception& e)
+		{
+			fprintf(stderr, "%s: %s\n", argv[i], e.what());
+			result = 1;
+		}
+	}
+	CubismFramework::Dispose();
+	return result;
+}
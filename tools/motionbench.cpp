@@ -0,0 +1,204 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <Framework/CubismFramework.hpp>
+#include <Framework/Motion/CubismMotion.hpp>
+// The Framework links the OpenGL renderer in; its loader is never called here.
+#define GLAD_GL_IMPLEMENTATION
+#include <glad/gl.h>
+
+using namespace std;
+using namespace Live2D::Cubism::Framework;
+
+// Evaluates every curve of a motion both in segment type batches and one curve at a time, checks that the
+// results match bit for bit and reports the time per frame of each:
+//   live2d-motionbench [-n frames] [-c curves] [motion3.json|motion3.bin]...
+// Without files it runs on generated motions with the given number of curves (512 by default), one with
+// restricted Bezier handles and one solved with Cardano's formula. Exits with 1 if any value differs.
+
+class Allocator final : public ICubismAllocator
+{
+	void* Allocate(const csmSizeType size) override
+	{
+		return malloc(size);
+	}
+
+	void Deallocate(void* memory) override
+	{
+		free(memory);
+	}
+
+	void* AllocateAligned(const csmSizeType size, const csmUint32 alignment) override
+	{
+		auto offset = alignment - 1 + sizeof(void*);
+		auto allocation = Allocate(size + static_cast<csmUint32>(offset));
+		auto alignedAddress = reinterpret_cast<size_t>(allocation) + sizeof(void*);
+		if (auto shift = alignedAddress % alignment) alignedAddress += (alignment - shift);
+		((void**)alignedAddress)[-1] = allocation;
+		return (void*)alignedAddress;
+	}
+
+	void DeallocateAligned(void* alignedMemory) override
+	{
+		Deallocate(((void**)alignedMemory)[-1]);
+	}
+};
+
+static vector<csmByte> ReadFile(const string& path)
+{
+	ifstream in(path, ios::binary);
+	if (!in) throw runtime_error("Failed to open " + path);
+	return { istreambuf_iterator<char>(in), istreambuf_iterator<char>() };
+}
+
+// A looping motion of 10 seconds whose curves mix linear, Bezier and stepped segments.
+static string GenerateMotion(const int curves, const bool restricted)
+{
+	const auto duration = 10.0f;
+	const auto segmentsPerCurve = 40;
+	mt19937 random(curves * 2 + restricted);
+	uniform_real_distribution<float> value(-30.0f, 30.0f);
+	uniform_int_distribution<int> type(0, 9);
+	string body;
+	auto totalSegments = 0, totalPoints = 0;
+	for (auto c = 0; c < curves; c++)
+	{
+		auto segments = to_string(0.0f) + "," + to_string(value(random));
+		auto points = 1;
+		for (auto s = 0; s < segmentsPerCurve; s++)
+		{
+			const auto begin = duration * s / segmentsPerCurve, end = duration * (s + 1) / segmentsPerCurve;
+			// Mostly Bezier segments as in authored motions; unrestricted handles may reach past the segment.
+			const auto kind = type(random);
+			if (kind < 6)
+			{
+				const auto reach = restricted ? 0.0f : (end - begin) * 0.4f;
+				const auto first = begin + (end - begin) / 3 - reach, second = end - (end - begin) / 3 + reach;
+				segments += ",1," + to_string(first) + "," + to_string(value(random)) + "," + to_string(second) + "," + to_string(value(random)) + "," + to_string(end) + "," + to_string(value(random));
+				points += 3;
+			}
+			else
+			{
+				segments += "," + to_string(kind < 8 ? 0 : kind - 6) + "," + to_string(end) + "," + to_string(value(random));
+				points += 1;
+			}
+		}
+		body += string(c ? "," : "") + "{\"Target\":\"Parameter\",\"Id\":\"Param" + to_string(c) + "\",\"Segments\":[" + segments + "]}";
+		totalSegments += segmentsPerCurve;
+		totalPoints += points;
+	}
+	return "{\"Version\":3,\"Meta\":{\"Duration\":" + to_string(duration) + ",\"Fps\":30,\"Loop\":true,\"AreBeziersRestricted\":" + (restricted ? "true" : "false") +
+		",\"CurveCount\":" + to_string(curves) + ",\"TotalSegmentCount\":" + to_string(totalSegments) + ",\"TotalPointCount\":" + to_string(totalPoints) +
+		",\"UserDataCount\":0,\"TotalUserDataSize\":0},\"Curves\":[" + body + "]}";
+}
+
+// Frame times of a playback at 60 fps that now and then jumps back to the start or seeks.
+static vector<csmFloat32> MakeTimeline(const int frames, const csmFloat32 duration)
+{
+	mt19937 random(frames);
+	uniform_int_distribution<int> event(0, 99);
+	uniform_real_distribution<float> seek(0.0f, duration);
+	vector<csmFloat32> times(frames);
+	csmFloat32 time = 0.0f;
+	for (auto& t : times)
+	{
+		const auto e = event(random);
+		if (e < 97) time += 1.0f / 60;
+		else if (e < 98) time = 0.0f;
+		else time = seek(random);
+		if (time > duration) time = 0.0f;
+		t = time;
+	}
+	return times;
+}
+
+// Returns false if the two paths disagree.
+static bool Bench(const string& name, const vector<csmByte>& data, const int frames)
+{
+	const auto motion = CubismMotion::Create(data.data(), (csmSizeInt)data.size());
+	if (!motion) throw runtime_error("Failed to load " + name);
+	const auto curves = motion->GetCurveCount();
+	const auto timeline = MakeTimeline(frames, motion->GetDuration());
+	vector<csmInt32> batchedCursors(curves, -1), scalarCursors(curves, -1);
+	vector<csmFloat32> batched(curves), scalar(curves);
+
+	long mismatches = 0;
+	for (const auto time : timeline)
+	{
+		motion->EvaluateAllCurves(time, true, batchedCursors.data(), batched.data());
+		motion->EvaluateAllCurves(time, false, scalarCursors.data(), scalar.data());
+		for (csmInt32 c = 0; c < curves; c++)
+		{
+			if (memcmp(&batched[c], &scalar[c], sizeof(csmFloat32)) == 0) continue;
+			if (mismatches++ < 5) printf("  curve %d at %.6f: batched %.9g scalar %.9g\n", c, time, batched[c], scalar[c]);
+		}
+	}
+
+	const auto measure = [&](const csmBool batch)
+	{
+		vector<csmInt32> cursors(curves, -1);
+		vector<csmFloat32> values(curves);
+		const auto begin = chrono::steady_clock::now();
+		for (const auto time : timeline) motion->EvaluateAllCurves(time, batch, cursors.data(), values.data());
+		return chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count() / timeline.size();
+	};
+	const auto scalarTime = measure(false);
+	const auto batchedTime = measure(true);
+	printf("%s: %d curves\n  scalar %8.2f us/frame  batched %8.2f us/frame  x%.2f  mismatches %ld/%zu\n", name.c_str(), curves,
+		scalarTime, batchedTime, batchedTime > 0 ? scalarTime / batchedTime : 0.0, mismatches, (size_t)curves * timeline.size());
+	ACubismMotion::Delete(motion);
+	return mismatches == 0;
+}
+
+int main(int argc, char** argv)
+{
+	auto frames = 20000;
+	auto curves = 512;
+	vector<string> files;
+	for (auto i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) frames = max(atoi(argv[++i]), 1);
+		else if (!strcmp(argv[i], "-c") && i + 1 < argc) curves = max(atoi(argv[++i]), 1);
+		else if (argv[i][0] == '-')
+		{
+			fprintf(stderr, "Usage: %s [-n frames] [-c curves] [motion3.json|motion3.bin]...\n", argv[0]);
+			return 1;
+		}
+		else files.emplace_back(argv[i]);
+	}
+	static Allocator allocator;
+	static CubismFramework::Option option;
+	option.LogFunction = [](const char* message) { fputs(message, stderr); };
+	option.LoggingLevel = CubismFramework::Option::LogLevel_Warning;
+	CubismFramework::StartUp(&allocator, &option);
+	CubismFramework::Initialize();
+	auto result = 0;
+	try
+	{
+		if (files.empty())
+		{
+			for (const auto restricted : { true, false })
+			{
+				const auto json = GenerateMotion(curves, restricted);
+				if (!Bench(restricted ? "generated (restricted)" : "generated (Cardano)", vector<csmByte>(json.begin(), json.end()), frames)) result = 1;
+			}
+		}
+		for (const auto& file : files)
+			if (!Bench(file, ReadFile(file), frames)) result = 1;
+	}
+	catch (const exception& e)
+	{
+		fprintf(stderr, "%s\n", e.what());
+		result = 1;
+	}
+	CubismFramework::Dispose();
+	return result;
+}
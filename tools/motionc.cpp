@@ -0,0 +1,115 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <Framework/CubismFramework.hpp>
+#include <Framework/Motion/CubismMotion.hpp>
+#include <Framework/Motion/CubismMotionJson.hpp>
+// The Framework links the OpenGL renderer in; its loader is never called here.
+#define GLAD_GL_IMPLEMENTATION
+#include <glad/gl.h>
+
+using namespace std;
+using namespace Live2D::Cubism::Framework;
+
+// Compiles a motion3.json into the precompiled motion3.bin format:
+//   live2d-motionc <input motion3.json> <output motion3.bin>
+// CubismMotion::Create detects the format by its signature, so the output can replace the json file under any name.
+
+class Allocator final : public ICubismAllocator
+{
+	void* Allocate(const csmSizeType size) override
+	{
+		return malloc(size);
+	}
+
+	void Deallocate(void* memory) override
+	{
+		free(memory);
+	}
+
+	void* AllocateAligned(const csmSizeType size, const csmUint32 alignment) override
+	{
+		auto offset = alignment - 1 + sizeof(void*);
+		auto allocation = Allocate(size + static_cast<csmUint32>(offset));
+		auto alignedAddress = reinterpret_cast<size_t>(allocation) + sizeof(void*);
+		if (auto shift = alignedAddress % alignment) alignedAddress += (alignment - shift);
+		((void**)alignedAddress)[-1] = allocation;
+		return (void*)alignedAddress;
+	}
+
+	void DeallocateAligned(void* alignedMemory) override
+	{
+		Deallocate(((void**)alignedMemory)[-1]);
+	}
+};
+
+static vector<csmByte> ReadFile(const string& path)
+{
+	ifstream in(path, ios::binary);
+	if (!in) throw runtime_error("Failed to open " + path);
+	return { istreambuf_iterator<char>(in), istreambuf_iterator<char>() };
+}
+
+static csmVector<csmByte> Encode(const csmByte* data, size_t size)
+{
+	const auto motion = CubismMotion::Create(data, (csmSizeInt)size);
+	if (!motion) throw runtime_error("Failed to load the motion");
+	csmVector<csmByte> binary;
+	motion->WriteBinary(binary);
+	ACubismMotion::Delete(motion);
+	return binary;
+}
+
+static void Compile(const string& input, const string& output)
+{
+	const auto json = ReadFile(input);
+	if (CubismMotion::IsBinary(json.data(), (csmSizeInt)json.size())) throw runtime_error(input + " is already compiled");
+	{
+		CubismMotionJson parsed(json.data(), (csmSizeInt)json.size());
+		if (!parsed.IsValid()) throw runtime_error(input + " is not a valid motion3.json");
+	}
+	auto binary = Encode(json.data(), json.size());
+	// Reloading the result must give back the same motion data.
+	auto reloaded = Encode(binary.GetPtr(), binary.GetSize());
+	if (reloaded.GetSize() != binary.GetSize() || memcmp(reloaded.GetPtr(), binary.GetPtr(), binary.GetSize()) != 0)
+		throw runtime_error(input + " did not survive a round trip");
+
+	ofstream out(output, ios::binary | ios::trunc);
+	if (!out) throw runtime_error("Failed to create " + output);
+	out.write((const char*)binary.GetPtr(), (streamsize)binary.GetSize());
+	if (!out) throw runtime_error("Failed to write " + output);
+	printf("Compiled %s into %s (%zu -> %u bytes)\n", input.c_str(), output.c_str(), json.size(), binary.GetSize());
+}
+
+int main(int argc, char** argv)
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "Usage: %s <input motion3.json> <output motion3.bin>\n", argv[0]);
+		return 1;
+	}
+	static Allocator allocator;
+	static CubismFramework::Option option;
+	option.LogFunction = [](const char* message) { fputs(message, stderr); };
+	option.LoggingLevel = CubismFramework::Option::LogLevel_Warning;
+	CubismFramework::StartUp(&allocator, &option);
+	CubismFramework::Initialize();
+	auto result = 0;
+	try
+	{
+		Compile(argv[1], argv[2]);
+	}
+	catch (const exception& e)
+	{
+		fprintf(stderr, "%s\n", e.what());
+		result = 1;
+	}
+	CubismFramework::Dispose();
+	return result;
+}
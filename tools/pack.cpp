@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+import Bundle;
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// Packs every regular file below a model directory into a single bundle:
+//   live2d-pack <model directory> <output bundle>
+// Entry names are the paths relative to the directory, matching the file names in model3.json.
+
+struct Source
+{
+	string name;
+	fs::path path;
+	uint64_t size;
+	uint64_t offset;
+};
+
+static uint64_t AlignUp(uint64_t value)
+{
+	return (value + BundleAlignment - 1) / BundleAlignment * BundleAlignment;
+}
+
+static void Pack(const fs::path& directory, const fs::path& output)
+{
+	vector<Source> sources;
+	for (const auto& item : fs::recursive_directory_iterator(directory))
+	{
+		if (!item.is_regular_file()) continue;
+		if (fs::exists(output) && fs::equivalent(item.path(), output)) continue;
+		const auto name = fs::relative(item.path(), directory).generic_u8string();
+		sources.push_back({ string(name.begin(), name.end()), item.path(), item.file_size(), 0 });
+	}
+	sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) { return a.name < b.name; });
+
+	const BundleHeader header = { BundleMagic, BundleVersion, (uint32_t)sources.size(), 0 };
+	vector<BundleEntry> entries(sources.size());
+	string names;
+	uint64_t cursor = sizeof(BundleHeader) + sizeof(BundleEntry) * sources.size();
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		entries[i].nameOffset = (uint32_t)(cursor + names.size());
+		entries[i].nameLength = (uint32_t)sources[i].name.size();
+		names += sources[i].name;
+	}
+	cursor += names.size();
+	for (size_t i = 0; i < sources.size(); i++)
+	{
+		cursor = AlignUp(cursor);
+		sources[i].offset = entries[i].offset = cursor;
+		entries[i].size = sources[i].size;
+		cursor += sources[i].size;
+	}
+
+	ofstream out(output, ios::binary | ios::trunc);
+	if (!out) throw runtime_error("Failed to create " + output.string());
+	out.write((const char*)&header, sizeof(header));
+	out.write((const char*)entries.data(), (streamsize)(sizeof(BundleEntry) * entries.size()));
+	out.write(names.data(), (streamsize)names.size());
+	for (const auto& source : sources)
+	{
+		const auto padding = source.offset - (uint64_t)out.tellp();
+		for (uint64_t i = 0; i < padding; i++) out.put(0);
+		ifstream in(source.path, ios::binary);
+		if (!in) throw runtime_error("Failed to open " + source.path.string());
+		out << in.rdbuf();
+		if ((uint64_t)out.tellp() != source.offset + source.size) throw runtime_error(source.path.string() + " changed while packing");
+	}
+	if (!out) throw runtime_error("Failed to write " + output.string());
+	printf("Packed %zu files into %s (%llu bytes)\n", sources.size(), output.string().c_str(), (unsigned long long)cursor);
+}
+
+int main(int argc, char** argv)
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "Usage: %s <model directory> <output bundle>\n", argv[0]);
+		return 1;
+	}
+	try
+	{
+		Pack(argv[1], argv[2]);
+	}
+	catch (const exception& e)
+	{
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
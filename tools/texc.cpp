@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#include <stb_image.h>
+
+import TextureFile;
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// Precomputes the mip chain of every png below a model directory and stores it next to the png as <png>.l2dt:
+//   live2d-texc [--rgba8] <model directory>
+// Levels are BC7 compressed unless --rgba8 is given. At runtime the png is still used when the context lacks BC7.
+
+struct Level
+{
+	uint32_t width;
+	uint32_t height;
+	vector<uint8_t> pixels;
+};
+
+// Halves a level with a box filter. Colours are weighted by alpha, so transparent texels do not bleed into the edges.
+static Level Downsample(const Level& source)
+{
+	Level level = { max(source.width / 2, 1u), max(source.height / 2, 1u) };
+	level.pixels.resize((size_t)level.width * level.height * 4);
+	for (uint32_t y = 0; y < level.height; y++)
+	{
+		for (uint32_t x = 0; x < level.width; x++)
+		{
+			uint32_t color[3] = {}, plain[3] = {}, alpha = 0, count = 0;
+			for (uint32_t dy = 0; dy < 2; dy++)
+			{
+				for (uint32_t dx = 0; dx < 2; dx++)
+				{
+					const auto sx = min(x * 2 + dx, source.width - 1), sy = min(y * 2 + dy, source.height - 1);
+					const auto texel = &source.pixels[((size_t)sy * source.width + sx) * 4];
+					for (int c = 0; c < 3; c++)
+					{
+						color[c] += texel[c] * texel[3];
+						plain[c] += texel[c];
+					}
+					alpha += texel[3];
+					count++;
+				}
+			}
+			const auto texel = &level.pixels[((size_t)y * level.width + x) * 4];
+			for (int c = 0; c < 3; c++) texel[c] = (uint8_t)(alpha ? (color[c] + alpha / 2) / alpha : (plain[c] + count / 2) / count);
+			texel[3] = (uint8_t)((alpha + count / 2) / count);
+		}
+	}
+	return level;
+}
+
+// BC7 mode 6: one subset, RGBA endpoints of 7 bits plus a p-bit each, 4-bit indices.
+static constexpr int Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct BlockFit
+{
+	int quantized[2][4];
+	int pbits[2];
+	int indices[16];
+	int error;
+};
+
+static void PutBits(uint8_t* block, int& position, uint32_t value, int bits)
+{
+	for (int i = 0; i < bits; i++, position++) if (value >> i & 1) block[position / 8] |= (uint8_t)(1 << position % 8);
+}
+
+static BlockFit FitEndpoints(const uint8_t texels[16][4], const float endpoints[2][4])
+{
+	BlockFit fit = {};
+	int decoded[2][4];
+	for (int e = 0; e < 2; e++)
+	{
+		auto best = INT32_MAX;
+		for (int p = 0; p < 2; p++)
+		{
+			int error = 0, quantized[4];
+			for (int c = 0; c < 4; c++)
+			{
+				quantized[c] = clamp((int)lround((endpoints[e][c] - p) / 2), 0, 127);
+				const auto difference = quantized[c] * 2 + p - endpoints[e][c];
+				error += (int)(difference * difference);
+			}
+			if (error >= best) continue;
+			best = error;
+			fit.pbits[e] = p;
+			for (int c = 0; c < 4; c++)
+			{
+				fit.quantized[e][c] = quantized[c];
+				decoded[e][c] = quantized[c] * 2 + p;
+			}
+		}
+	}
+	int palette[16][4];
+	for (int i = 0; i < 16; i++) for (int c = 0; c < 4; c++) palette[i][c] = ((64 - Weights[i]) * decoded[0][c] + Weights[i] * decoded[1][c] + 32) >> 6;
+	for (int t = 0; t < 16; t++)
+	{
+		auto best = INT32_MAX;
+		for (int i = 0; i < 16; i++)
+		{
+			int error = 0;
+			for (int c = 0; c < 4; c++) error += (palette[i][c] - texels[t][c]) * (palette[i][c] - texels[t][c]);
+			if (error >= best) continue;
+			best = error;
+			fit.indices[t] = i;
+		}
+		fit.error += best;
+	}
+	return fit;
+}
+
+static void EncodeBlock(const uint8_t texels[16][4], uint8_t* block)
+{
+	// Endpoints along the principal axis of the block, found by power iteration.
+	float mean[4] = {}, covariance[4][4] = {}, axis[4] = { 1, 1, 1, 1 };
+	for (int t = 0; t < 16; t++) for (int c = 0; c < 4; c++) mean[c] += texels[t][c] / 16.0f;
+	for (int t = 0; t < 16; t++)
+		for (int i = 0; i < 4; i++)
+			for (int j = 0; j < 4; j++) covariance[i][j] += (texels[t][i] - mean[i]) * (texels[t][j] - mean[j]);
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[4] = {}, length = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			for (int j = 0; j < 4; j++) next[i] += covariance[i][j] * axis[j];
+			length += next[i] * next[i];
+		}
+		if (length < 1e-6f) break;
+		length = sqrt(length);
+		for (int i = 0; i < 4; i++) axis[i] = next[i] / length;
+	}
+	float low = 0, high = 0;
+	for (int t = 0; t < 16; t++)
+	{
+		float projection = 0;
+		for (int c = 0; c < 4; c++) projection += (texels[t][c] - mean[c]) * axis[c];
+		low = min(low, projection);
+		high = max(high, projection);
+	}
+	float endpoints[2][4];
+	for (int c = 0; c < 4; c++)
+	{
+		endpoints[0][c] = clamp(mean[c] + low * axis[c], 0.0f, 255.0f);
+		endpoints[1][c] = clamp(mean[c] + high * axis[c], 0.0f, 255.0f);
+	}
+	auto fit = FitEndpoints(texels, endpoints);
+
+	// One least squares pass over the chosen indices usually pulls the endpoints closer to the texels.
+	float a = 0, b = 0, d = 0, right[2][4] = {};
+	for (int t = 0; t < 16; t++)
+	{
+		const auto weight = Weights[fit.indices[t]] / 64.0f;
+		a += (1 - weight) * (1 - weight);
+		b += (1 - weight) * weight;
+		d += weight * weight;
+		for (int c = 0; c < 4; c++)
+		{
+			right[0][c] += (1 - weight) * texels[t][c];
+			right[1][c] += weight * texels[t][c];
+		}
+	}
+	if (const auto determinant = a * d - b * b; fabs(determinant) > 1e-6f)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			endpoints[0][c] = clamp((d * right[0][c] - b * right[1][c]) / determinant, 0.0f, 255.0f);
+			endpoints[1][c] = clamp((a * right[1][c] - b * right[0][c]) / determinant, 0.0f, 255.0f);
+		}
+		if (const auto refined = FitEndpoints(texels, endpoints); refined.error < fit.error) fit = refined;
+	}
+
+	// The most significant bit of the first index is implied to be zero.
+	if (fit.indices[0] >= 8)
+	{
+		for (int c = 0; c < 4; c++) swap(fit.quantized[0][c], fit.quantized[1][c]);
+		swap(fit.pbits[0], fit.pbits[1]);
+		for (auto& index : fit.indices) index = 15 - index;
+	}
+	memset(block, 0, 16);
+	auto position = 0;
+	PutBits(block, position, 1 << 6, 7);
+	for (int c = 0; c < 4; c++)
+	{
+		PutBits(block, position, fit.quantized[0][c], 7);
+		PutBits(block, position, fit.quantized[1][c], 7);
+	}
+	PutBits(block, position, fit.pbits[0], 1);
+	PutBits(block, position, fit.pbits[1], 1);
+	PutBits(block, position, fit.indices[0], 3);
+	for (int t = 1; t < 16; t++) PutBits(block, position, fit.indices[t], 4);
+}
+
+static vector<uint8_t> EncodeBC7(const Level& level)
+{
+	const auto blocksX = (level.width + 3) / 4, blocksY = (level.height + 3) / 4;
+	vector<uint8_t> blocks((size_t)blocksX * blocksY * 16);
+	for (uint32_t by = 0; by < blocksY; by++)
+	{
+		for (uint32_t bx = 0; bx < blocksX; bx++)
+		{
+			uint8_t texels[16][4];
+			for (uint32_t t = 0; t < 16; t++)
+			{
+				const auto x = min(bx * 4 + t % 4, level.width - 1), y = min(by * 4 + t / 4, level.height - 1);
+				memcpy(texels[t], &level.pixels[((size_t)y * level.width + x) * 4], 4);
+			}
+			EncodeBlock(texels, &blocks[((size_t)by * blocksX + bx) * 16]);
+		}
+	}
+	return blocks;
+}
+
+static uint64_t AlignUp(uint64_t value)
+{
+	return (value + TextureFileAlignment - 1) / TextureFileAlignment * TextureFileAlignment;
+}
+
+static uint64_t Convert(const fs::path& input, const fs::path& output, const uint32_t format)
+{
+	int width, height, channels;
+	const auto png = stbi_load(input.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+	if (!png) throw runtime_error("Failed to decode " + input.string());
+	vector<Level> levels(1, { (uint32_t)width, (uint32_t)height, vector<uint8_t>(png, png + (size_t)width * height * 4) });
+	stbi_image_free(png);
+	while (levels.back().width > 1 || levels.back().height > 1) levels.push_back(Downsample(levels.back()));
+	if (format == TextureFormatBC7) for (auto& level : levels) level.pixels = EncodeBC7(level);
+
+	const TextureFileHeader header = { TextureFileMagic, TextureFileVersion, format, (uint32_t)width, (uint32_t)height, (uint32_t)levels.size() };
+	vector<TextureFileLevel> table(levels.size());
+	uint64_t cursor = sizeof(header) + sizeof(TextureFileLevel) * table.size();
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		cursor = AlignUp(cursor);
+		table[i] = { cursor, levels[i].pixels.size(), levels[i].width, levels[i].height };
+		cursor += levels[i].pixels.size();
+	}
+
+	ofstream out(output, ios::binary | ios::trunc);
+	if (!out) throw runtime_error("Failed to create " + output.string());
+	out.write((const char*)&header, sizeof(header));
+	out.write((const char*)table.data(), (streamsize)(sizeof(TextureFileLevel) * table.size()));
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		const auto padding = table[i].offset - (uint64_t)out.tellp();
+		for (uint64_t j = 0; j < padding; j++) out.put(0);
+		out.write((const char*)levels[i].pixels.data(), (streamsize)levels[i].pixels.size());
+	}
+	if (!out) throw runtime_error("Failed to write " + output.string());
+	return cursor;
+}
+
+int main(int argc, char** argv)
+{
+	auto format = TextureFormatBC7;
+	if (argc == 3 && strcmp(argv[1], "--rgba8") == 0) format = TextureFormatRGBA8;
+	else if (argc != 2)
+	{
+		fprintf(stderr, "Usage: %s [--rgba8] <model directory>\n", argv[0]);
+		return 1;
+	}
+	try
+	{
+		vector<fs::path> inputs;
+		for (const auto& item : fs::recursive_directory_iterator(argv[argc - 1]))
+		{
+			auto extension = item.path().extension().string();
+			transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)tolower(c); });
+			if (item.is_regular_file() && extension == ".png") inputs.push_back(item.path());
+		}
+		sort(inputs.begin(), inputs.end());
+		for (const auto& input : inputs)
+		{
+			auto output = input;
+			output += ".l2dt";
+			const auto size = Convert(input, output, format);
+			printf("Converted %s (%llu bytes)\n", output.string().c_str(), (unsigned long long)size);
+		}
+	}
+	catch (const exception& e)
+	{
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
@@ -3,15 +3,8 @@ add_rules("mode.debug")
 add_rules("mode.release")
 add_rules("mode.releasedbg")
 
-target("live2d-native")
-    set_kind("shared")
-    set_exceptions("cxx")
-    add_files("src/**.cpp", "src/**.cppm")
-    add_headerfiles("src/**.hpp", "src/**.h")
-    add_sysincludedirs("include")
-    set_policy("build.c++.modules", true)
+function add_cubism_core()
     if is_plat("windows") then
-        add_syslinks("advapi32")
         add_sysincludedirs("include/platform/windows")
         add_syslinks("lib/windows/Live2DCubismCore.lib")
         add_defines("CSM_TARGET_WIN_GL=1")
@@ -24,4 +17,52 @@ target("live2d-native")
             add_defines("CSM_TARGET_MAC_GL=1")
         end
         add_sysincludedirs("include/platform/unix")
-    end
\ No newline at end of file
+    end
+end
+
+target("live2d-native")
+    set_kind("shared")
+    set_exceptions("cxx")
+    add_files("src/**.cpp", "src/**.cppm")
+    add_headerfiles("src/**.hpp", "src/**.h")
+    add_sysincludedirs("include")
+    set_policy("build.c++.modules", true)
+    if is_plat("windows") then
+        add_syslinks("advapi32")
+    end
+    add_cubism_core()
+
+target("live2d-pack")
+    set_kind("binary")
+    set_exceptions("cxx")
+    add_files("tools/pack.cpp", "src/java/bundle.cppm")
+    set_policy("build.c++.modules", true)
+
+target("live2d-motionc")
+    set_kind("binary")
+    set_exceptions("cxx")
+    add_files("tools/motionc.cpp", "src/Framework/**.cpp")
+    add_sysincludedirs("include")
+    add_cubism_core()
+
+target("live2d-texc")
+    set_kind("binary")
+    set_exceptions("cxx")
+    add_files("tools/texc.cpp", "src/java/texturefile.cppm")
+    add_sysincludedirs("include")
+    set_policy("build.c++.modules", true)
+
+target("live2d-jsonbench")
+    set_kind("binary")
+    set_exceptions("cxx")
+    add_files("tools/jsonbench.cpp", "src/Framework/**.cpp")
+    add_sysincludedirs("include")
+    add_defines("CSM_JSON_BENCHMARK")
+    add_cubism_core()
+
+target("live2d-motionbench")
+    set_kind("binary")
+    set_exceptions("cxx")
+    add_files("tools/motionbench.cpp", "src/Framework/**.cpp")
+    add_sysincludedirs("include")
+    add_cubism_core()